@@ -10,17 +10,124 @@
 #ifndef ARDUINOSOCKETIOCLIENT_H_
 #define ARDUINOSOCKETIOCLIENT_H_
 
+#include "SocketIOAckPool.h"
+#include "SocketIOArena.h"
+#include "SocketIOEventParser.h"
+#include "SocketIOEventTable.h"
+#include "SocketIOFrameWriter.h"
+#include "SocketIOMsgPackParser.h"
+#include "SocketIOMsgPackWriter.h"
+#include "SocketIOOfflineLog.h"
+#include "SocketIOPacketQueue.h"
+#include "SocketIOStats.h"
 #include <ArduinoJson.h>
 #include <WebSockets.h>
 #include <WebSocketsClient.h>
-#include <map>
-#include <vector>
 
-#define EIO_HEARTBEAT_INTERVAL 20000
+// Heartbeat until the OPEN packet of the server gives its own: a connection
+// without ping (pong with EIO=3) for interval + timeout milliseconds is closed
+#ifndef EIO_HEARTBEAT_INTERVAL
+#define EIO_HEARTBEAT_INTERVAL 25000
+#endif
+#ifndef EIO_HEARTBEAT_TIMEOUT
+#define EIO_HEARTBEAT_TIMEOUT 20000
+#endif
 #define FACTOR 4
 
+// Size of the memory region allocated once by begin() when configureMemory was
+// not called. The outbound packet queue lives in it.
+#ifndef SIO_ARENA_SIZE
+#define SIO_ARENA_SIZE 4096
+#endif
+
+// Frames sent from a caller's buffer (send, sendEVENT) up to this size,
+// headers included, are copied and written in one piece
+#ifndef SIO_FRAME_BUFFER_SIZE
+#define SIO_FRAME_BUFFER_SIZE 256
+#endif
+
+// Larger frames are masked through a stack buffer of this size, one write per
+// chunk
+#ifndef SIO_MASK_CHUNK_SIZE
+#define SIO_MASK_CHUNK_SIZE 128
+#endif
+
+// Holds the text frame of an incoming binary packet and all its attachments
+// but the last one (delivered straight from the receive buffer). 0 to ignore
+// binary packets.
+#ifndef SIO_BINARY_BUFFER_SIZE
+#define SIO_BINARY_BUFFER_SIZE 512
+#endif
+
+// Packets replayed from the offline log at once after a reconnection, and the
+// pause in milliseconds between two bursts
+#ifndef SIO_OFFLINE_REPLAY_PACKETS
+#define SIO_OFFLINE_REPLAY_PACKETS 4
+#endif
+#ifndef SIO_OFFLINE_REPLAY_INTERVAL
+#define SIO_OFFLINE_REPLAY_INTERVAL 50
+#endif
+
+// Frames read at most by a loop() call given a time budget
+#ifndef SIO_LOOP_MAX_INBOUND
+#define SIO_LOOP_MAX_INBOUND 8
+#endif
+
+// Events that can be marked with coalesce()
+#ifndef SIO_MAX_COALESCED_EVENTS
+#define SIO_MAX_COALESCED_EVENTS 8
+#endif
+
+// Extra room queued with a coalesced packet: a slightly longer value still
+// replaces it in place
+#ifndef SIO_COALESCE_SLACK
+#define SIO_COALESCE_SLACK 8
+#endif
+
+// Bytes of the arena given to the high priority lane of the outbound queue,
+// 0 for a single lane
+#ifndef SIO_PRIORITY_QUEUE_SIZE
+#define SIO_PRIORITY_QUEUE_SIZE 512
+#endif
+
+// Anti-starvation: after this many high priority packets sent in a row while
+// normal ones wait, one normal packet goes first. 0 for strict priority.
+#ifndef SIO_PRIORITY_RATIO
+#define SIO_PRIORITY_RATIO 8
+#endif
+
+// Events that can be given a priority with setPriority()
+#ifndef SIO_MAX_PRIORITY_EVENTS
+#define SIO_MAX_PRIORITY_EVENTS 8
+#endif
+
+// Events that can be received with onStream(), all namespaces included
+#ifndef SIO_MAX_STREAM_EVENTS
+#define SIO_MAX_STREAM_EVENTS 4
+#endif
+
+// Reconnection backoff: the first attempt after a lost connection waits
+// SIO_RECONNECT_DELAY milliseconds, every failed one doubles the wait up to
+// SIO_RECONNECT_DELAY_MAX, and each wait is spread by +/- SIO_RECONNECT_JITTER
+// percent so a fleet does not come back in lockstep
+#ifndef SIO_RECONNECT_DELAY
+#define SIO_RECONNECT_DELAY 1000
+#endif
+#ifndef SIO_RECONNECT_DELAY_MAX
+#define SIO_RECONNECT_DELAY_MAX 30000
+#endif
+#ifndef SIO_RECONNECT_JITTER
+#define SIO_RECONNECT_JITTER 50
+#endif
+
 #define EIO_MAX_HEADER_SIZE (WEBSOCKETS_MAX_HEADER_SIZE + 1)
 #define SIO_MAX_HEADER_SIZE (EIO_MAX_HEADER_SIZE + 1)
+// Offset in the header room of a queued packet of micros() at emit time, read
+// by loop() before the headers overwrite it
+#define SIO_PACKET_STAMP 4
+// Offset of a byte set when the packet carries an ack id: never stored in the
+// offline log
+#define SIO_PACKET_ACK_ID 8
 // #define SOCKETIOCLIENT_DEBUG(...) Serial.printf(__VA_ARGS__);
 #define SOCKETIOCLIENT_DEBUG(...)
 #define DEFAULT_PORT 80
@@ -57,6 +164,54 @@ typedef enum {
    sIOtype_BINARY_ACK = '6',
 } socketIOmessageType_t;
 
+typedef enum {
+   sIOoverflow_DROP_OLDEST, ///< Evict the oldest queued packets to make room
+   sIOoverflow_DROP_NEWEST, ///< Drop the packet being emitted
+   sIOoverflow_REJECT,      ///< Refuse the packet being emitted, the caller may retry later
+} socketIOoverflowPolicy_t;
+
+typedef enum {
+   sIOpriority_HIGH,   ///< Control traffic: sent before any normal packet
+   sIOpriority_NORMAL, ///< Bulk traffic such as telemetry, the default
+} socketIOpriority_t;
+
+typedef enum {
+   sIOencoding_JSON,    ///< Default Socket.IO parser: text frames, binary arguments sent as attachments
+   sIOencoding_MSGPACK, ///< socket.io-msgpack-parser: every packet is one binary MessagePack frame
+} socketIOencoding_t;
+
+typedef enum {
+   sIOemit_QUEUED = 0,       ///< Packet queued
+   sIOemit_QUEUED_EVICTED,   ///< Packet queued after dropping older packets (sIOoverflow_DROP_OLDEST)
+   sIOemit_DROPPED,          ///< Queue full, packet dropped (sIOoverflow_DROP_NEWEST)
+   sIOemit_REJECTED,         ///< Queue full, packet not queued (sIOoverflow_REJECT)
+   sIOemit_TOO_LARGE,        ///< Packet larger than the whole queue
+   sIOemit_DISCONNECTED,     ///< Not connected, packet not queued
+   sIOemit_INVALID_JSON,     ///< emitRaw payload is not one JSON value
+   sIOemit_ACK_POOL_FULL,    ///< SIO_MAX_PENDING_ACKS acks already pending, packet not queued
+   sIOemit_NO_ACK_ID,        ///< ack() outside of a listener whose event requested an ack
+   sIOemit_COALESCED,        ///< Replaced the pending packet of a coalesced event
+   sIOemit_SENT,             ///< Volatile packet written at once
+   sIOemit_VOLATILE_DROPPED, ///< Volatile packet dropped, the connection was not writable
+} socketIOemitResult_t;
+
+typedef enum {
+   sIOstream_DATA,  ///< A chunk of the arguments, more follow
+   sIOstream_END,   ///< The last chunk (may be empty): the event is complete, ack() answers it
+   sIOstream_ABORT, ///< The event will not complete (connection lost, malformed end), chunk is NULL
+} socketIOstreamState_t;
+
+/**
+ * Listener of onStream: gets the arguments of an event as raw JSON text
+ * (["event",args...] without the name and the brackets) chunk by chunk, as
+ * the fragments of the message arrive. Chunks are not terminated and only
+ * valid during the call.
+ */
+typedef std::function<void(const char *chunk, size_t length, socketIOstreamState_t state)> SocketIOStreamHandler;
+
+// Uses the types above
+#include "SocketIONamespace.h"
+
 class ArduinoSocketIOClient : protected WebSocketsClient {
  public:
 #ifdef __AVR__
@@ -68,20 +223,21 @@ class ArduinoSocketIOClient : protected WebSocketsClient {
    ArduinoSocketIOClient(void);
    virtual ~ArduinoSocketIOClient(void);
 
-   void begin(const char *host, uint16_t port = DEFAULT_PORT, const char *nsp = DEFAULT_PATH, const char *url = DEFAULT_URL, const char *protocol = DEFAULT_PROTOCOL);
-   void begin(String host, uint16_t port = DEFAULT_PORT, String nsp = DEFAULT_PATH, String url = DEFAULT_URL, String protocol = DEFAULT_PROTOCOL);
+   void begin(const char *host, uint16_t port = DEFAULT_PORT, const char *nsp = DEFAULT_PATH, const char *url = DEFAULT_URL, const char *protocol = DEFAULT_PROTOCOL, socketIOencoding_t encoding = sIOencoding_JSON);
+   void begin(String host, uint16_t port = DEFAULT_PORT, String nsp = DEFAULT_PATH, String url = DEFAULT_URL, String protocol = DEFAULT_PROTOCOL, socketIOencoding_t encoding = sIOencoding_JSON);
 
 #ifdef HAS_SSL
-   void beginSSL(const char *host, const char *nsp = DEFAULT_PATH, uint16_t port = DEFAULT_SSL_PORT, const char *url = DEFAULT_URL, const char *protocol = DEFAULT_PROTOCOL);
-   void beginSSL(String host, String nsp = DEFAULT_PATH, uint16_t port = DEFAULT_SSL_PORT, String url = DEFAULT_URL, String protocol = DEFAULT_PROTOCOL);
+   void beginSSL(const char *host, const char *nsp = DEFAULT_PATH, uint16_t port = DEFAULT_SSL_PORT, const char *url = DEFAULT_URL, const char *protocol = DEFAULT_PROTOCOL, socketIOencoding_t encoding = sIOencoding_JSON);
+   void beginSSL(String host, String nsp = DEFAULT_PATH, uint16_t port = DEFAULT_SSL_PORT, String url = DEFAULT_URL, String protocol = DEFAULT_PROTOCOL, socketIOencoding_t encoding = sIOencoding_JSON);
 #ifndef SSL_AXTLS
-   void beginSSLWithCA(const char *host, const char *nsp = DEFAULT_PATH, uint16_t port = DEFAULT_SSL_PORT, const char *url = DEFAULT_URL, const char *CA_cert = NULL, const char *protocol = DEFAULT_PROTOCOL);
-   void beginSSLWithCA(const char *host, const char *nsp = DEFAULT_PATH, uint16_t port = DEFAULT_SSL_PORT, const char *url = DEFAULT_URL, BearSSL::X509List *CA_cert = NULL, const char *protocol = DEFAULT_PROTOCOL);
+   void beginSSLWithCA(const char *host, const char *nsp = DEFAULT_PATH, uint16_t port = DEFAULT_SSL_PORT, const char *url = DEFAULT_URL, const char *CA_cert = NULL, const char *protocol = DEFAULT_PROTOCOL, socketIOencoding_t encoding = sIOencoding_JSON);
+   void beginSSLWithCA(const char *host, const char *nsp = DEFAULT_PATH, uint16_t port = DEFAULT_SSL_PORT, const char *url = DEFAULT_URL, BearSSL::X509List *CA_cert = NULL, const char *protocol = DEFAULT_PROTOCOL, socketIOencoding_t encoding = sIOencoding_JSON);
    void setSSLClientCertKey(const char *clientCert = NULL, const char *clientPrivateKey = NULL);
    void setSSLClientCertKey(BearSSL::X509List *clientCert = NULL, BearSSL::PrivateKey *clientPrivateKey = NULL);
 #endif
 #endif
    bool isConnected(void);
+   socketIOencoding_t getEncoding(void) const { return _encoding; }
 
    void onEvent(SocketIOClientEvent cbEvent);
 
@@ -97,31 +253,260 @@ class ArduinoSocketIOClient : protected WebSocketsClient {
    bool send(socketIOmessageType_t type, const char *payload, size_t length = 0);
    bool send(socketIOmessageType_t type, String &payload);
 
-   void loop(void);
+   bool loop(uint32_t timeBudget = 0, size_t byteBudget = 0);
 
    void configureEIOping(bool disableHeartbeat = false);
+   uint32_t getPingInterval(void) const { return _pingInterval; }
+   uint32_t getPingTimeout(void) const { return _pingTimeout; }
+   uint32_t getMaxPayload(void) const { return _maxPayload; }
+   void configureMemory(size_t arenaSize);
+   void configureMemory(uint8_t *buffer, size_t capacity);
+   void configureQueue(size_t maxBytes = 0, size_t maxPackets = 0, socketIOoverflowPolicy_t policy = sIOoverflow_DROP_OLDEST);
+   size_t getQueueDepth(void) const;
+   size_t getQueueDepth(socketIOpriority_t lane) const;
+   size_t getQueueBytes(void) const;
+   size_t getQueueHighWaterMark(void) const;
+   size_t getQueueHighWaterBytes(void) const;
+   void resetQueueHighWaterMark(void);
+   void setOfflineLog(SocketIOOfflineLog *log);
+   bool coalesce(const char *event, bool enable = true);
+   size_t getCoalescedReplaced(void) const { return _coalescedReplaced; }
+   size_t getCoalescedSent(void) const { return _coalescedSent; }
+   void configurePriority(size_t laneBytes = SIO_PRIORITY_QUEUE_SIZE, uint8_t ratio = SIO_PRIORITY_RATIO);
+   bool setPriority(const char *event, socketIOpriority_t priority = sIOpriority_HIGH);
+   void configureReconnect(uint32_t delay = SIO_RECONNECT_DELAY, uint32_t maxDelay = SIO_RECONNECT_DELAY_MAX, uint8_t jitter = SIO_RECONNECT_JITTER);
+   uint32_t getReconnectDelay(void) const { return _reconnectWait; }
+   uint16_t getReconnectAttempts(void) const { return _reconnectAttempts; }
+   bool isRecovered(void) const { return _namespaces[0].isRecovered(); }
+   void configureOfflineReplay(uint16_t packets = SIO_OFFLINE_REPLAY_PACKETS, uint32_t interval = SIO_OFFLINE_REPLAY_INTERVAL);
+   const SocketIOStats &getStats(void);
+   void resetStats(void);
+
+   SocketIONamespace *of(const char *nsp);
 
    void on(const char *event, std::function<void(const char *payload, size_t length)>);
    void on(String event, std::function<void(const char *payload, size_t length)>);
+   void on(const SocketIOEvent &event, std::function<void(const char *payload, size_t length)>);
    void remove(const char *event);
    void remove(String event);
+   void remove(const SocketIOEvent &event);
    void removeAll(void);
-   void emit(const char *event, const char *payload = NULL);
-   void emit(String event, String payload);
-   void handleEvent(uint8_t *payload);
+   bool onStream(const char *event, SocketIOStreamHandler handler);
+   bool onRoute(const char *pattern, SocketIORouteHandler handler) { return _namespaces[0].onRoute(pattern, handler); }
+   bool removeRoute(const char *pattern) { return _namespaces[0].removeRoute(pattern); }
+   bool onAny(SocketIORouteHandler handler) { return _namespaces[0].onAny(handler); }
+   size_t getRouteMemory(void) const;
+
+   // Typed listeners of the main namespace, see SocketIONamespace::on
+   template <typename T, size_t Capacity = SIO_JSON_DOCUMENT_SIZE>
+   void on(const char *event, const JsonDocument &filter, std::function<void(const T &value)> handler) {
+      _namespaces[0].on<T, Capacity>(event, filter, handler);
+   }
+
+   template <typename T, size_t Capacity = SIO_JSON_DOCUMENT_SIZE>
+   void on(const char *event, std::function<void(const T &value)> handler) {
+      _namespaces[0].on<T, Capacity>(event, handler);
+   }
+   socketIOemitResult_t emit(const char *event, const char *payload = NULL);
+   socketIOemitResult_t emit(String event, String payload);
+   socketIOemitResult_t emitRaw(const char *event, const char *json, size_t length = 0);
+
+   /**
+    * Send an event with any number of arguments: numbers, bool, strings,
+    * SocketIORawJson and ArduinoJson documents / variants, serialized straight
+    * into the outbound queue. emit("move", x, y, true) sends ["move",x,y,true].
+    */
+   template <typename... Args>
+   socketIOemitResult_t emit(const char *event, const Args &...args) {
+      return emitPacket(_namespaces[0], sIOtype_EVENT, -1, sIOpriority_NORMAL, event, args...);
+   }
+
+   /**
+    * Same as emit, in the lane of priority: sIOpriority_HIGH packets are sent
+    * before the normal ones already queued.
+    */
+   template <typename... Args>
+   socketIOemitResult_t emitWithPriority(socketIOpriority_t priority, const char *event, const Args &...args) {
+      return emitPacket(_namespaces[0], sIOtype_EVENT, -1, priority, event, args...);
+   }
+
+   /**
+    * Send an event now or never: written at once when the connection can take
+    * it (sIOemit_SENT), dropped otherwise (sIOemit_VOLATILE_DROPPED) without
+    * touching the queue. For values worthless once stale, such as positions.
+    * The packet and each attachment must fit in SIO_FRAME_BUFFER_SIZE.
+    */
+   template <typename... Args>
+   socketIOemitResult_t emitVolatile(const char *event, const Args &...args) {
+      return emitVolatileIn(_namespaces[0], event, args...);
+   }
+
+   /**
+    * Same as emit, asking the server to acknowledge: callback is called with the
+    * first argument of its answer, or with payload NULL after timeout
+    * milliseconds (0: no timeout) or when the connection is lost.
+    */
+   template <typename... Args>
+   socketIOemitResult_t emitWithAck(const char *event, uint32_t timeout, SocketIOAckHandler callback, const Args &...args) {
+      return emitWithAckIn(_namespaces[0], event, timeout, std::move(callback), args...);
+   }
+
+   /**
+    * Answer the ack requested by the event being handled, from inside its
+    * listener: socket.ack("done") sends ["done"] back to the server's
+    * callback, in the namespace of the event.
+    */
+   template <typename... Args>
+   socketIOemitResult_t ack(const Args &...args) {
+      return sendAck(_ackRequestId, args...);
+   }
+
+   /**
+    * Answer an ack request later: keep getAckId() from the listener and pass
+    * it here.
+    */
+   template <typename... Args>
+   socketIOemitResult_t sendAck(int32_t id, const Args &...args) {
+      if (id < 0) {
+         return sIOemit_NO_ACK_ID;
+      }
+      return emitPacket(_ackNamespace ? *_ackNamespace : _namespaces[0], sIOtype_ACK, id, sIOpriority_NORMAL, NULL, args...);
+   }
+
+   int32_t getAckId(void) const { return _ackRequestId; }
+   size_t getPendingAcks(void) const;
+
+   socketIOparseError_t handleEvent(uint8_t *payload);
+   socketIOparseError_t handleEvent(uint8_t *payload, size_t length);
+   socketIOparseError_t handleBinaryEvent(uint8_t *payload, size_t length);
+   socketIOparseError_t handleBinaryAck(uint8_t *payload, size_t length);
+
+   const uint8_t *getAttachment(uint8_t num, size_t *length) const;
+   uint8_t getAttachmentCount(void) const { return _attachmentCount; }
 
  protected:
+   friend class SocketIONamespace;
+   friend class SocketIOTask;
+
    const char *_nsp;
    bool _disableHeartbeat = false;
-   uint64_t _lastHeartbeat = 0;
+   socketIOencoding_t _encoding = sIOencoding_JSON;
+
+   // Engine.IO handshake: the OPEN packet sets the heartbeat and the frame limit
+   uint32_t _pingInterval = EIO_HEARTBEAT_INTERVAL;
+   uint32_t _pingTimeout = EIO_HEARTBEAT_TIMEOUT;
+   uint32_t _maxPayload = 0;         ///< Largest frame the server accepts, 0 if not known
+   unsigned long _lastHeartbeat = 0; ///< millis() of the last sign of life of the server
+   unsigned long _lastPing = 0;      ///< millis() of the last ping sent (EIO=3)
+   uint32_t _connectStart = 0;       ///< micros() when the connection attempt started
+   bool _connecting = false;         ///< The main namespace is not joined yet
    SocketIOClientEvent _cbEvent;
 
-   std::vector<String> _packets;
-   std::map<String, std::function<void(const char *payload, size_t length)>> _events;
+   size_t _arenaSize = SIO_ARENA_SIZE;
+   SocketIOArena _arena;
+   uint8_t *_frameBuffer = NULL;
+   uint8_t *_packet = NULL; ///< Packet between beginPacket and endPacket
+   size_t _frameBufferSize = 0;
+   SocketIOPacketQueue _packets;         ///< Normal lane
+   SocketIOPacketQueue _priorityPackets; ///< High priority lane, sent first
+   SocketIOPacketQueue *_lane = NULL;    ///< Lane of the packet being emitted
+   size_t _priorityBytes = SIO_PRIORITY_QUEUE_SIZE;
+   uint8_t _priorityRatio = SIO_PRIORITY_RATIO;
+   uint8_t _priorityBurst = 0; ///< High priority packets sent in a row while normal ones wait
+   size_t _queueBytes = 0;
+   size_t _queuePackets = 0;
+   socketIOoverflowPolicy_t _overflowPolicy = sIOoverflow_DROP_OLDEST;
+   // The main namespace (_nsp) first, then the ones added by of()
+   SocketIONamespace _namespaces[SIO_MAX_NAMESPACES];
+   uint8_t _namespaceCount = 1;
+   SocketIOStats _stats;
+   bool _connectedOnce = false;
+
+   // Latest value wins: at most one pending packet per coalesced event
+   typedef struct {
+      const char *event;
+      uint32_t hash;
+      uint8_t *packet;           ///< Its packet in the queue, NULL if none
+      SocketIOPacketQueue *lane; ///< Lane of that packet
+   } CoalescedEvent;
+
+   // Events sent in the high priority lane
+   typedef struct {
+      const char *event;
+      uint32_t hash;
+   } PriorityEvent;
+
+   PriorityEvent _priorityEvents[SIO_MAX_PRIORITY_EVENTS];
+   uint8_t _priorityEventCount = 0;
+
+   // Events received chunk by chunk
+   typedef struct {
+      SocketIONamespace *nsp;
+      const char *event;
+      size_t length;
+      SocketIOStreamHandler handler;
+   } StreamListener;
+
+   StreamListener _streams[SIO_MAX_STREAM_EVENTS];
+   uint8_t _streamCount = 0;
+   StreamListener *_stream = NULL; ///< Listener of the fragmented message being received, NULL if none
+   int32_t _streamAckId = -1;
+   bool _streamSkip = false; ///< Fragments of a dropped message still to come
+
+   CoalescedEvent _coalesced[SIO_MAX_COALESCED_EVENTS];
+   uint8_t _coalescedCount = 0;
+   CoalescedEvent *_coalescing = NULL; ///< Event of the packet between beginPacket and endPacket
+   bool _inPlace = false;              ///< That packet replaces the pending one
+   size_t _coalescedReplaced = 0;
+   size_t _coalescedSent = 0;
+
+   // Reconnection backoff, 0 delay: WebSocketsClient's fixed interval
+   uint32_t _reconnectDelay = SIO_RECONNECT_DELAY;
+   uint32_t _reconnectDelayMax = SIO_RECONNECT_DELAY_MAX;
+   uint8_t _reconnectJitter = SIO_RECONNECT_JITTER;
+   uint16_t _reconnectAttempts = 0;  ///< Attempts scheduled since the connection was lost
+   uint32_t _reconnectWait = 0;      ///< Wait before the next attempt, 0 if it may start now
+   unsigned long _reconnectFrom = 0; ///< millis() when the wait started
+   bool _reconnecting = false;       ///< An attempt was let through, its outcome is pending
+
+   // Budget of the loop() call running
+   uint32_t _budgetStart = 0;
+   uint32_t _timeBudget = 0;
+   size_t _byteBudget = 0;
+   size_t _budgetSent = 0;
+
+   // Store and forward: packets emitted offline wait in a file
+   SocketIOOfflineLog *_offline = NULL;
+   uint16_t _replayPackets = SIO_OFFLINE_REPLAY_PACKETS;
+   uint32_t _replayInterval = SIO_OFFLINE_REPLAY_INTERVAL;
+   unsigned long _lastReplay = 0;
+   // No room to load the next record: the normal lane may send one packet
+   bool _replayBlocked = false;
+
+   // Incoming binary packet waiting for its attachments
+   uint8_t *_binaryBuffer = NULL;
+   size_t _binaryBufferSize = 0;
+   size_t _binaryUsed = 0;
+   size_t _binaryHeaderLength = 0;
+   socketIOmessageType_t _binaryType = sIOtype_BINARY_EVENT;
+   uint8_t _binaryExpected = 0;
+   uint8_t _binarySkip = 0; ///< Attachments of a dropped packet still to come
+   SocketIOBinary _attachments[SIO_MAX_ATTACHMENTS];
+   uint8_t _attachmentCount = 0; ///< Attachments received, readable while the packet is dispatched
+   int32_t _ackRequestId = -1; ///< Ack id of the event being handled, -1 if none
+   SocketIONamespace *_ackNamespace = NULL; ///< Namespace of that event
 
    void trigger(const char *event, const char *payload, size_t length);
-   String getEventName(String msg);
-   String getEventPayload(String msg);
+   void trigger(SocketIONamespace &nsp, const char *event, const char *payload, size_t length);
+   SocketIONamespace *findNamespace(const char *name, size_t length);
+   void handleNamespace(socketIOmessageType_t type, uint8_t *payload, size_t length);
+   bool addStream(SocketIONamespace *nsp, const char *event, SocketIOStreamHandler handler);
+   StreamListener *findStream(const SocketIONamespace *nsp, const char *event, size_t length);
+   bool handleStream(uint8_t *payload, size_t length);
+   void beginFragments(WStype_t type, uint8_t *payload, size_t length);
+   void handleFragment(uint8_t *payload, size_t length, bool fin);
+   void deliverChunk(StreamListener *stream, int32_t ackId, const char *chunk, size_t length, socketIOstreamState_t state);
+   bool endChunk(const char *chunk, size_t &length);
 
    virtual void runIOCbEvent(socketIOmessageType_t type, uint8_t *payload, size_t length) {
       if (_cbEvent) {
@@ -131,6 +516,156 @@ class ArduinoSocketIOClient : protected WebSocketsClient {
    }
 
    void initClient(void);
+   bool isWritable(void);
+   bool sendSplit(socketIOmessageType_t type, uint8_t *payload, size_t length);
+   void countSent(bool sent, socketIOmessageType_t type, size_t length);
+   bool sendEngineIO(const char *payload);
+   void handleOpen(const char *data, size_t length);
+   void checkHeartbeat(unsigned long t);
+   bool fitsPayload(size_t length) const { return !_maxPayload || length + 2 <= _maxPayload; }
+   bool initMemory(void);
+   uint8_t *reservePacket(size_t length, socketIOemitResult_t &result);
+   char *beginPacket(const SocketIONamespace &nsp, socketIOmessageType_t type, int32_t ackId, const char *event, const SocketIOFrameWriter &measure, socketIOemitResult_t &result);
+   void endPacket(const char *message, const SocketIOFrameWriter &writer);
+   static size_t packetSize(const SocketIONamespace &nsp, int32_t ackId, const SocketIOFrameWriter &measure, size_t *messageLength);
+   static void stampPacket(uint8_t *packet, socketIOmessageType_t type, int32_t ackId, size_t messageLength);
+   static char *writeHeader(uint8_t *packet, const SocketIONamespace &nsp, socketIOmessageType_t type, int32_t ackId, const SocketIOFrameWriter &measure, size_t messageLength);
+   static uint8_t *writeAttachments(uint8_t *end, const SocketIOFrameWriter &writer);
+   socketIOparseError_t handleAck(uint8_t *payload, size_t length);
+   socketIOparseError_t beginBinary(socketIOmessageType_t type, uint8_t *payload, size_t length);
+   void handleAttachment(uint8_t *payload, size_t length);
+   socketIOparseError_t dispatchBinary(void);
+   static void clearMask(uint8_t *room);
+   static void unmask(uint8_t *room, size_t length);
+   bool sendPacket(uint8_t *packet, size_t length);
+   uint8_t *beginMsgPack(socketIOmessageType_t type, int32_t ackId, size_t length, socketIOemitResult_t &result);
+   bool sendMsgPack(socketIOmessageType_t type, uint8_t *payload, size_t length);
+   bool sendNamespace(socketIOmessageType_t type, const SocketIONamespace &nsp);
+   socketIOparseError_t handleMsgPack(uint8_t *payload, size_t length);
+   socketIOparseError_t decodeMsgPack(const SocketIOMsgPackPacket &packet, bool named, SocketIOEventFrame &frame);
+   void updateNamespace(SocketIONamespace &nsp, socketIOmessageType_t type, const char *data, size_t length);
+   char *beginVolatile(const SocketIONamespace &nsp, const SocketIOFrameWriter &measure, socketIOemitResult_t &result);
+   socketIOemitResult_t endVolatile(const char *message, const SocketIOFrameWriter &writer);
+   socketIOemitResult_t dropVolatile(void) {
+      _stats.volatileDrops++;
+      return sIOemit_VOLATILE_DROPPED;
+   }
+   bool popPacket(SocketIOPacketQueue &queue);
+   PriorityEvent *findPriority(const char *event);
+   SocketIOPacketQueue *selectLane(socketIOpriority_t priority, const char *event);
+   SocketIOPacketQueue *nextLane(void);
+   bool withinBudget(void);
+   bool reconnectDue(void);
+   void scheduleReconnect(void);
+   bool isReadable(void);
+   CoalescedEvent *findCoalesced(const char *event);
+   void spillPackets(SocketIOPacketQueue &queue);
+   void replayPackets(void);
+   bool loadRecord(uint8_t *packet, size_t recordLength, size_t *length);
+
+   // Queue [/nsp,][ackId]["event",args...], or [/nsp,]ackId[args...] for an ack
+   // (event NULL). With SocketIOBinary arguments the packet becomes
+   // N-[/nsp,][ackId][...] followed by N attachments. Events marked with
+   // setPriority() go in the high priority lane whatever priority says.
+   template <typename... Args>
+   socketIOemitResult_t emitPacket(const SocketIONamespace &nsp, socketIOmessageType_t type, int32_t ackId, socketIOpriority_t priority, const char *event, const Args &...args) {
+      // With an offline log, events are queued anyway and loop() stores them
+      if (!isConnected() && (!_offline || type != sIOtype_EVENT)) {
+         SOCKETIOCLIENT_DEBUG("[SIoC]: Disconnected!");
+         return sIOemit_DISCONNECTED;
+      }
+      _lane = selectLane(priority, event);
+      if (_encoding == sIOencoding_MSGPACK) {
+         return emitMsgPack(nsp, type, ackId, event, args...);
+      }
+
+      // Measure, then write where the packet will be sent from
+      SocketIOFrameWriter measure;
+      event ? measure.event(event, args...) : measure.array(args...);
+      if (measure.tooManyAttachments()) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] more than %d attachments\n", SIO_MAX_ATTACHMENTS);
+         return sIOemit_TOO_LARGE;
+      }
+      if (measure.attachments()) {
+         type = type == sIOtype_ACK ? sIOtype_BINARY_ACK : sIOtype_BINARY_EVENT;
+      }
+
+      socketIOemitResult_t result;
+      char *message = beginPacket(nsp, type, ackId, event, measure, result);
+      if (message) {
+         SocketIOFrameWriter writer(message, measure.length() + 1);
+         event ? writer.event(event, args...) : writer.array(args...);
+         message[measure.length()] = '\0';
+         endPacket(message, writer);
+      }
+      return result;
+   }
+
+   // Queue the packet encoded by socket.io-msgpack-parser, binary arguments
+   // inlined: {"type":2,"nsp":"/","data":["event",args...],"id":ackId}
+   template <typename... Args>
+   socketIOemitResult_t emitMsgPack(const SocketIONamespace &nsp, socketIOmessageType_t type, int32_t ackId, const char *event, const Args &...args) {
+      SocketIOMsgPackWriter measure;
+      measure.packet(type - '0', nsp._name, nsp._nameLength, ackId, event, args...);
+
+      socketIOemitResult_t result;
+      uint8_t *message = beginMsgPack(type, ackId, measure.length(), result);
+      if (message) {
+         SocketIOMsgPackWriter writer(message, measure.length());
+         writer.packet(type - '0', nsp._name, nsp._nameLength, ackId, event, args...);
+         _lane->commit(SIO_MAX_HEADER_SIZE + measure.length() + 1);
+      }
+      return result;
+   }
+
+   // Write [/nsp,]["event",args...] straight from the frame buffer, or drop it
+   template <typename... Args>
+   socketIOemitResult_t emitVolatileIn(const SocketIONamespace &nsp, const char *event, const Args &...args) {
+      if (!isWritable() || !_frameBuffer) {
+         return dropVolatile();
+      }
+      if (_encoding == sIOencoding_MSGPACK) {
+         SocketIOMsgPackWriter writer(_frameBuffer + SIO_MAX_HEADER_SIZE, _frameBufferSize - SIO_MAX_HEADER_SIZE);
+         writer.packet(sIOtype_EVENT - '0', nsp._name, nsp._nameLength, -1, event, args...);
+         if (writer.overflowed() || !fitsPayload(writer.length())) {
+            SOCKETIOCLIENT_DEBUG("[SIoC] volatile packet too large (%u bytes)\n", writer.length());
+            _stats.droppedPackets++;
+            return sIOemit_TOO_LARGE;
+         }
+         return sendMsgPack(sIOtype_EVENT, _frameBuffer + SIO_MAX_HEADER_SIZE - WEBSOCKETS_MAX_HEADER_SIZE, writer.length()) ? sIOemit_SENT : dropVolatile();
+      }
+
+      SocketIOFrameWriter measure;
+      measure.event(event, args...);
+      socketIOemitResult_t result;
+      char *message = beginVolatile(nsp, measure, result);
+      if (message) {
+         SocketIOFrameWriter writer(message, measure.length() + 1);
+         writer.event(event, args...);
+         result = endVolatile(message, writer);
+      }
+      return result;
+   }
+
+   template <typename... Args>
+   socketIOemitResult_t emitWithAckIn(SocketIONamespace &nsp, const char *event, uint32_t timeout, SocketIOAckHandler callback, const Args &...args) {
+      if (!isConnected()) {
+         SOCKETIOCLIENT_DEBUG("[SIoC]: Disconnected!");
+         return sIOemit_DISCONNECTED;
+      }
+
+      int32_t id = nsp._acks.acquire(std::move(callback), timeout, millis());
+      if (id < 0) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] %u acks pending, %s not sent\n", nsp._acks.pending(), event);
+         return sIOemit_ACK_POOL_FULL;
+      }
+
+      socketIOemitResult_t result = emitPacket(nsp, sIOtype_EVENT, id, sIOpriority_NORMAL, event, args...);
+      if (result != sIOemit_QUEUED && result != sIOemit_QUEUED_EVICTED) {
+         nsp._acks.release(id);
+      }
+      return result;
+   }
 
    void socketEvent(socketIOmessageType_t type, uint8_t *payload, size_t length);
 
@@ -139,4 +674,19 @@ class ArduinoSocketIOClient : protected WebSocketsClient {
    void handleCbEvent(WStype_t type, uint8_t *payload, size_t length);
 };
 
+template <typename... Args>
+socketIOemitResult_t SocketIONamespace::emit(const char *event, const Args &...args) {
+   return _client->emitPacket(*this, sIOtype_EVENT, -1, sIOpriority_NORMAL, event, args...);
+}
+
+template <typename... Args>
+socketIOemitResult_t SocketIONamespace::emitWithAck(const char *event, uint32_t timeout, SocketIOAckHandler callback, const Args &...args) {
+   return _client->emitWithAckIn(*this, event, timeout, std::move(callback), args...);
+}
+
+template <typename... Args>
+socketIOemitResult_t SocketIONamespace::emitVolatile(const char *event, const Args &...args) {
+   return _client->emitVolatileIn(*this, event, args...);
+}
+
 #endif /* ARDUINOSOCKETIOCLIENT_H_ */
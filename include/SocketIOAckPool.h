@@ -0,0 +1,69 @@
+/**
+ * SocketIOAckPool.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOACKPOOL_H_
+#define SOCKETIOACKPOOL_H_
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+// Acks waiting for the server at once
+#ifndef SIO_MAX_PENDING_ACKS
+#define SIO_MAX_PENDING_ACKS 8
+#endif
+
+/**
+ * Called with the first argument of the server's ack (same rules as an event
+ * listener), or with payload NULL when the ack timed out or the connection was
+ * lost.
+ */
+typedef std::function<void(const char *payload, size_t length)> SocketIOAckHandler;
+
+/**
+ * Fixed pool of pending acks. An ack id is sequence * SIO_MAX_PENDING_ACKS +
+ * slot, so the slot of an incoming ack is found by a modulo and free slots are
+ * kept on a stack: acquiring, resolving and releasing are O(1) and allocate
+ * nothing. The handler is moved into its slot, never copied: a lambda that
+ * captures up to two pointers (references) fits std::function's inline storage
+ * and costs no allocation either, larger captures cost one when it is built.
+ */
+class SocketIOAckPool {
+ public:
+   SocketIOAckPool(void);
+   virtual ~SocketIOAckPool(void);
+
+   int32_t acquire(SocketIOAckHandler handler, uint32_t timeout, uint32_t now);
+   bool release(int32_t id);
+   bool resolve(int32_t id, const char *payload, size_t length);
+   void sweep(uint32_t now);
+   void clear(void);
+
+   size_t pending(void) const { return SIO_MAX_PENDING_ACKS - _freeCount; }
+
+ protected:
+   typedef struct {
+      int32_t id; ///< -1 when the slot is free
+      uint32_t deadline;
+      bool expires;
+      SocketIOAckHandler handler;
+   } Slot;
+
+   Slot _slots[SIO_MAX_PENDING_ACKS];
+   uint8_t _free[SIO_MAX_PENDING_ACKS];
+   uint8_t _freeCount = 0;
+   uint32_t _sequence = 0;
+
+   // Nothing expires before it: sweep() is one compare until then
+   bool _hasDeadline = false;
+   uint32_t _nextDeadline = 0;
+
+   Slot *find(int32_t id);
+   SocketIOAckHandler take(Slot &slot);
+};
+
+#endif /* SOCKETIOACKPOOL_H_ */
@@ -0,0 +1,43 @@
+/**
+ * SocketIOArena.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOARENA_H_
+#define SOCKETIOARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Fixed memory region the client carves its buffers from. The region is
+ * either supplied by the user (static buffer) or allocated once on the heap;
+ * blocks are never freed one by one, only all together.
+ */
+class SocketIOArena {
+ public:
+   SocketIOArena(void);
+   virtual ~SocketIOArena(void);
+
+   bool begin(size_t capacity);
+   bool begin(uint8_t *buffer, size_t capacity);
+   void end(void);
+
+   uint8_t *allocate(size_t size);
+   void reset(void);
+
+   bool isReady(void) const { return _buffer != NULL; }
+   size_t capacity(void) const { return _capacity; }
+   size_t used(void) const { return _used; }
+   size_t available(void) const { return _capacity - _used; }
+
+ protected:
+   uint8_t *_buffer = NULL;
+   size_t _capacity = 0;
+   size_t _used = 0;
+   bool _owned = false;
+};
+
+#endif /* SOCKETIOARENA_H_ */
@@ -0,0 +1,74 @@
+/**
+ * SocketIOEventParser.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOEVENTPARSER_H_
+#define SOCKETIOEVENTPARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Nesting accepted by SocketIOEventParser::isJson, one bit per level
+#define SIO_JSON_MAX_DEPTH 32
+
+typedef enum {
+   sIOparse_OK = 0,          ///< Frame parsed
+   sIOparse_EMPTY,           ///< Frame has no data after the Socket.IO header
+   sIOparse_BAD_NAMESPACE,   ///< Namespace prefix is not terminated by ','
+   sIOparse_BAD_ACK_ID,      ///< Ack id does not fit in 31 bits
+   sIOparse_NOT_ARRAY,       ///< Frame body is not a JSON array
+   sIOparse_BAD_EVENT_NAME,  ///< First element is missing or is not a JSON string
+   sIOparse_BAD_ARGUMENT,    ///< An argument is not a well-formed JSON value
+   sIOparse_UNTERMINATED,    ///< Array is not closed before the end of the frame
+   sIOparse_MISSING_ACK_ID,  ///< Ack frame without ack id
+   sIOparse_BAD_ATTACHMENTS, ///< Binary frame without "N-" attachment count, or with attachments that can not be held
+   sIOparse_BAD_PACKET,      ///< MessagePack frame that is not a map with a valid "type"
+} socketIOparseError_t;
+
+/**
+ * Result of parsing an event frame. All pointers borrow the receive buffer
+ * that was handed to SocketIOEventParser::parseEvent and are only valid while
+ * that buffer is.
+ */
+typedef struct {
+   const char *nsp;    ///< Namespace (not terminated), "/" when the frame has no prefix
+   size_t nspLength;   ///< Length of nsp
+   int32_t ackId;      ///< Ack id requested by the sender, -1 if none
+   const char *event;  ///< Event name, unescaped and terminated in place, NULL for an ack
+   size_t eventLength; ///< Length of event
+   const char *data;   ///< First argument, terminated in place: string content if it is a JSON string, raw JSON text otherwise
+   size_t dataLength;  ///< Length of data, 0 if the event has no argument
+   uint8_t argc;       ///< Number of arguments after the event name (saturates at 255)
+   const char *last;   ///< Last argument, raw JSON text (not terminated, not unescaped), "" if none
+   size_t lastLength;  ///< Length of last
+} SocketIOEventFrame;
+
+class SocketIOEventParser {
+ public:
+   static socketIOparseError_t parseEvent(uint8_t *payload, size_t length, SocketIOEventFrame &frame);
+   static socketIOparseError_t parseAck(uint8_t *payload, size_t length, SocketIOEventFrame &frame);
+   static socketIOparseError_t parseEventHead(const uint8_t *payload, size_t length, SocketIOEventFrame &frame);
+   static const char *errorToString(socketIOparseError_t error);
+
+   static const char *findMember(const char *json, size_t length, const char *key, size_t *valueLength);
+   static const char *findString(const char *json, size_t length, const char *key, size_t *valueLength);
+   static bool findNumber(const char *json, size_t length, const char *key, uint32_t *value);
+
+   static const char *skipValue(const char *p, const char *end);
+   static bool isJson(const char *json, size_t length);
+   static const char *skipString(const char *p, const char *end);
+   static size_t unescape(char *str, size_t length);
+   static size_t unescape(const char *str, size_t length, char *out);
+
+ protected:
+   static socketIOparseError_t parseHead(const char *&p, const char *end, SocketIOEventFrame &frame);
+   static socketIOparseError_t parse(uint8_t *payload, size_t length, SocketIOEventFrame &frame, bool named);
+   static const char *skipSpace(const char *p, const char *end);
+   static const char *checkString(const char *p, const char *end);
+   static const char *checkScalar(const char *p, const char *end);
+};
+
+#endif /* SOCKETIOEVENTPARSER_H_ */
@@ -0,0 +1,96 @@
+/**
+ * SocketIOEventRouter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOEVENTROUTER_H_
+#define SOCKETIOEVENTROUTER_H_
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+// Initial room of a router, doubled when full
+#ifndef SIO_ROUTER_NODES
+#define SIO_ROUTER_NODES 16
+#endif
+#ifndef SIO_ROUTER_LABELS
+#define SIO_ROUTER_LABELS 64
+#endif
+
+#define SIO_ROUTE_NONE 0xFFFF
+
+/**
+ * Listener of a route: gets the name of the event it matched
+ */
+typedef std::function<void(const char *event, const char *payload, size_t length)> SocketIORouteHandler;
+
+/**
+ * Routes of hierarchical event names such as device/relay/3/set, with
+ * wildcard segments: a "*" segment in the middle of a pattern matches any one
+ * segment of the name, a pattern ending with a "*" segment matches every name
+ * it is a prefix of, and "*" alone catches every event. Patterns are kept in
+ * a compressed trie whose nodes sit in one array and whose labels are slices
+ * of one character pool: a lookup walks the name once whatever the number of
+ * routes, backtracking only at wildcards. Literal segments win over "*", and
+ * a "*" in the middle of a pattern over a trailing one.
+ */
+class SocketIOEventRouter {
+ public:
+   SocketIOEventRouter(void);
+   virtual ~SocketIOEventRouter(void);
+
+   bool add(const char *pattern, SocketIORouteHandler handler);
+   bool remove(const char *pattern);
+   void clear(void);
+
+   SocketIORouteHandler *find(const char *event, size_t length) const;
+   bool dispatch(const char *event, const char *payload, size_t length);
+
+   size_t size(void) const { return _count; }
+   size_t nodes(void) const { return _nodeCount; }
+   size_t memoryUsage(void) const;
+
+ protected:
+   typedef struct {
+      uint16_t label;   ///< Offset of the label in the pool
+      uint8_t length;   ///< Length of the label, 0 for the root and wildcards
+      uint8_t wildcard; ///< Matches a segment, or the rest of the name if the route ends here
+      uint16_t child;   ///< First child, SIO_ROUTE_NONE if none
+      uint16_t sibling; ///< Next child of the parent, SIO_ROUTE_NONE if none
+      uint16_t route;   ///< Listener of the pattern ending here, SIO_ROUTE_NONE if none
+   } Node;
+
+   Node *_nodes = NULL;
+   size_t _nodeCount = 0;
+   size_t _nodeCapacity = 0;
+   char *_labels = NULL;
+   size_t _labelLength = 0;
+   size_t _labelCapacity = 0;
+   SocketIORouteHandler *_handlers = NULL;
+   size_t _handlerCapacity = 0;
+   size_t _count = 0;
+
+   // Listener dispatch() runs, moved out of its slot meanwhile. Listeners
+   // dispatching from inside one are chained on the stack, innermost first.
+   typedef struct Running {
+      uint16_t route;
+      bool changed; ///< Replaced or removed while it runs
+      struct Running *outer;
+   } Running;
+
+   Running *_running = NULL;
+
+   uint16_t walk(const char *pattern, bool insert);
+   uint16_t literal(uint16_t node, const char *str, size_t length, bool insert);
+   uint16_t wildcard(uint16_t node, bool insert);
+   uint16_t newNode(uint16_t parent, uint16_t label, size_t length, bool wildcard);
+   uint16_t match(uint16_t node, const char *event, size_t pos, size_t length) const;
+   bool reserve(size_t nodes, size_t labels);
+   bool isRunning(uint16_t route) const;
+   void changed(uint16_t route);
+};
+
+#endif /* SOCKETIOEVENTROUTER_H_ */
@@ -0,0 +1,115 @@
+/**
+ * SocketIOEventTable.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOEVENTTABLE_H_
+#define SOCKETIOEVENTTABLE_H_
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIO_HASH_OFFSET 2166136261u
+#define SIO_HASH_PRIME 16777619u
+
+// Slots allocated by the first on(), the table doubles when it is 3/4 full
+#ifndef SIO_EVENT_TABLE_SIZE
+#define SIO_EVENT_TABLE_SIZE 16
+#endif
+
+typedef std::function<void(const char *payload, size_t length)> SocketIOEventHandler;
+
+/**
+ * Event name with its hash computed at compile time:
+ * constexpr SocketIOEvent SSM("server-send-message");
+ * The name is not copied by the table, it must be a literal or outlive it.
+ */
+struct SocketIOEvent {
+   const char *name;
+   uint32_t hash;
+
+   // FNV-1a, usable in constant expressions
+   static constexpr uint32_t hashOf(const char *str, uint32_t hash = SIO_HASH_OFFSET) { return *str ? hashOf(str + 1, (hash ^ (uint8_t)*str) * SIO_HASH_PRIME) : hash; }
+
+   explicit constexpr SocketIOEvent(const char *name) : name(name), hash(hashOf(name)) {}
+   constexpr SocketIOEvent(const char *name, uint32_t hash) : name(name), hash(hash) {}
+};
+
+/**
+ * Open addressed (linear probing) table of event handlers stored in one
+ * contiguous slot array. A lookup hashes the name once and compares the
+ * name only on a hash match.
+ * Handlers run through dispatch() may change the table: set(), remove() and
+ * clear() called meanwhile are applied once the outermost dispatch()
+ * returns, so the slot array and the running handler stay in place.
+ */
+class SocketIOEventTable {
+ public:
+   SocketIOEventTable(void);
+   virtual ~SocketIOEventTable(void);
+
+   bool set(const SocketIOEvent &event, SocketIOEventHandler handler, bool copyName = true);
+   bool remove(const SocketIOEvent &event);
+   void clear(void);
+
+   SocketIOEventHandler *find(const SocketIOEvent &event) const;
+   SocketIOEventHandler *find(const char *name) const;
+   bool dispatch(const SocketIOEvent &event, const char *payload, size_t length);
+   bool dispatch(const char *name, const char *payload, size_t length);
+
+   static uint32_t hash(const char *name);
+
+   size_t size(void) const { return _count; }
+   size_t capacity(void) const { return _capacity; }
+
+ protected:
+   typedef enum {
+      sIOslot_EMPTY = 0,
+      sIOslot_USED,
+      sIOslot_REMOVED, ///< Tombstone: keeps probe chains going through it
+   } slotState_t;
+
+   typedef enum {
+      sIOpending_SET,
+      sIOpending_REMOVE,
+      sIOpending_CLEAR,
+   } pendingOp_t;
+
+   typedef struct {
+      uint32_t hash;
+      uint8_t state;
+      bool ownsName;
+      const char *name;
+      SocketIOEventHandler handler;
+   } Slot;
+
+   Slot *_slots = NULL;
+   size_t _capacity = 0;
+   size_t _count = 0;
+   size_t _removed = 0;
+
+   // Changes made by handlers while dispatch() runs, in order
+   typedef struct Pending {
+      uint8_t op;
+      uint32_t hash;
+      bool ownsName;
+      const char *name;
+      SocketIOEventHandler handler;
+      struct Pending *next;
+   } Pending;
+
+   uint8_t _dispatching = 0; ///< Nesting of dispatch() calls
+   Pending *_pending = NULL;
+   Pending *_pendingTail = NULL;
+
+   Slot *lookup(const SocketIOEvent &event) const;
+   bool defer(pendingOp_t op, const SocketIOEvent *event, SocketIOEventHandler *handler, bool copyName);
+   void applyPending(void);
+   bool grow(size_t capacity);
+   void release(Slot &slot);
+};
+
+#endif /* SOCKETIOEVENTTABLE_H_ */
@@ -0,0 +1,160 @@
+/**
+ * SocketIOFrameWriter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOFRAMEWRITER_H_
+#define SOCKETIOFRAMEWRITER_H_
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/**
+ * JSON text written verbatim as an event argument: emit("event",
+ * SocketIORawJson("{\"a\":1}")) sends ["event",{"a":1}] instead of a string.
+ */
+struct SocketIORawJson {
+   const char *json;
+   size_t length;
+
+   explicit SocketIORawJson(const char *json, size_t length = 0) : json(json), length(json && length == 0 ? strlen(json) : length) {}
+};
+
+class SocketIOStats;
+
+// Binary attachments per packet
+#ifndef SIO_MAX_ATTACHMENTS
+#define SIO_MAX_ATTACHMENTS 4
+#endif
+
+/**
+ * Bytes sent as a native binary attachment: emit("frame", SocketIOBinary(jpg,
+ * size)) sends ["frame",{"_placeholder":true,"num":0}] followed by a binary
+ * WebSocket frame, without base64.
+ */
+struct SocketIOBinary {
+   const uint8_t *data;
+   size_t length;
+
+   SocketIOBinary(void) : data(NULL), length(0) {}
+   SocketIOBinary(const void *data, size_t length) : data((const uint8_t *)data), length(length) {}
+};
+
+/**
+ * Writes the JSON array of an event (["event",arg1,arg2,...]) or of an ack
+ * ([arg1,arg2,...]) into a buffer.
+ * Without a buffer nothing is written and only the length is computed, so the
+ * same code measures a frame and then serializes it where it will be sent.
+ */
+class SocketIOFrameWriter {
+ public:
+   SocketIOFrameWriter(char *buffer = NULL, size_t capacity = 0);
+
+   template <typename... Args>
+   void event(const char *name, const Args &...args) {
+      raw('[');
+      value(name);
+      arguments(args...);
+      raw(']');
+   }
+
+   // Ack arguments: [arg1,arg2,...]
+   template <typename... Args>
+   void array(const Args &...args) {
+      raw('[');
+      elements(args...);
+      raw(']');
+   }
+
+   void raw(char c);
+   void raw(const char *data, size_t length);
+
+   void string(const char *str, size_t length);
+
+   void value(const char *str) { str ? string(str, strlen(str)) : raw("null", 4); }
+   void value(char *str) { value((const char *)str); }
+   void value(const String &str) { value(str.c_str()); }
+   void value(bool b) { b ? raw("true", 4) : raw("false", 5); }
+   void value(const SocketIORawJson &json) { json.json ? raw(json.json, json.length) : raw("null", 4); }
+   void value(const SocketIOBinary &binary);
+   void value(const SocketIOStats &stats);
+
+   template <typename T>
+   typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type value(T n) {
+      n < 0 ? integer((unsigned long long)(-(n + 1)) + 1, true) : integer((unsigned long long)n, false);
+   }
+
+   template <typename T>
+   typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value>::type value(T n) {
+      integer((unsigned long long)n, false);
+   }
+
+   template <typename T>
+   typename std::enable_if<std::is_floating_point<T>::value>::type value(T n) {
+      // Let ArduinoJson format it, a number takes no room in the pool
+      StaticJsonDocument<8> doc;
+      doc.set(n);
+      json(doc);
+   }
+
+   // ArduinoJson documents, objects, arrays and variants
+   template <typename T>
+   typename std::enable_if<!std::is_arithmetic<T>::value>::type value(const T &variant) {
+      json(variant);
+   }
+
+   size_t length(void) const { return _length; }
+   bool overflowed(void) const { return _overflowed; }
+
+   // Attachments met while writing, in placeholder order
+   uint8_t attachments(void) const { return _attachmentCount; }
+   const SocketIOBinary &attachment(uint8_t num) const { return _attachments[num]; }
+   bool tooManyAttachments(void) const { return _tooManyAttachments; }
+
+ protected:
+   char *_buffer;
+   size_t _capacity;
+   size_t _length = 0;
+   bool _overflowed = false;
+   SocketIOBinary _attachments[SIO_MAX_ATTACHMENTS];
+   uint8_t _attachmentCount = 0;
+   bool _tooManyAttachments = false;
+
+   void elements(void) {}
+
+   template <typename T, typename... Args>
+   void elements(const T &arg, const Args &...args) {
+      value(arg);
+      arguments(args...);
+   }
+
+   void arguments(void) {}
+
+   template <typename T, typename... Args>
+   void arguments(const T &arg, const Args &...args) {
+      raw(',');
+      value(arg);
+      arguments(args...);
+   }
+
+   template <typename T>
+   void json(const T &source) {
+      size_t length = measureJson(source);
+      // serializeJson terminates the string: it needs one more byte
+      if (_buffer && _length + length < _capacity) {
+         serializeJson(source, _buffer + _length, _capacity - _length);
+      } else if (_buffer) {
+         _overflowed = true;
+      }
+      _length += length;
+   }
+
+   void integer(unsigned long long n, bool negative);
+};
+
+#endif /* SOCKETIOFRAMEWRITER_H_ */
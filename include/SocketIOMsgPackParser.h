@@ -0,0 +1,68 @@
+/**
+ * SocketIOMsgPackParser.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOMSGPACKPARSER_H_
+#define SOCKETIOMSGPACKPARSER_H_
+
+#include "SocketIOEventParser.h"
+#include "SocketIOFrameWriter.h"
+#include "SocketIOMsgPackWriter.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+   sIOmsgpack_NIL,
+   sIOmsgpack_BOOL,
+   sIOmsgpack_UINT,
+   sIOmsgpack_INT,
+   sIOmsgpack_FLOAT,
+   sIOmsgpack_DOUBLE,
+   sIOmsgpack_STR,
+   sIOmsgpack_BIN,
+   sIOmsgpack_ARRAY,
+   sIOmsgpack_MAP,
+   sIOmsgpack_EXT,
+} socketIOmsgpackType_t;
+
+/**
+ * A MessagePack value read by SocketIOMsgPackParser::read
+ */
+typedef struct {
+   socketIOmsgpackType_t type;
+   uint64_t value;      ///< Bool, uint, int (two's complement), float bits, length of a str / bin / ext, elements of an array / map
+   const uint8_t *data; ///< Bytes of a str / bin / ext, first element of an array / map
+} SocketIOMsgPackValue;
+
+/**
+ * Result of parsing a packet encoded by socket.io-msgpack-parser. Pointers
+ * borrow the frame handed to SocketIOMsgPackParser::parsePacket.
+ */
+typedef struct {
+   uint8_t type;           ///< socketIOmessageType_t: '0' (CONNECT) to '6' (BINARY_ACK)
+   const char *nsp;        ///< Namespace (not terminated), "/" if the packet has none
+   size_t nspLength;       ///< Length of nsp
+   int32_t ackId;          ///< Ack id, -1 if none
+   const uint8_t *data;    ///< Encoded "data" member, NULL if none
+   const uint8_t *dataEnd; ///< End of data
+} SocketIOMsgPackPacket;
+
+/**
+ * Reads MessagePack without copying nor allocating, the counterpart of
+ * SocketIOMsgPackWriter. Values can be translated to the JSON text listeners
+ * get in the JSON encoding.
+ */
+class SocketIOMsgPackParser {
+ public:
+   static socketIOparseError_t parsePacket(const uint8_t *payload, size_t length, SocketIOMsgPackPacket &packet);
+
+   static const uint8_t *read(const uint8_t *p, const uint8_t *end, SocketIOMsgPackValue &value);
+   static const uint8_t *skip(const uint8_t *p, const uint8_t *end, uint8_t depth = 0);
+   static const uint8_t *readString(const uint8_t *p, const uint8_t *end, const char **str, size_t *length);
+   static const uint8_t *toJson(const uint8_t *p, const uint8_t *end, SocketIOFrameWriter &writer, uint8_t depth = 0);
+};
+
+#endif /* SOCKETIOMSGPACKPARSER_H_ */
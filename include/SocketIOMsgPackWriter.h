@@ -0,0 +1,130 @@
+/**
+ * SocketIOMsgPackWriter.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOMSGPACKWRITER_H_
+#define SOCKETIOMSGPACKWRITER_H_
+
+#include "SocketIOFrameWriter.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+// Nesting accepted in the JSON of a SocketIORawJson argument
+#ifndef SIO_MSGPACK_MAX_DEPTH
+#define SIO_MSGPACK_MAX_DEPTH 16
+#endif
+
+/**
+ * Writes a Socket.IO packet the way socket.io-msgpack-parser encodes it: a
+ * MessagePack map {type, nsp, data, id} whose data is the array of the event
+ * (["event",arg1,...]) or of the ack ([arg1,...]). SocketIOBinary arguments
+ * are inlined as bin values, there are no attachments.
+ * Without a buffer nothing is written and only the length is computed, like
+ * SocketIOFrameWriter.
+ */
+class SocketIOMsgPackWriter {
+ public:
+   SocketIOMsgPackWriter(uint8_t *buffer = NULL, size_t capacity = 0);
+
+   /**
+    * @brief Write a whole packet
+    *
+    * @param type uint8_t packet type, 0 (CONNECT) to 6 (BINARY_ACK)
+    * @param nsp const char * not terminated
+    * @param nspLength size_t
+    * @param ackId int32_t -1 for none
+    * @param event const char * NULL for an ack
+    * @param args const Args &...
+    */
+   template <typename... Args>
+   void packet(uint8_t type, const char *nsp, size_t nspLength, int32_t ackId, const char *event, const Args &...args) {
+      mapHeader(ackId >= 0 ? 4 : 3);
+      string("type", 4);
+      integer(type, false);
+      string("nsp", 3);
+      string(nsp, nspLength);
+      string("data", 4);
+      arrayHeader(sizeof...(args) + (event ? 1 : 0));
+      if (event) {
+         value(event);
+      }
+      elements(args...);
+      if (ackId >= 0) {
+         string("id", 2);
+         integer(ackId, false);
+      }
+   }
+
+   void raw(uint8_t b);
+   void raw(const void *data, size_t length);
+
+   void nil(void) { raw(0xC0); }
+   void mapHeader(size_t count);
+   void arrayHeader(size_t count);
+   void string(const char *str, size_t length);
+   void binary(const uint8_t *data, size_t length);
+   const char *json(const char *p, const char *end, uint8_t depth = 0);
+
+   void value(const char *str) { str ? string(str, strlen(str)) : nil(); }
+   void value(char *str) { value((const char *)str); }
+   void value(const String &str) { string(str.c_str(), str.length()); }
+   void value(bool b) { raw(b ? 0xC3 : 0xC2); }
+   void value(const SocketIORawJson &json);
+   void value(const SocketIOBinary &binary) { binary.data ? this->binary(binary.data, binary.length) : nil(); }
+   void value(const SocketIOStats &stats);
+   void value(float n);
+   void value(double n);
+
+   template <typename T>
+   typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type value(T n) {
+      n < 0 ? integer((unsigned long long)(-(n + 1)) + 1, true) : integer((unsigned long long)n, false);
+   }
+
+   template <typename T>
+   typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value>::type value(T n) {
+      integer((unsigned long long)n, false);
+   }
+
+   // ArduinoJson documents, objects, arrays and variants
+   template <typename T>
+   typename std::enable_if<!std::is_arithmetic<T>::value>::type value(const T &variant) {
+      size_t length = measureMsgPack(variant);
+      if (_buffer && _length + length <= _capacity) {
+         serializeMsgPack(variant, _buffer + _length, _capacity - _length);
+      } else if (_buffer) {
+         _overflowed = true;
+      }
+      _length += length;
+   }
+
+   size_t length(void) const { return _length; }
+   bool overflowed(void) const { return _overflowed; }
+
+   void integer(unsigned long long n, bool negative);
+
+ protected:
+   uint8_t *_buffer;
+   size_t _capacity;
+   size_t _length = 0;
+   bool _overflowed = false;
+
+   void elements(void) {}
+
+   template <typename T, typename... Args>
+   void elements(const T &arg, const Args &...args) {
+      value(arg);
+      elements(args...);
+   }
+
+   void header(uint8_t fix, size_t fixMax, uint8_t code8, uint8_t code16, size_t count);
+   void bigEndian(uint64_t n, uint8_t bytes);
+};
+
+#endif /* SOCKETIOMSGPACKWRITER_H_ */
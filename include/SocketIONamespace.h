@@ -0,0 +1,153 @@
+/**
+ * SocketIONamespace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIONAMESPACE_H_
+#define SOCKETIONAMESPACE_H_
+
+#include "SocketIOAckPool.h"
+#include "SocketIOEventParser.h"
+#include "SocketIOEventRouter.h"
+#include "SocketIOEventTable.h"
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Namespaces of a client, its main namespace included
+#ifndef SIO_MAX_NAMESPACES
+#define SIO_MAX_NAMESPACES 4
+#endif
+
+// Default capacity of the document a typed listener's argument is read into
+#ifndef SIO_JSON_DOCUMENT_SIZE
+#define SIO_JSON_DOCUMENT_SIZE 256
+#endif
+
+// Room of the private session id and of the offset kept for connection state
+// recovery, terminator included: longer ones are not recovered
+#ifndef SIO_SESSION_ID_SIZE
+#define SIO_SESSION_ID_SIZE 32
+#endif
+
+class ArduinoSocketIOClient;
+
+/**
+ * Namespace multiplexed over the connection of a client: its own listeners,
+ * pending acks and connect state. Handles are owned by the client
+ * (ArduinoSocketIOClient::of) and stay valid as long as it lives; the client
+ * routes every received packet to its namespace.
+ */
+class SocketIONamespace {
+ public:
+   SocketIONamespace(void);
+   virtual ~SocketIONamespace(void);
+
+   void on(const char *event, SocketIOEventHandler handler);
+   void on(const SocketIOEvent &event, SocketIOEventHandler handler);
+   void remove(const char *event);
+   void remove(const SocketIOEvent &event);
+   void removeAll(void);
+   bool onStream(const char *event, SocketIOStreamHandler handler);
+
+   // Events without exact listener, see SocketIOEventRouter
+   bool onRoute(const char *pattern, SocketIORouteHandler handler);
+   bool removeRoute(const char *pattern);
+   bool onAny(SocketIORouteHandler handler) { return onRoute("*", handler); }
+   size_t getRouteMemory(void) const { return _routes.memoryUsage(); }
+
+   /**
+    * Typed listener: the first argument is deserialized once, keeping only
+    * the fields of filter, into a document of Capacity bytes on the stack,
+    * and handed over as T: JsonVariantConst, or any type ArduinoJson converts
+    * to (convertFromJson). Strings of the value point into the receive buffer
+    * and are only valid during the call. The filter is not copied, it must
+    * outlive the client. Arguments that can not be read are dropped and
+    * counted as parse failures.
+    */
+   template <typename T, size_t Capacity = SIO_JSON_DOCUMENT_SIZE>
+   void on(const char *event, const JsonDocument &filter, std::function<void(const T &value)> handler) {
+      on<T, Capacity>(event, &filter, handler);
+   }
+
+   template <typename T, size_t Capacity = SIO_JSON_DOCUMENT_SIZE>
+   void on(const char *event, std::function<void(const T &value)> handler) {
+      on<T, Capacity>(event, (const JsonDocument *)NULL, handler);
+   }
+
+   /**
+    * Called with the data of the server's CONNECT ({"sid":...}) when the
+    * namespace is joined, and with the reason (NULL when the connection was
+    * lost) when it is left or refused
+    */
+   void onConnect(SocketIOEventHandler handler) { _onConnect = handler; }
+   void onDisconnect(SocketIOEventHandler handler) { _onDisconnect = handler; }
+
+   bool connect(void);
+   bool disconnect(void);
+   bool isConnected(void) const { return _connected; }
+   const char *name(void) const { return _name; }
+
+   /**
+    * Connection state recovery (Socket.IO v4.6+, connectionStateRecovery on
+    * the server): the private session id of the CONNECT answer and the offset
+    * of the last event received are presented when the namespace is joined
+    * again after a lost connection, so the server restores the session and
+    * replays only the events missed. isRecovered() tells whether the last
+    * CONNECT did. The session is forgotten when the namespace is left.
+    */
+   bool isRecovered(void) const { return _recovered; }
+   const char *getSessionId(void) const { return _pid; }
+   const char *getOffset(void) const { return _offset; }
+   size_t getPendingAcks(void) const { return _acks.pending(); }
+
+   // Same as the client's, in this namespace (defined in ArduinoSocketIOClient.h)
+   template <typename... Args>
+   socketIOemitResult_t emit(const char *event, const Args &...args);
+   template <typename... Args>
+   socketIOemitResult_t emitWithAck(const char *event, uint32_t timeout, SocketIOAckHandler callback, const Args &...args);
+   template <typename... Args>
+   socketIOemitResult_t emitVolatile(const char *event, const Args &...args);
+
+ protected:
+   friend class ArduinoSocketIOClient;
+   friend class SocketIOTask;
+
+   ArduinoSocketIOClient *_client = NULL;
+   const char *_name = NULL;
+   size_t _nameLength = 0;
+   size_t _prefixLength = 0; ///< "/nsp," written in front of its packets, 0 for "/"
+   bool _joined = false;     ///< CONNECT is sent on every connection
+   bool _connected = false;  ///< The server accepted the CONNECT
+   bool _recovered = false;  ///< That CONNECT restored the previous session
+   char _pid[SIO_SESSION_ID_SIZE] = "";    ///< Private session id, "" if the server does not recover
+   char _offset[SIO_SESSION_ID_SIZE] = ""; ///< Offset of the last event received, "" if none
+   SocketIOEventTable _events;
+   SocketIOEventRouter _routes;
+   SocketIOAckPool _acks;
+   SocketIOEventHandler _onConnect;
+   SocketIOEventHandler _onDisconnect;
+
+   void begin(ArduinoSocketIOClient *client, const char *name);
+   bool matches(const char *name, size_t length) const;
+   bool sendConnect(void);
+   void connected(const char *data, size_t length);
+   void keepOffset(const SocketIOEventFrame &frame);
+   void disconnected(const char *reason, size_t length);
+   bool deserialize(JsonDocument &doc, const char *payload, size_t length, const JsonDocument *filter);
+
+   template <typename T, size_t Capacity>
+   void on(const char *event, const JsonDocument *filter, std::function<void(const T &value)> handler) {
+      on(event, [this, filter, handler](const char *payload, size_t length) {
+         StaticJsonDocument<Capacity> doc;
+         if (deserialize(doc, payload, length, filter)) {
+            const T value = doc.template as<T>();
+            handler(value);
+         }
+      });
+   }
+};
+
+#endif /* SOCKETIONAMESPACE_H_ */
@@ -0,0 +1,105 @@
+/**
+ * SocketIOOfflineLog.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOOFFLINELOG_H_
+#define SOCKETIOOFFLINELOG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(ESP8266) || defined(ESP32)
+#include <FS.h>
+#define SIO_OFFLINE_FS
+typedef fs::File SocketIOFile;
+#elif !defined(ARDUINO)
+#include <stdio.h>
+#define SIO_OFFLINE_STDIO
+typedef FILE *SocketIOFile;
+#endif
+
+// Default size cap of the log file, header included
+#ifndef SIO_OFFLINE_LOG_SIZE
+#define SIO_OFFLINE_LOG_SIZE 16384
+#endif
+
+#define SIO_OFFLINE_PATH_SIZE 32
+
+/**
+ * Append-only log of packets on a file system (LittleFS / SPIFFS on the
+ * device, a plain file on a host build), kept across reboots. The file starts
+ * with a header holding the read offset; records are [uint32_t length][data].
+ * Records are consumed from the read offset; the file is rewritten only when
+ * it is empty (truncated) or when the size cap forces a compaction.
+ */
+class SocketIOOfflineLog {
+ public:
+   SocketIOOfflineLog(void);
+   virtual ~SocketIOOfflineLog(void);
+
+#if defined(SIO_OFFLINE_FS)
+   bool begin(fs::FS &fs, const char *path, size_t maxBytes = SIO_OFFLINE_LOG_SIZE, bool dropOldest = true);
+#elif defined(SIO_OFFLINE_STDIO)
+   bool begin(const char *path, size_t maxBytes = SIO_OFFLINE_LOG_SIZE, bool dropOldest = true);
+#endif
+   void end(void);
+
+   bool beginRecord(size_t length);
+   bool write(const void *data, size_t length);
+   bool endRecord(void);
+
+   size_t peekRecord(void);
+   bool read(void *data, size_t length);
+   void consume(void);
+   void flush(void);
+   void clear(void);
+
+   bool isReady(void) const { return _ready; }
+   bool isEmpty(void) const { return _count == 0; }
+   size_t count(void) const { return _count; }
+   size_t bytes(void) const { return _end - _read; }
+   size_t maxBytes(void) const { return _maxBytes; }
+   size_t dropped(void) const { return _dropped; }
+
+ protected:
+   typedef struct {
+      uint32_t magic;
+      uint32_t read; ///< Offset of the oldest record
+   } Header;
+
+#if defined(SIO_OFFLINE_FS)
+   fs::FS *_fs = NULL;
+#endif
+#if defined(SIO_OFFLINE_FS) || defined(SIO_OFFLINE_STDIO)
+   SocketIOFile _file;
+#endif
+   char _path[SIO_OFFLINE_PATH_SIZE];
+   bool _ready = false;
+   bool _dropOldest = true;
+   size_t _maxBytes = 0;
+
+   size_t _read = 0;        ///< Offset of the oldest record
+   size_t _end = 0;         ///< Offset after the newest complete record
+   size_t _count = 0;       ///< Complete records between _read and _end
+   size_t _dropped = 0;     ///< Records evicted or refused because of the cap
+   bool _readDirty = false; ///< _read not persisted yet
+
+   size_t _writeAt = 0;     ///< Write position of the record being appended
+   size_t _writeEnd = 0;    ///< End of the record being appended
+   size_t _readAt = 0;      ///< Read position inside the record being read
+   size_t _recordLength = 0;
+
+   bool open(const char *mode);
+   void close(void);
+   size_t readAt(size_t offset, void *data, size_t length);
+   size_t writeAt(size_t offset, const void *data, size_t length);
+   size_t fileSize(void);
+   bool recover(void);
+   bool reset(void);
+   bool compact(void);
+};
+
+#endif /* SOCKETIOOFFLINELOG_H_ */
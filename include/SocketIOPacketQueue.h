@@ -0,0 +1,81 @@
+/**
+ * SocketIOPacketQueue.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOPACKETQUEUE_H_
+#define SOCKETIOPACKETQUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * FIFO of variable length packets stored back to back in a fixed byte region.
+ * Every packet is contiguous: when it does not fit before the end of the region
+ * the tail wraps to the beginning. A packet can be discarded out of order: the
+ * last one gives its bytes back at once, any other one stops counting and is
+ * skipped once the head reaches it.
+ */
+class SocketIOPacketQueue {
+ public:
+   SocketIOPacketQueue(void);
+   virtual ~SocketIOPacketQueue(void);
+
+   void begin(uint8_t *buffer, size_t capacity, size_t maxCount = 0);
+
+   bool fits(size_t length) const;
+   uint8_t *reserve(size_t length);
+   uint8_t *reserveScratch(size_t length);
+   void commit(size_t length);
+   size_t room(const uint8_t *packet) const;
+   bool resize(uint8_t *packet, size_t length);
+   void discard(uint8_t *packet);
+
+   uint8_t *front(size_t *length);
+   void pop(void);
+   void clear(void);
+
+   bool isReady(void) const { return _buffer != NULL; }
+   bool isEmpty(void) const { return _count == 0; }
+   size_t count(void) const { return _count; }
+   size_t used(void) const { return _used; }
+   size_t capacity(void) const { return _capacity; }
+   size_t maxCount(void) const { return _maxCount; }
+   size_t highWaterCount(void) const { return _highWaterCount; }
+   size_t highWaterUsed(void) const { return _highWaterUsed; }
+   void resetHighWater(void);
+
+ protected:
+   typedef struct {
+      uint32_t size;   ///< Bytes taken by the record, header and padding included
+      uint32_t length; ///< Packet length, SIO_QUEUE_WRAP for a wrap marker, SIO_QUEUE_DISCARDED
+   } Record;
+
+   uint8_t *_buffer = NULL;
+   size_t _capacity = 0;
+   size_t _head = 0;
+   size_t _tail = 0;
+   size_t _used = 0;
+   size_t _count = 0; ///< Packets, discarded ones not included
+   size_t _maxCount = 0; ///< 0 for no limit but the region
+   size_t _highWaterCount = 0;
+   size_t _highWaterUsed = 0;
+
+   size_t _reservedAt = 0;
+   size_t _reservedSize = 0;
+   size_t _reservedLength = 0;
+
+   // Last commit, undone when its packet is discarded before another one
+   bool _lastValid = false;
+   size_t _lastAt = 0;
+   size_t _lastTail = 0;
+   size_t _lastPadding = 0;
+
+   Record *recordAt(size_t offset) const { return (Record *)(_buffer + offset); }
+   void skipWrap(void);
+   void skipDiscarded(void);
+};
+
+#endif /* SOCKETIOPACKETQUEUE_H_ */
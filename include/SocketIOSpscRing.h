@@ -0,0 +1,70 @@
+/**
+ * SocketIOSpscRing.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOSPSCRING_H_
+#define SOCKETIOSPSCRING_H_
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Keeps the counters of the producer and of the consumer on their own cache
+// line
+#ifndef SIO_CACHE_LINE_SIZE
+#define SIO_CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * Lock-free FIFO of variable length records between exactly one producer
+ * thread and one consumer thread, laid out like SocketIOPacketQueue: every
+ * record is contiguous, the tail wraps to the beginning when a record does
+ * not fit before the end. The producer only writes the tail and the consumer
+ * only writes the head; a record is published by the release store of the
+ * tail and given back by the release store of the head.
+ */
+class SocketIOSpscRing {
+ public:
+   SocketIOSpscRing(void);
+   virtual ~SocketIOSpscRing(void);
+
+   void begin(uint8_t *buffer, size_t capacity);
+
+   // Producer thread
+   uint8_t *reserve(size_t length);
+   void commit(size_t length);
+
+   // Consumer thread
+   uint8_t *front(size_t *length);
+   void pop(void);
+
+   // Any thread, a snapshot
+   bool isEmpty(void) const { return used() == 0; }
+   size_t used(void) const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+   size_t capacity(void) const { return _capacity; }
+
+ protected:
+   typedef struct {
+      uint32_t size;   ///< Bytes taken by the record, header and padding included
+      uint32_t length; ///< Record length, SIO_RING_WRAP for a wrap marker
+   } Record;
+
+   uint8_t *_buffer = NULL;
+   size_t _capacity = 0; ///< Power of two
+
+   // Free running byte counters, the offset is counter & (_capacity - 1)
+   alignas(SIO_CACHE_LINE_SIZE) std::atomic<size_t> _head;
+   alignas(SIO_CACHE_LINE_SIZE) std::atomic<size_t> _tail;
+
+   // Reservation of the producer
+   size_t _reservedPadding = 0;
+   size_t _reservedSize = 0;
+   size_t _reservedLength = 0;
+
+   Record *recordAt(size_t counter) const { return (Record *)(_buffer + (counter & (_capacity - 1))); }
+};
+
+#endif /* SOCKETIOSPSCRING_H_ */
@@ -0,0 +1,123 @@
+/**
+ * SocketIOStats.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOSTATS_H_
+#define SOCKETIOSTATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Buckets of a histogram: bucket 0 counts 0 µs, bucket i [2^(i-1), 2^i) µs,
+// the last one everything longer (20: up to 262 ms)
+#ifndef SIO_STATS_BUCKETS
+#define SIO_STATS_BUCKETS 20
+#endif
+
+// Engine.IO and Socket.IO packet types '0' to '6'
+#define SIO_STATS_TYPES 7
+
+class SocketIOFrameWriter;
+
+/**
+ * Durations counted in fixed power of two buckets of microseconds: recording
+ * is a few increments, no allocation
+ */
+class SocketIOHistogram {
+ public:
+   SocketIOHistogram(void) { reset(); }
+
+   void record(uint32_t us) {
+      uint8_t i = us ? 32 - __builtin_clz(us) : 0;
+      _buckets[i < SIO_STATS_BUCKETS ? i : SIO_STATS_BUCKETS - 1]++;
+      _count++;
+      _sum += us;
+      if (us > _max) {
+         _max = us;
+      }
+   }
+
+   void reset(void);
+   uint32_t percentile(uint8_t percent) const;
+
+   uint32_t count(void) const { return _count; }
+   uint64_t sum(void) const { return _sum; }
+   uint32_t max(void) const { return _max; }
+   uint32_t bucket(uint8_t i) const { return i < SIO_STATS_BUCKETS ? _buckets[i] : 0; }
+   static uint32_t upperBound(uint8_t i) { return i + 1 < SIO_STATS_BUCKETS ? (uint32_t)1 << i : UINT32_MAX; }
+
+ protected:
+   uint32_t _buckets[SIO_STATS_BUCKETS];
+   uint32_t _count;
+   uint64_t _sum;
+   uint32_t _max;
+};
+
+typedef struct {
+   uint32_t frames;
+   uint32_t bytes;
+} SocketIOTraffic;
+
+/**
+ * Counters of a client, updated as frames come and go: plain increments, no
+ * allocation and no lock (the client runs on one task). Read them with
+ * ArduinoSocketIOClient::getStats(), serialize them with toJson() or pass them
+ * to emit() as an argument.
+ */
+class SocketIOStats {
+ public:
+   SocketIOStats(void) { reset(); }
+
+   // Engine.IO frames by type ('0' open ... '6' noop), bytes of their text
+   SocketIOTraffic eioIn[SIO_STATS_TYPES];
+   SocketIOTraffic eioOut[SIO_STATS_TYPES];
+   // Socket.IO packets of the message frames by type ('0' connect ... '6'
+   // binary ack), bytes after the type
+   SocketIOTraffic sioIn[SIO_STATS_TYPES];
+   SocketIOTraffic sioOut[SIO_STATS_TYPES];
+   // Binary frames: attachments
+   SocketIOTraffic binaryIn;
+   SocketIOTraffic binaryOut;
+
+   uint32_t droppedPackets;  ///< Not queued or evicted (queue full, too large), acks not stored offline
+   uint32_t lostPackets;     ///< Offline log full, offline records unreadable
+   uint32_t unmatchedEvents; ///< Events without listener
+   uint32_t unmatchedAcks;   ///< Acks not pending (late or unknown)
+   uint32_t parseFailures;   ///< Malformed events, acks and binary packets
+   uint32_t reconnects;      ///< Connections after the first one
+   uint32_t disconnects;
+   uint32_t pingTimeouts;      ///< Connections closed for a missing heartbeat
+   uint32_t volatileDrops;     ///< Volatile emits not written: connection not writable or broken
+   uint32_t queueDepth;        ///< Packets of the normal lane queued when getStats() was called
+   uint32_t queueHighWater;    ///< Most packets queued in the normal lane since the last reset
+   uint32_t priorityDepth;     ///< Same for the high priority lane
+   uint32_t priorityHighWater; ///< Same for the high priority lane
+
+   SocketIOHistogram handlerTime;   ///< Listeners and ack callbacks
+   SocketIOHistogram parseTime;     ///< Parsing of events and acks
+   SocketIOHistogram queueDelay;    ///< emit() to the packet written by loop(), normal lane
+   SocketIOHistogram priorityDelay; ///< Same for the high priority lane
+   SocketIOHistogram connectTime;   ///< Connection attempt to the main namespace joined
+
+   static void count(SocketIOTraffic *traffic, uint8_t type, size_t length) {
+      uint8_t i = type - '0';
+      if (i < SIO_STATS_TYPES) {
+         traffic[i].frames++;
+         traffic[i].bytes += length;
+      }
+   }
+
+   static void count(SocketIOTraffic &traffic, size_t length) {
+      traffic.frames++;
+      traffic.bytes += length;
+   }
+
+   void reset(void);
+   void write(SocketIOFrameWriter &writer) const;
+   size_t toJson(char *buffer, size_t capacity) const;
+};
+
+#endif /* SOCKETIOSTATS_H_ */
@@ -0,0 +1,173 @@
+/**
+ * SocketIOTask.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef SOCKETIOTASK_H_
+#define SOCKETIOTASK_H_
+
+#include "ArduinoSocketIOClient.h"
+#include "SocketIOSpscRing.h"
+#include <atomic>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#define SIO_TASK_FREERTOS
+#elif !defined(ARDUINO)
+#include <thread>
+#define SIO_TASK_STD_THREAD
+#endif
+
+#if defined(SIO_TASK_FREERTOS) || defined(SIO_TASK_STD_THREAD)
+#define SIO_HAS_TASK
+
+// Default sizes of the rings: packets emitted by the application, events
+// received for it
+#ifndef SIO_TASK_OUTBOUND_SIZE
+#define SIO_TASK_OUTBOUND_SIZE 4096
+#endif
+#ifndef SIO_TASK_INBOUND_SIZE
+#define SIO_TASK_INBOUND_SIZE 4096
+#endif
+
+// Pause of the network task when it has nothing to do, in microseconds (a
+// tick at least on FreeRTOS)
+#ifndef SIO_TASK_IDLE_DELAY
+#define SIO_TASK_IDLE_DELAY 50
+#endif
+
+// FreeRTOS task of the network loop
+#ifndef SIO_TASK_STACK_SIZE
+#define SIO_TASK_STACK_SIZE 6144
+#endif
+#ifndef SIO_TASK_PRIORITY
+#define SIO_TASK_PRIORITY 2
+#endif
+#ifndef SIO_TASK_CORE
+#define SIO_TASK_CORE 0
+#endif
+
+/**
+ * Runs the loop() of a client on a task of its own. The application talks to
+ * it through two lock-free single producer / single consumer rings: emit()
+ * serializes a packet into the outbound ring, the network task writes it;
+ * events of the main namespace without listener of the client are copied by
+ * the network task into the inbound ring, dispatch() hands them to the
+ * listeners of the task on the application's task.
+ * emit() and dispatch() must be called from one application task. Once
+ * start() returned, the client belongs to the network task: listeners
+ * registered on the client itself run there.
+ */
+class SocketIOTask {
+ public:
+   SocketIOTask(ArduinoSocketIOClient &client);
+   virtual ~SocketIOTask(void);
+
+   bool configure(size_t outboundBytes = SIO_TASK_OUTBOUND_SIZE, size_t inboundBytes = SIO_TASK_INBOUND_SIZE);
+   void on(const char *event, SocketIOEventHandler handler);
+   void onAny(SocketIORouteHandler handler) { _any = handler; }
+
+   bool start(uint32_t timeBudget = 0, size_t byteBudget = 0);
+   void stop(void);
+   bool isRunning(void) const { return _running.load(std::memory_order_acquire); }
+   bool isConnected(void) const { return _connected.load(std::memory_order_acquire); }
+
+   size_t dispatch(size_t maxEvents = 0);
+
+   size_t getOutboundBytes(void) const { return _outbound.used(); }
+   size_t getInboundBytes(void) const { return _inbound.used(); }
+   size_t getOutboundDrops(void) const { return _outboundDrops.load(std::memory_order_relaxed); }
+   size_t getInboundDrops(void) const { return _inboundDrops.load(std::memory_order_relaxed); }
+
+   /**
+    * Send an event from the application's task, like
+    * ArduinoSocketIOClient::emit in the main namespace: serialized straight
+    * into the outbound ring, written by the network task. sIOemit_REJECTED
+    * when the ring is full.
+    */
+   template <typename... Args>
+   socketIOemitResult_t emit(const char *event, const Args &...args) {
+      if (!isConnected()) {
+         return sIOemit_DISCONNECTED;
+      }
+      const SocketIONamespace &nsp = _client._namespaces[0];
+      if (_client._encoding == sIOencoding_MSGPACK) {
+         SocketIOMsgPackWriter measure;
+         measure.packet(sIOtype_EVENT - '0', nsp._name, nsp._nameLength, -1, event, args...);
+         size_t size = SIO_MAX_HEADER_SIZE + measure.length() + 1;
+         uint8_t *packet = _outbound.reserve(size);
+         if (!packet) {
+            return reject();
+         }
+         SocketIOMsgPackWriter writer(packet + SIO_MAX_HEADER_SIZE, measure.length());
+         writer.packet(sIOtype_EVENT - '0', nsp._name, nsp._nameLength, -1, event, args...);
+         ArduinoSocketIOClient::stampPacket(packet, sIOtype_EVENT, -1, measure.length());
+         _outbound.commit(size);
+         return sIOemit_QUEUED;
+      }
+
+      SocketIOFrameWriter measure;
+      measure.event(event, args...);
+      if (measure.tooManyAttachments()) {
+         return sIOemit_TOO_LARGE;
+      }
+      size_t messageLength;
+      size_t size = ArduinoSocketIOClient::packetSize(nsp, -1, measure, &messageLength);
+      uint8_t *packet = _outbound.reserve(size);
+      if (!packet) {
+         return reject();
+      }
+      socketIOmessageType_t type = measure.attachments() ? sIOtype_BINARY_EVENT : sIOtype_EVENT;
+      char *message = ArduinoSocketIOClient::writeHeader(packet, nsp, type, -1, measure, messageLength);
+      SocketIOFrameWriter writer(message, measure.length() + 1);
+      writer.event(event, args...);
+      message[measure.length()] = '\0';
+      ArduinoSocketIOClient::writeAttachments((uint8_t *)message + writer.length() + 1, writer);
+      _outbound.commit(size);
+      return sIOemit_QUEUED;
+   }
+
+ protected:
+   ArduinoSocketIOClient &_client;
+   SocketIOSpscRing _outbound; ///< Application to network task
+   SocketIOSpscRing _inbound;  ///< Network task to application: [event\0][payload\0]
+   uint8_t *_outboundBuffer = NULL;
+   uint8_t *_inboundBuffer = NULL;
+   size_t _outboundSize = SIO_TASK_OUTBOUND_SIZE;
+   size_t _inboundSize = SIO_TASK_INBOUND_SIZE;
+
+   SocketIOEventTable _events;
+   SocketIORouteHandler _any;
+
+   uint32_t _timeBudget = 0;
+   size_t _byteBudget = 0;
+   std::atomic<bool> _running;
+   std::atomic<bool> _connected;
+   std::atomic<size_t> _outboundDrops;
+   std::atomic<size_t> _inboundDrops;
+
+#if defined(SIO_TASK_STD_THREAD)
+   std::thread _thread;
+#else
+   TaskHandle_t _handle = NULL;
+   std::atomic<bool> _stopped;
+   static void entry(void *task);
+#endif
+
+   socketIOemitResult_t reject(void) {
+      _outboundDrops.fetch_add(1, std::memory_order_relaxed);
+      return sIOemit_REJECTED;
+   }
+
+   void run(void);
+   bool loop(void);
+   void receive(const char *event, const char *payload, size_t length);
+   void release(void);
+};
+
+#endif /* SIO_TASK_FREERTOS || SIO_TASK_STD_THREAD */
+
+#endif /* SOCKETIOTASK_H_ */
@@ -10,6 +10,17 @@ ArduinoSocketIOClient::ArduinoSocketIOClient() {}
 
 ArduinoSocketIOClient::~ArduinoSocketIOClient() {}
 
+// Engine.IO over a WebSocket from the first request, the OPEN packet included:
+// beginSocketIO() would poll first and keep the OPEN packet to itself
+static String websocketUrl(const String &url) {
+   if (url.indexOf("transport=") >= 0) {
+      return url;
+   }
+   String full = url;
+   full += url.indexOf("?") >= 0 ? "&transport=websocket" : "?transport=websocket";
+   return full;
+}
+
 /**
  * @brief Configure connect to server
  *
@@ -18,11 +29,12 @@ ArduinoSocketIOClient::~ArduinoSocketIOClient() {}
  * @param nsp const char *
  * @param url const char *
  * @param protocol const char *
+ * @param encoding socketIOencoding_t
  */
-void ArduinoSocketIOClient::begin(const char *host, uint16_t port, const char *nsp, const char *url, const char *protocol) {
+void ArduinoSocketIOClient::begin(const char *host, uint16_t port, const char *nsp, const char *url, const char *protocol, socketIOencoding_t encoding) {
    _nsp = nsp;
-   WebSocketsClient::beginSocketIO(host, port, url, protocol);
-   WebSocketsClient::enableHeartbeat(60 * 1000, 90 * 1000, 5);
+   WebSocketsClient::begin(host, port, websocketUrl(url).c_str(), protocol);
+   _encoding = encoding;
    initClient();
 }
 
@@ -34,11 +46,12 @@ void ArduinoSocketIOClient::begin(const char *host, uint16_t port, const char *n
  * @param nsp String
  * @param url String
  * @param protocol String
+ * @param encoding socketIOencoding_t
  */
-void ArduinoSocketIOClient::begin(String host, uint16_t port, String nsp, String url, String protocol) {
+void ArduinoSocketIOClient::begin(String host, uint16_t port, String nsp, String url, String protocol, socketIOencoding_t encoding) {
    _nsp = nsp.c_str();
-   WebSocketsClient::beginSocketIO(host, port, url, protocol);
-   WebSocketsClient::enableHeartbeat(60 * 1000, 90 * 1000, 5);
+   WebSocketsClient::begin(host.c_str(), port, websocketUrl(url).c_str(), protocol.c_str());
+   _encoding = encoding;
    initClient();
 }
 #if defined(HAS_SSL)
@@ -50,11 +63,12 @@ void ArduinoSocketIOClient::begin(String host, uint16_t port, String nsp, String
  * @param nsp const char *
  * @param url const char *
  * @param protocol const char *
+ * @param encoding socketIOencoding_t
  */
-void ArduinoSocketIOClient::beginSSL(const char *host, const char *nsp, uint16_t port, const char *url, const char *protocol) {
+void ArduinoSocketIOClient::beginSSL(const char *host, const char *nsp, uint16_t port, const char *url, const char *protocol, socketIOencoding_t encoding) {
    _nsp = nsp;
-   WebSocketsClient::beginSocketIOSSL(host, port, url, protocol);
-   WebSocketsClient::enableHeartbeat(60 * 1000, 90 * 1000, 5);
+   WebSocketsClient::beginSSL(host, port, websocketUrl(url).c_str(), SSL_FINGERPRINT_NULL, protocol);
+   _encoding = encoding;
    initClient();
 }
 
@@ -66,11 +80,12 @@ void ArduinoSocketIOClient::beginSSL(const char *host, const char *nsp, uint16_t
  * @param nsp String
  * @param url String
  * @param protocol String
+ * @param encoding socketIOencoding_t
  */
-void ArduinoSocketIOClient::beginSSL(String host, String nsp, uint16_t port, String url, String protocol) {
+void ArduinoSocketIOClient::beginSSL(String host, String nsp, uint16_t port, String url, String protocol, socketIOencoding_t encoding) {
    _nsp = nsp.c_str();
-   WebSocketsClient::beginSocketIOSSL(host, port, url, protocol);
-   WebSocketsClient::enableHeartbeat(60 * 1000, 90 * 1000, 5);
+   WebSocketsClient::beginSSL(host.c_str(), port, websocketUrl(url).c_str(), SSL_FINGERPRINT_NULL, protocol.c_str());
+   _encoding = encoding;
    initClient();
 }
 #if defined(SSL_BARESSL)
@@ -83,11 +98,12 @@ void ArduinoSocketIOClient::beginSSL(String host, String nsp, uint16_t port, Str
  * @param url const char *
  * @param CA_cert const char *
  * @param protocol const char *
+ * @param encoding socketIOencoding_t
  */
-void ArduinoSocketIOClient::beginSSLWithCA(const char *host, const char *nsp, uint16_t port, const char *url, const char *CA_cert, const char *protocol) {
+void ArduinoSocketIOClient::beginSSLWithCA(const char *host, const char *nsp, uint16_t port, const char *url, const char *CA_cert, const char *protocol, socketIOencoding_t encoding) {
    _nsp = nsp;
-   WebSocketsClient::beginSocketIOSSLWithCA(host, port, url, CA_cert, protocol);
-   WebSocketsClient::enableHeartbeat(60 * 1000, 90 * 1000, 5);
+   WebSocketsClient::beginSslWithCA(host, port, websocketUrl(url).c_str(), CA_cert, protocol);
+   _encoding = encoding;
    initClient();
 }
 
@@ -100,11 +116,12 @@ void ArduinoSocketIOClient::beginSSLWithCA(const char *host, const char *nsp, ui
  * @param url const char *
  * @param CA_cert BearSSL::X509List *
  * @param protocol const char *
+ * @param encoding socketIOencoding_t
  */
-void ArduinoSocketIOClient::beginSSLWithCA(const char *host, const char *nsp, uint16_t port, const char *url, BearSSL::X509List *CA_cert, const char *protocol) {
+void ArduinoSocketIOClient::beginSSLWithCA(const char *host, const char *nsp, uint16_t port, const char *url, BearSSL::X509List *CA_cert, const char *protocol, socketIOencoding_t encoding) {
    _nsp = nsp;
-   WebSocketsClient::beginSocketIOSSLWithCA(host, port, url, CA_cert, protocol);
-   WebSocketsClient::enableHeartbeat(60 * 1000, 90 * 1000, 5);
+   WebSocketsClient::beginSslWithCA(host, port, websocketUrl(url).c_str(), CA_cert, protocol);
+   _encoding = encoding;
    initClient();
 }
 
@@ -130,229 +147,1931 @@ void ArduinoSocketIOClient::setSSLClientCertKey(BearSSL::X509List *clientCert, B
 void ArduinoSocketIOClient::configureEIOping(bool disableHeartbeat) { _disableHeartbeat = disableHeartbeat; }
 
 /**
- * @brief Initiate client and bind to function param in function onEvent. You
- * can override it for your customizing
+ * @brief Set the size of the memory region allocated by begin(). Must be
+ * called before begin().
+ *
+ * @param arenaSize size_t
+ */
+void ArduinoSocketIOClient::configureMemory(size_t arenaSize) {
+   _arena.end();
+   _arenaSize = arenaSize;
+}
+
+/**
+ * @brief Use a buffer owned by the caller (e.g. a static array) instead of
+ * allocating one: the client never touches the heap. Must be called before
+ * begin(), the buffer must outlive the client.
+ *
+ * @param buffer uint8_t *
+ * @param capacity size_t
+ */
+void ArduinoSocketIOClient::configureMemory(uint8_t *buffer, size_t capacity) { _arena.begin(buffer, capacity); }
+
+/**
+ * @brief Allocate the arena (only if configureMemory did not supply a buffer
+ * and it was not allocated by a previous begin) and carve the namespace, the
+ * frame buffer, the binary buffer and the outbound queue from it
+ *
+ * @return bool false if the arena could not be allocated
+ */
+bool ArduinoSocketIOClient::initMemory(void) {
+   if (!_arena.isReady() && !_arena.begin(_arenaSize)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] can not allocate %u bytes arena\n", _arenaSize);
+      return false;
+   }
+
+   _arena.reset();
+
+   // Keep the namespace: begin(String ...) hands over a temporary
+   size_t nspSize = strlen(_nsp) + 1;
+   char *nsp = (char *)_arena.allocate(nspSize);
+   if (nsp) {
+      memmove(nsp, _nsp, nspSize);
+      _nsp = nsp;
+   }
+
+   // Small frames sent from a caller's buffer are assembled here
+   _frameBufferSize = SIO_FRAME_BUFFER_SIZE;
+   _frameBuffer = _arena.available() > _frameBufferSize ? _arena.allocate(_frameBufferSize) : NULL;
+
+   _binaryBufferSize = SIO_BINARY_BUFFER_SIZE;
+   _binaryBuffer = _binaryBufferSize && _arena.available() > _binaryBufferSize ? _arena.allocate(_binaryBufferSize) : NULL;
+   _binaryExpected = 0;
+   _binarySkip = 0;
+
+   // The high priority lane first, the normal one takes the rest
+   size_t size = _priorityBytes && _arena.available() > 2 * _priorityBytes ? _priorityBytes : 0;
+   _priorityPackets.begin(size ? _arena.allocate(size) : NULL, size);
+   _priorityBurst = 0;
+
+   size = _arena.available();
+   if (_queueBytes && _queueBytes < size) {
+      size = _queueBytes;
+   }
+   _packets.begin(_arena.allocate(size), size, _queuePackets);
+   for (uint8_t i = 0; i < _coalescedCount; i++) {
+      _coalesced[i].packet = NULL;
+   }
+   return true;
+}
+
+/**
+ * @brief Bound the outbound queue and choose what emit does when it is full.
+ * Must be called before begin().
+ *
+ * @param maxBytes size_t bytes of the arena given to the queue, 0 for the
+ * whole arena
+ * @param maxPackets size_t 0 for no limit but the bytes
+ * @param policy socketIOoverflowPolicy_t
+ */
+void ArduinoSocketIOClient::configureQueue(size_t maxBytes, size_t maxPackets, socketIOoverflowPolicy_t policy) {
+   _queueBytes = maxBytes;
+   _queuePackets = maxPackets;
+   _overflowPolicy = policy;
+}
+
+/**
+ * @brief Number of packets waiting to be sent, both lanes
+ *
+ * @return size_t
+ */
+size_t ArduinoSocketIOClient::getQueueDepth(void) const { return _packets.count() + _priorityPackets.count(); }
+
+/**
+ * @brief Number of packets waiting in one lane
+ *
+ * @param lane socketIOpriority_t
+ * @return size_t
+ */
+size_t ArduinoSocketIOClient::getQueueDepth(socketIOpriority_t lane) const { return lane == sIOpriority_HIGH ? _priorityPackets.count() : _packets.count(); }
+
+/**
+ * @brief Bytes of the queue taken by the packets waiting to be sent, both
+ * lanes
+ *
+ * @return size_t
+ */
+size_t ArduinoSocketIOClient::getQueueBytes(void) const { return _packets.used() + _priorityPackets.used(); }
+
+/**
+ * @brief Highest number of packets queued at once in the normal lane since
+ * begin() or the last resetQueueHighWaterMark()
+ *
+ * @return size_t
+ */
+size_t ArduinoSocketIOClient::getQueueHighWaterMark(void) const { return _packets.highWaterCount(); }
+
+/**
+ * @brief Highest number of bytes in use in the normal lane since begin() or
+ * the last resetQueueHighWaterMark()
+ *
+ * @return size_t
+ */
+size_t ArduinoSocketIOClient::getQueueHighWaterBytes(void) const { return _packets.highWaterUsed(); }
+
+void ArduinoSocketIOClient::resetQueueHighWaterMark(void) {
+   _packets.resetHighWater();
+   _priorityPackets.resetHighWater();
+}
+
+/**
+ * @brief Counters and histograms since the client was created or resetStats(),
+ * with the queue depth of now
+ *
+ * @return const SocketIOStats &
+ */
+const SocketIOStats &ArduinoSocketIOClient::getStats(void) {
+   _stats.queueDepth = _packets.count();
+   _stats.queueHighWater = _packets.highWaterCount();
+   _stats.priorityDepth = _priorityPackets.count();
+   _stats.priorityHighWater = _priorityPackets.highWaterCount();
+   return _stats;
+}
+
+/**
+ * @brief Zero the statistics and the queue high-water mark
+ *
+ */
+void ArduinoSocketIOClient::resetStats(void) {
+   _stats.reset();
+   resetQueueHighWaterMark();
+}
+
+/**
+ * @brief Latest value wins: a new emit of a coalesced event rewrites its packet
+ * still waiting in the queue instead of queuing another one, so a fast
+ * producer never fills the queue with stale values. Only events of the main
+ * namespace are coalesced, and never those emitted with an ack. The name is
+ * not copied, it must be a literal or outlive the client.
+ *
+ * @param event const char *
+ * @param enable bool
+ * @return bool false if SIO_MAX_COALESCED_EVENTS events are already coalesced
+ */
+bool ArduinoSocketIOClient::coalesce(const char *event, bool enable) {
+   CoalescedEvent *entry = findCoalesced(event);
+   if (!enable) {
+      // Its pending packet stays in the queue
+      if (entry) {
+         *entry = _coalesced[--_coalescedCount];
+      }
+      return true;
+   }
+
+   if (entry) {
+      return true;
+   }
+   if (_coalescedCount >= SIO_MAX_COALESCED_EVENTS) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] more than %d coalesced events, %s not coalesced\n", SIO_MAX_COALESCED_EVENTS, event);
+      return false;
+   }
+   entry = &_coalesced[_coalescedCount++];
+   entry->event = event;
+   entry->hash = SocketIOEventTable::hash(event);
+   entry->packet = NULL;
+   return true;
+}
+
+/**
+ * @brief Get the entry of a coalesced event
+ *
+ * @param event const char *
+ * @return CoalescedEvent * NULL if the event is not coalesced
+ */
+ArduinoSocketIOClient::CoalescedEvent *ArduinoSocketIOClient::findCoalesced(const char *event) {
+   if (!_coalescedCount) {
+      return NULL;
+   }
+   uint32_t hash = SocketIOEventTable::hash(event);
+   for (uint8_t i = 0; i < _coalescedCount; i++) {
+      if (_coalesced[i].hash == hash && strcmp(_coalesced[i].event, event) == 0) {
+         return &_coalesced[i];
+      }
+   }
+   return NULL;
+}
+
+/**
+ * @brief Split the outbound queue in two lanes: loop() sends the high
+ * priority lane first, so control traffic does not wait behind bulk
+ * telemetry. Must be called before begin().
+ *
+ * @param laneBytes size_t bytes of the arena given to the high priority lane,
+ * 0 for a single lane (sIOpriority_HIGH is then ignored)
+ * @param ratio uint8_t after this many high priority packets sent in a row,
+ * one normal packet waiting goes first; 0 for strict priority
+ */
+void ArduinoSocketIOClient::configurePriority(size_t laneBytes, uint8_t ratio) {
+   _priorityBytes = laneBytes;
+   _priorityRatio = ratio;
+}
+
+/**
+ * @brief Send every emit of an event in the high priority lane, whatever the
+ * namespace. The name is not copied, it must be a literal or outlive the
+ * client.
+ *
+ * @param event const char *
+ * @param priority socketIOpriority_t sIOpriority_NORMAL to undo
+ * @return bool false if SIO_MAX_PRIORITY_EVENTS events already have a priority
+ */
+bool ArduinoSocketIOClient::setPriority(const char *event, socketIOpriority_t priority) {
+   PriorityEvent *entry = findPriority(event);
+   if (priority != sIOpriority_HIGH) {
+      if (entry) {
+         *entry = _priorityEvents[--_priorityEventCount];
+      }
+      return true;
+   }
+
+   if (entry) {
+      return true;
+   }
+   if (_priorityEventCount >= SIO_MAX_PRIORITY_EVENTS) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] more than %d priority events, %s not added\n", SIO_MAX_PRIORITY_EVENTS, event);
+      return false;
+   }
+   entry = &_priorityEvents[_priorityEventCount++];
+   entry->event = event;
+   entry->hash = SocketIOEventTable::hash(event);
+   return true;
+}
+
+/**
+ * @brief Get the entry of an event marked with setPriority()
+ *
+ * @param event const char *
+ * @return PriorityEvent * NULL if the event has the normal priority
+ */
+ArduinoSocketIOClient::PriorityEvent *ArduinoSocketIOClient::findPriority(const char *event) {
+   if (!_priorityEventCount) {
+      return NULL;
+   }
+   uint32_t hash = SocketIOEventTable::hash(event);
+   for (uint8_t i = 0; i < _priorityEventCount; i++) {
+      if (_priorityEvents[i].hash == hash && strcmp(_priorityEvents[i].event, event) == 0) {
+         return &_priorityEvents[i];
+      }
+   }
+   return NULL;
+}
+
+/**
+ * @brief Choose the lane of a packet being emitted
+ *
+ * @param priority socketIOpriority_t asked by the caller
+ * @param event const char * NULL for an ack
+ * @return SocketIOPacketQueue * the normal lane if the high priority one is
+ * off
+ */
+SocketIOPacketQueue *ArduinoSocketIOClient::selectLane(socketIOpriority_t priority, const char *event) {
+   if (!_priorityPackets.isReady()) {
+      return &_packets;
+   }
+   return priority == sIOpriority_HIGH || (event && findPriority(event)) ? &_priorityPackets : &_packets;
+}
+
+/**
+ * @brief Lane loop() sends from next: the high priority one, unless it sent
+ * _priorityRatio packets in a row while normal ones wait. The normal lane
+ * waits for the offline log to be replayed: it was emitted after it, unless
+ * it takes the room the next record needs (see replayPackets).
+ *
+ * @return SocketIOPacketQueue * NULL if no lane can send now
+ */
+SocketIOPacketQueue *ArduinoSocketIOClient::nextLane(void) {
+   if (_packets.isEmpty() || (_offline && _offline->isReady() && !_offline->isEmpty() && !_replayBlocked)) {
+      _priorityBurst = 0;
+      return _priorityPackets.isEmpty() ? NULL : &_priorityPackets;
+   }
+   if (_priorityPackets.isEmpty() || (_priorityRatio && _priorityBurst >= _priorityRatio)) {
+      return &_packets;
+   }
+   return &_priorityPackets;
+}
+
+/**
+ * @brief Store and forward: while the connection is down, events are queued
+ * anyway and loop() moves them to the log, which keeps them across reboots.
+ * Once connected again the log is replayed in order (see
+ * configureOfflineReplay) before the queue. The log must be opened with
+ * begin() and outlive the client. NULL to turn it off.
+ *
+ * @param log SocketIOOfflineLog *
+ */
+void ArduinoSocketIOClient::setOfflineLog(SocketIOOfflineLog *log) { _offline = log; }
+
+/**
+ * @brief Rate of the replay of the offline log: packets packets every interval
+ * milliseconds, so a long outage does not flood the server (nor block loop())
+ *
+ * @param packets uint16_t
+ * @param interval uint32_t
+ */
+void ArduinoSocketIOClient::configureOfflineReplay(uint16_t packets, uint32_t interval) {
+   _replayPackets = packets ? packets : 1;
+   _replayInterval = interval;
+}
+
+/**
+ * @brief Reserve room for a packet in the outbound queue, applying the
+ * overflow policy when it is full
+ *
+ * @param length size_t
+ * @param result socketIOemitResult_t & why NULL was returned, or whether
+ * packets were evicted
+ * @return uint8_t * NULL if the packet can not be queued
+ */
+uint8_t *ArduinoSocketIOClient::reservePacket(size_t length, socketIOemitResult_t &result) {
+   result = sIOemit_QUEUED;
+   // Too large for the high priority lane: it waits with the normal packets
+   if (_lane != &_packets && !_lane->fits(length)) {
+      _lane = &_packets;
+   }
+   SocketIOPacketQueue &queue = *_lane;
+   if (!queue.fits(length)) {
+      result = sIOemit_TOO_LARGE;
+      _stats.droppedPackets++;
+      return NULL;
+   }
+
+   uint8_t *packet = queue.reserve(length);
+   if (packet) {
+      return packet;
+   }
+
+   switch (_overflowPolicy) {
+   case sIOoverflow_DROP_OLDEST:
+      while (!packet && !queue.isEmpty()) {
+         popPacket(queue);
+         _stats.droppedPackets++;
+         packet = queue.reserve(length);
+      }
+      result = sIOemit_QUEUED_EVICTED;
+      return packet;
+   case sIOoverflow_DROP_NEWEST:
+      result = sIOemit_DROPPED;
+      break;
+   case sIOoverflow_REJECT:
+      result = sIOemit_REJECTED;
+      break;
+   }
+   _stats.droppedPackets++;
+   return NULL;
+}
+
+/**
+ * @brief Initiate client and bind to function param in function onEvent. You
+ * can override it for your customizing
+ *
+ */
+void ArduinoSocketIOClient::initClient(void) {
+   initMemory();
+
+   // The main namespace, joined on every connection
+   _namespaces[0].begin(this, _nsp);
+   _namespaces[0]._joined = true;
+
+   // The backoff decides when to reconnect
+   if (_reconnectDelay) {
+      WebSocketsClient::setReconnectInterval(0);
+   }
+
+   onEvent(std::bind(&ArduinoSocketIOClient::socketEvent, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+
+   if (_client.cUrl.indexOf("EIO=4") != -1) {
+      SOCKETIOCLIENT_DEBUG("[wsIOc] found EIO=4 disable EIO ping on client\n");
+      configureEIOping(true);
+   }
+}
+
+/**
+ * @brief Set the reconnection backoff: after a lost connection the client
+ * waits delay milliseconds before trying again, then twice longer after each
+ * failed attempt, up to maxDelay. Every wait is spread at random by +/-
+ * jitter percent. The connection made first by begin() is not delayed.
+ *
+ * @param delay uint32_t 0 to reconnect at WebSocketsClient's fixed interval
+ * @param maxDelay uint32_t
+ * @param jitter uint8_t percent, up to 100
+ */
+void ArduinoSocketIOClient::configureReconnect(uint32_t delay, uint32_t maxDelay, uint8_t jitter) {
+   _reconnectDelay = delay;
+   _reconnectDelayMax = maxDelay > delay ? maxDelay : delay;
+   _reconnectJitter = jitter < 100 ? jitter : 100;
+   _reconnectWait = 0;
+   WebSocketsClient::setReconnectInterval(delay ? 0 : 500);
+}
+
+/**
+ * @brief Start the wait before the next connection attempt
+ *
+ */
+void ArduinoSocketIOClient::scheduleReconnect(void) {
+   uint32_t wait = _reconnectDelay;
+   for (uint16_t i = 0; i < _reconnectAttempts && wait < _reconnectDelayMax; i++) {
+      wait *= 2;
+   }
+   if (wait > _reconnectDelayMax) {
+      wait = _reconnectDelayMax;
+   }
+   // Uniform in [wait - spread, wait + spread]
+   uint32_t spread = (uint64_t)wait * _reconnectJitter / 100;
+   if (spread) {
+      wait = wait - spread + (uint32_t)random((long)spread * 2 + 1);
+   }
+
+   _reconnectWait = wait ? wait : 1;
+   _reconnectFrom = millis();
+   if (_reconnectAttempts < 0xFFFF) {
+      _reconnectAttempts++;
+   }
+   SOCKETIOCLIENT_DEBUG("[SIoC] reconnect attempt %u in %u ms\n", _reconnectAttempts, _reconnectWait);
+}
+
+/**
+ * @brief Check whether WebSocketsClient may try to connect now: never while
+ * the backoff waits, the outcome of the attempt let through deciding the
+ * next wait
+ *
+ * @return bool
+ */
+bool ArduinoSocketIOClient::reconnectDue(void) {
+   if (!_reconnectDelay || _client.status != WSC_NOT_CONNECTED) {
+      return true;
+   }
+   if (_reconnecting) {
+      // Still not connected: the attempt failed
+      _reconnecting = false;
+      scheduleReconnect();
+   }
+   if (_reconnectWait && millis() - _reconnectFrom < _reconnectWait) {
+      return false;
+   }
+   _reconnecting = true;
+   return true;
+}
+
+/**
+ * @brief Get the handle of a namespace multiplexed over this connection,
+ * joined now if the client is connected and on every connection after. The
+ * same handle is returned for the same name; the main namespace (the one
+ * given to begin) is there too. The name is not copied, it must be a literal
+ * or outlive the client.
+ *
+ * @param nsp const char * "/admin"
+ * @return SocketIONamespace * NULL if SIO_MAX_NAMESPACES are already used
+ */
+SocketIONamespace *ArduinoSocketIOClient::of(const char *nsp) {
+   SocketIONamespace *found = findNamespace(nsp, strlen(nsp));
+   if (found) {
+      return found;
+   }
+   if (_namespaceCount >= SIO_MAX_NAMESPACES) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] more than %d namespaces, %s not added\n", SIO_MAX_NAMESPACES, nsp);
+      return NULL;
+   }
+   found = &_namespaces[_namespaceCount++];
+   found->begin(this, nsp);
+   found->connect();
+   return found;
+}
+
+/**
+ * @brief Find the namespace of a received packet
+ *
+ * @param name const char * not terminated
+ * @param length size_t
+ * @return SocketIONamespace * NULL if the client did not join it
+ */
+SocketIONamespace *ArduinoSocketIOClient::findNamespace(const char *name, size_t length) {
+   for (uint8_t i = 0; i < _namespaceCount; i++) {
+      if (_namespaces[i].matches(name, length)) {
+         return &_namespaces[i];
+      }
+   }
+   return NULL;
+}
+
+/**
+ * @brief Count the acks waiting for an answer in every namespace
+ *
+ * @return size_t
+ */
+size_t ArduinoSocketIOClient::getPendingAcks(void) const {
+   size_t pending = 0;
+   for (uint8_t i = 0; i < _namespaceCount; i++) {
+      pending += _namespaces[i].getPendingAcks();
+   }
+   return pending;
+}
+
+/**
+ * @brief Bytes held by the routes of every namespace
+ *
+ * @return size_t
+ */
+size_t ArduinoSocketIOClient::getRouteMemory(void) const {
+   size_t bytes = 0;
+   for (uint8_t i = 0; i < _namespaceCount; i++) {
+      bytes += _namespaces[i].getRouteMemory();
+   }
+   return bytes;
+}
+
+/**
+ * @brief Add a listener function into the main namespace, this listener can
+ * handle event that is sent from server
+ *
+ * @param event const char *
+ * @param func std::function<void(const char *payload, size_t length)>
+ */
+void ArduinoSocketIOClient::on(const char *event, std::function<void(const char *payload, size_t length)> func) { _namespaces[0].on(event, func); }
+
+/**
+ * @brief Add a listener function into the main namespace, this listener can
+ * handle event that is sent from server
+ *
+ * @param event String
+ * @param func std::function<void(const char *payload, size_t length)>
+ */
+void ArduinoSocketIOClient::on(String event, std::function<void(const char *payload, size_t length)> func) { on(event.c_str(), func); }
+
+/**
+ * @brief Add a listener function into the main namespace for an event
+ * declared at compile time. Its name is not copied.
+ *
+ * @param event const SocketIOEvent &
+ * @param func std::function<void(const char *payload, size_t length)>
+ */
+void ArduinoSocketIOClient::on(const SocketIOEvent &event, std::function<void(const char *payload, size_t length)> func) { _namespaces[0].on(event, func); }
+
+/**
+ * @brief Receive an event of the main namespace chunk by chunk: its
+ * arguments, as raw JSON text, are handed over fragment by fragment as the
+ * message arrives, so an event of tens of KB never has to fit in memory.
+ * Events that arrive in one frame are handed over as one sIOstream_END chunk.
+ * The listener replaces any on() listener of the event. The name is not
+ * copied, it must be a literal or outlive the client.
+ *
+ * @param event const char *
+ * @param handler SocketIOStreamHandler NULL to remove
+ * @return bool false if SIO_MAX_STREAM_EVENTS events are already streamed
+ */
+bool ArduinoSocketIOClient::onStream(const char *event, SocketIOStreamHandler handler) { return addStream(&_namespaces[0], event, handler); }
+
+/**
+ * @brief Add, replace or remove a stream listener
+ *
+ * @param nsp SocketIONamespace *
+ * @param event const char *
+ * @param handler SocketIOStreamHandler
+ * @return bool
+ */
+bool ArduinoSocketIOClient::addStream(SocketIONamespace *nsp, const char *event, SocketIOStreamHandler handler) {
+   size_t length = strlen(event);
+   StreamListener *stream = findStream(nsp, event, length);
+   if (!handler) {
+      if (stream) {
+         if (_stream) {
+            // The message being received goes to nobody now
+            _stream = NULL;
+            _streamSkip = true;
+         }
+         *stream = _streams[--_streamCount];
+         _streams[_streamCount].handler = NULL;
+      }
+      return true;
+   }
+
+   if (!stream) {
+      if (_streamCount >= SIO_MAX_STREAM_EVENTS) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] more than %d stream events, %s not added\n", SIO_MAX_STREAM_EVENTS, event);
+         return false;
+      }
+      stream = &_streams[_streamCount++];
+      stream->nsp = nsp;
+      stream->event = event;
+      stream->length = length;
+   }
+   stream->handler = handler;
+   return true;
+}
+
+/**
+ * @brief Find the stream listener of an event
+ *
+ * @param nsp const SocketIONamespace *
+ * @param event const char * as received, not terminated
+ * @param length size_t
+ * @return StreamListener * NULL if the event is not streamed
+ */
+ArduinoSocketIOClient::StreamListener *ArduinoSocketIOClient::findStream(const SocketIONamespace *nsp, const char *event, size_t length) {
+   for (uint8_t i = 0; i < _streamCount; i++) {
+      if (_streams[i].nsp == nsp && _streams[i].length == length && memcmp(_streams[i].event, event, length) == 0) {
+         return &_streams[i];
+      }
+   }
+   return NULL;
+}
+
+/**
+ * @brief Remove the event handle function of the main namespace
+ *
+ * @param event const char *
+ */
+void ArduinoSocketIOClient::remove(const char *event) { remove(SocketIOEvent(event, SocketIOEventTable::hash(event))); }
+
+/**
+ * @brief Remove the event handle function of the main namespace
+ *
+ * @param event String
+ */
+void ArduinoSocketIOClient::remove(String event) { remove(event.c_str()); }
+
+/**
+ * @brief Remove the event handle function of the main namespace
+ *
+ * @param event const SocketIOEvent &
+ */
+void ArduinoSocketIOClient::remove(const SocketIOEvent &event) { _namespaces[0].remove(event); }
+
+/**
+ * @brief Remove all of event handle functions of the main namespace
+ *
+ */
+void ArduinoSocketIOClient::removeAll() { _namespaces[0].removeAll(); }
+
+/**
+ * @brief Function send event + message to server. This function support format
+ * JSON message
+ *
+ * @param event const char *
+ * @param payload const char * sent as a JSON string
+ * @return socketIOemitResult_t sIOemit_QUEUED or sIOemit_QUEUED_EVICTED if
+ * the packet was queued
+ */
+socketIOemitResult_t ArduinoSocketIOClient::emit(const char *event, const char *payload) { return emit<const char *>(event, payload); }
+
+/**
+ * @brief Send an event whose argument is JSON text, sent verbatim: an object
+ * payload reaches the server as an object, not as a string to parse again.
+ *
+ * @param event const char *
+ * @param json const char *
+ * @param length size_t 0 if json is null terminated
+ * @return socketIOemitResult_t sIOemit_INVALID_JSON if json is not one JSON
+ * value
+ */
+socketIOemitResult_t ArduinoSocketIOClient::emitRaw(const char *event, const char *json, size_t length) {
+   SocketIORawJson raw(json, length);
+
+   // The server would drop the whole packet
+   if (!raw.json || !SocketIOEventParser::isJson(raw.json, raw.length)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] invalid JSON for event %s\n", event);
+      return sIOemit_INVALID_JSON;
+   }
+
+   return emit(event, raw);
+}
+
+/**
+ * @brief Reserve a packet in the queue for an event or ack array measured by
+ * measure, and write what comes before the array. A packet is:
+ * [SIO_MAX_HEADER_SIZE header room][message]['\0'] then for each attachment
+ * [uint32_t length][WEBSOCKETS_MAX_HEADER_SIZE header room][data]. Until it is
+ * sent the header room holds the message length (first 4 bytes) and the
+ * Socket.IO type (last byte).
+ *
+ * @param type socketIOmessageType_t
+ * @param ackId int32_t -1 for none
+ * @param event const char * NULL for an ack
+ * @param measure const SocketIOFrameWriter & the array, measured
+ * @param result socketIOemitResult_t &
+ * @return char * where the array goes (measure.length() + 1 bytes), NULL if
+ * the packet can not be queued
+ */
+char *ArduinoSocketIOClient::beginPacket(const SocketIONamespace &nsp, socketIOmessageType_t type, int32_t ackId, const char *event, const SocketIOFrameWriter &measure, socketIOemitResult_t &result) {
+   size_t messageLength;
+   size_t size = packetSize(nsp, ackId, measure, &messageLength);
+   bool fits = fitsPayload(messageLength);
+   for (uint8_t i = 0; i < measure.attachments(); i++) {
+      fits = fits && (!_maxPayload || measure.attachment(i).length <= _maxPayload);
+   }
+   // The server would close the connection on it
+   if (!fits) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] packet larger than maxPayload (%u)\n", _maxPayload);
+      result = sIOemit_TOO_LARGE;
+      _stats.droppedPackets++;
+      return NULL;
+   }
+
+   // Latest value wins: rewrite the packet of a coalesced event still queued
+   // (events of the main namespace only)
+   _coalescing = event && ackId < 0 && &nsp == &_namespaces[0] ? findCoalesced(event) : NULL;
+   _inPlace = false;
+   if (_coalescing && _coalescing->packet) {
+      _coalescedReplaced++;
+      if (_coalescing->lane == _lane && _lane->room(_coalescing->packet) >= size) {
+         _packet = _coalescing->packet;
+         _inPlace = true;
+         result = sIOemit_COALESCED;
+      } else {
+         // No room for the new value there, or another lane: the old one is
+         // discarded, its bytes given back at once when it is the last one
+         _coalescing->lane->discard(_coalescing->packet);
+         _coalescing->packet = NULL;
+      }
+   }
+
+   // Room for the headers first so loop() sends the packet as it is
+   if (!_inPlace) {
+      size_t room = _coalescing && _lane->fits(size + SIO_COALESCE_SLACK) ? size + SIO_COALESCE_SLACK : size;
+      _packet = reservePacket(room, result);
+      if (!_packet) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] queue full, packet not queued (%u bytes)\n", size);
+         return NULL;
+      }
+   }
+   return writeHeader(_packet, nsp, type, ackId, measure, messageLength);
+}
+
+/**
+ * @brief Bytes of a packet, see beginPacket
+ *
+ * @param nsp const SocketIONamespace &
+ * @param ackId int32_t -1 for none
+ * @param measure const SocketIOFrameWriter & the array, measured
+ * @param messageLength size_t * set to the length of the message: N-[/nsp,][ackId][...]
+ * @return size_t
+ */
+size_t ArduinoSocketIOClient::packetSize(const SocketIONamespace &nsp, int32_t ackId, const SocketIOFrameWriter &measure, size_t *messageLength) {
+   SocketIOFrameWriter prefix;
+   if (measure.attachments()) {
+      prefix.value(measure.attachments());
+      prefix.raw('-');
+   }
+   if (ackId >= 0) {
+      prefix.value(ackId);
+   }
+
+   *messageLength = prefix.length() + nsp._prefixLength + measure.length();
+   size_t size = SIO_MAX_HEADER_SIZE + *messageLength + 1;
+   for (uint8_t i = 0; i < measure.attachments(); i++) {
+      size += sizeof(uint32_t) + WEBSOCKETS_MAX_HEADER_SIZE + measure.attachment(i).length;
+   }
+   return size;
+}
+
+/**
+ * @brief Write the header room of a packet: message length, emit time, ack
+ * id flag and type, overwritten by send()
+ *
+ * @param packet uint8_t *
+ * @param type socketIOmessageType_t
+ * @param ackId int32_t -1 for none
+ * @param messageLength size_t
+ */
+void ArduinoSocketIOClient::stampPacket(uint8_t *packet, socketIOmessageType_t type, int32_t ackId, size_t messageLength) {
+   uint32_t length32 = messageLength;
+   memcpy(packet, &length32, sizeof(length32));
+   packet[SIO_MAX_HEADER_SIZE - 1] = type;
+   packet[SIO_PACKET_ACK_ID] = ackId >= 0;
+   uint32_t stamp = micros();
+   memcpy(packet + SIO_PACKET_STAMP, &stamp, sizeof(stamp));
+}
+
+/**
+ * @brief Write what comes before the array of a packet
+ *
+ * @param packet uint8_t * packetSize() bytes
+ * @param nsp const SocketIONamespace &
+ * @param type socketIOmessageType_t
+ * @param ackId int32_t -1 for none
+ * @param measure const SocketIOFrameWriter & the array, measured
+ * @param messageLength size_t from packetSize()
+ * @return char * where the array goes (measure.length() + 1 bytes)
+ */
+char *ArduinoSocketIOClient::writeHeader(uint8_t *packet, const SocketIONamespace &nsp, socketIOmessageType_t type, int32_t ackId, const SocketIOFrameWriter &measure, size_t messageLength) {
+   // Hint: N-_nsp,id[_event_name,_message]
+   stampPacket(packet, type, ackId, messageLength);
+   char *message = (char *)packet + SIO_MAX_HEADER_SIZE;
+   SocketIOFrameWriter count(message, 8);
+   if (measure.attachments()) {
+      count.value(measure.attachments());
+      count.raw('-');
+   }
+   message += count.length();
+   if (nsp._prefixLength) {
+      memcpy(message, nsp._name, nsp._nameLength);
+      message[nsp._nameLength] = ',';
+   }
+   message += nsp._prefixLength;
+   SocketIOFrameWriter id(message, 12);
+   if (ackId >= 0) {
+      id.value(ackId);
+   }
+   return message + id.length();
+}
+
+/**
+ * @brief Copy the attachments of a written array after its message
+ *
+ * @param end uint8_t * just after the '\0' of the message
+ * @param writer const SocketIOFrameWriter & the array, written
+ * @return uint8_t * end of the packet
+ */
+uint8_t *ArduinoSocketIOClient::writeAttachments(uint8_t *end, const SocketIOFrameWriter &writer) {
+   for (uint8_t i = 0; i < writer.attachments(); i++) {
+      const SocketIOBinary &binary = writer.attachment(i);
+      uint32_t length32 = binary.length;
+      memcpy(end, &length32, sizeof(length32));
+      end += sizeof(length32) + WEBSOCKETS_MAX_HEADER_SIZE;
+      if (binary.length) {
+         memcpy(end, binary.data, binary.length);
+      }
+      end += binary.length;
+   }
+   return end;
+}
+
+/**
+ * @brief Publish the packet started by beginPacket, copying the attachments
+ * after the message
+ *
+ * @param message const char * returned by beginPacket
+ * @param writer const SocketIOFrameWriter & the array, written
+ */
+void ArduinoSocketIOClient::endPacket(const char *message, const SocketIOFrameWriter &writer) {
+   uint8_t *end = writeAttachments((uint8_t *)message + writer.length() + 1, writer);
+
+   // SOCKETIOCLIENT_DEBUG("[SIoC] add packet (%u bytes)\n", end - _packet);
+   if (_inPlace) {
+      _lane->resize(_packet, end - _packet);
+   } else {
+      _lane->commit(end - _packet);
+   }
+   if (_coalescing) {
+      _coalescing->packet = _packet;
+      _coalescing->lane = _lane;
+   }
+   _coalescing = NULL;
+   _inPlace = false;
+   _packet = NULL;
+}
+
+/**
+ * @brief Clear the mask key slot in the header room of a frame about to be
+ * sent with headerToPayload, see unmask()
+ *
+ * @param room uint8_t * the WEBSOCKETS_MAX_HEADER_SIZE bytes before the data
+ */
+void ArduinoSocketIOClient::clearMask(uint8_t *room) { memset(room + WEBSOCKETS_MAX_HEADER_SIZE - 4, 0, 4); }
+
+/**
+ * @brief Undo the masking of a frame sent with headerToPayload: the mask key
+ * is the end of the header, right in front of the data. A key cleared by
+ * clearMask() and left so by sendFrame() leaves the data as it is.
+ *
+ * @param room uint8_t * the WEBSOCKETS_MAX_HEADER_SIZE bytes before the data
+ * @param length size_t data length
+ */
+void ArduinoSocketIOClient::unmask(uint8_t *room, size_t length) {
+   const uint8_t *key = room + WEBSOCKETS_MAX_HEADER_SIZE - 4;
+   uint8_t *data = room + WEBSOCKETS_MAX_HEADER_SIZE;
+   for (size_t i = 0; i < length; i++) {
+      data[i] ^= key[i % 4];
+   }
+}
+
+/**
+ * @brief Send a queued packet: its message, then its attachments as binary
+ * frames. Every frame is masked in place and written at once. When a frame
+ * fails, the packet is unmasked again and its header restored: it can be
+ * retried or stored as it was queued.
+ *
+ * @param packet uint8_t *
+ * @param length size_t
+ * @return true if every frame was sent
+ */
+bool ArduinoSocketIOClient::sendPacket(uint8_t *packet, size_t length) {
+   // The frame headers overwrite the packet header
+   uint8_t header[SIO_MAX_HEADER_SIZE];
+   memcpy(header, packet, sizeof(header));
+   uint32_t messageLength;
+   memcpy(&messageLength, packet, sizeof(messageLength));
+   socketIOmessageType_t type = (socketIOmessageType_t)packet[SIO_MAX_HEADER_SIZE - 1];
+
+   if (_encoding == sIOencoding_MSGPACK) {
+      // One binary frame, attachments inlined
+      uint8_t *room = packet + SIO_MAX_HEADER_SIZE - WEBSOCKETS_MAX_HEADER_SIZE;
+      clearMask(room);
+      if (sendMsgPack(type, room, messageLength)) {
+         return true;
+      }
+      unmask(room, messageLength);
+      memcpy(packet, header, sizeof(header));
+      return false;
+   }
+
+   // The message frame starts with the Engine.IO and Socket.IO type bytes
+   clearMask(packet);
+   bool sent = send(type, packet, messageLength, true);
+
+   uint8_t *attachment = packet + SIO_MAX_HEADER_SIZE + messageLength + 1;
+   uint8_t *end = packet + length;
+   while (sent && attachment < end) {
+      uint32_t attachmentLength;
+      memcpy(&attachmentLength, attachment, sizeof(attachmentLength));
+      attachment += sizeof(attachmentLength);
+      clearMask(attachment);
+      // Engine.IO v4 sends binary data as plain binary frames
+      sent = WebSocketsClient::sendFrame(&_client, WSop_binary, attachment, attachmentLength, true, true);
+      if (sent) {
+         SocketIOStats::count(_stats.binaryOut, attachmentLength);
+      }
+      attachment += WEBSOCKETS_MAX_HEADER_SIZE + attachmentLength;
+   }
+   if (sent) {
+      return true;
+   }
+
+   // Unmask the frames written so far and the one that failed
+   uint8_t *failed = attachment;
+   unmask(packet, messageLength + 2);
+   attachment = packet + SIO_MAX_HEADER_SIZE + messageLength + 1;
+   while (attachment < failed && attachment < end) {
+      uint32_t attachmentLength;
+      memcpy(&attachmentLength, attachment, sizeof(attachmentLength));
+      attachment += sizeof(attachmentLength);
+      unmask(attachment, attachmentLength);
+      attachment += WEBSOCKETS_MAX_HEADER_SIZE + attachmentLength;
+   }
+   memcpy(packet, header, sizeof(header));
+   return false;
+}
+
+/**
+ * @brief Reserve a packet in the queue for a MessagePack message of length
+ * bytes, laid out like the packets of beginPacket without attachments
+ *
+ * @param type socketIOmessageType_t
+ * @param ackId int32_t -1 for none
+ * @param length size_t
+ * @param result socketIOemitResult_t &
+ * @return uint8_t * where the message goes, NULL if the packet can not be
+ * queued
+ */
+uint8_t *ArduinoSocketIOClient::beginMsgPack(socketIOmessageType_t type, int32_t ackId, size_t length, socketIOemitResult_t &result) {
+   // The server would close the connection on it
+   if (!fitsPayload(length)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] packet larger than maxPayload (%u)\n", _maxPayload);
+      result = sIOemit_TOO_LARGE;
+      _stats.droppedPackets++;
+      return NULL;
+   }
+
+   uint8_t *packet = reservePacket(SIO_MAX_HEADER_SIZE + length + 1, result);
+   if (!packet) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] queue full, packet not queued (%u bytes)\n", length);
+      return NULL;
+   }
+   stampPacket(packet, type, ackId, length);
+   packet[SIO_MAX_HEADER_SIZE + length] = '\0';
+   return packet + SIO_MAX_HEADER_SIZE;
+}
+
+/**
+ * @brief Send a MessagePack packet as one binary frame, masked in place
+ *
+ * @param type socketIOmessageType_t counted in the statistics
+ * @param payload uint8_t * WEBSOCKETS_MAX_HEADER_SIZE free bytes, then the
+ * packet
+ * @param length size_t of the packet
+ * @return true if ok
+ */
+bool ArduinoSocketIOClient::sendMsgPack(socketIOmessageType_t type, uint8_t *payload, size_t length) {
+   if (!isWritable()) {
+      return false;
+   }
+   bool sent = WebSocketsClient::sendFrame(&_client, WSop_binary, payload, length, true, true);
+   if (sent) {
+      SocketIOStats::count(_stats.eioOut, eIOtype_MESSAGE, length);
+      SocketIOStats::count(_stats.sioOut, type, length);
+   }
+   return sent;
+}
+
+/**
+ * @brief Send the CONNECT or DISCONNECT packet of a namespace in MessagePack:
+ * {"type":0,"nsp":"/chat"}, with "data":{"pid":...,"offset":...} to recover
+ * a session
+ *
+ * @param type socketIOmessageType_t
+ * @param nsp const SocketIONamespace &
+ * @return true if ok
+ */
+bool ArduinoSocketIOClient::sendNamespace(socketIOmessageType_t type, const SocketIONamespace &nsp) {
+   if (!_frameBuffer) {
+      return false;
+   }
+
+   SocketIOMsgPackWriter writer(_frameBuffer + SIO_MAX_HEADER_SIZE, _frameBufferSize - SIO_MAX_HEADER_SIZE);
+   bool session = type == sIOtype_CONNECT && nsp._pid[0];
+   writer.mapHeader(session ? 3 : 2);
+   writer.string("type", 4);
+   writer.integer(type - '0', false);
+   writer.string("nsp", 3);
+   writer.string(nsp._name, nsp._nameLength);
+   if (session) {
+      writer.string("data", 4);
+      writer.mapHeader(nsp._offset[0] ? 2 : 1);
+      writer.string("pid", 3);
+      writer.value(nsp._pid);
+      if (nsp._offset[0]) {
+         writer.string("offset", 6);
+         writer.value(nsp._offset);
+      }
+   }
+   if (writer.overflowed()) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] namespace name too long (%u)\n", nsp._nameLength);
+      return false;
+   }
+   return sendMsgPack(type, _frameBuffer + SIO_MAX_HEADER_SIZE - WEBSOCKETS_MAX_HEADER_SIZE, writer.length());
+}
+
+/**
+ * @brief Start a volatile packet in the frame buffer: attachment count and
+ * namespace, the array goes after them
+ *
+ * @param nsp const SocketIONamespace &
+ * @param measure const SocketIOFrameWriter & the array, measured
+ * @param result socketIOemitResult_t & why NULL was returned
+ * @return char * where the array goes (measure.length() + 1 bytes), NULL if
+ * the packet does not fit
+ */
+char *ArduinoSocketIOClient::beginVolatile(const SocketIONamespace &nsp, const SocketIOFrameWriter &measure, socketIOemitResult_t &result) {
+   char count[8];
+   SocketIOFrameWriter countWriter(count, sizeof(count));
+   if (measure.attachments()) {
+      countWriter.value(measure.attachments());
+      countWriter.raw('-');
+   }
+
+   size_t messageLength = countWriter.length() + nsp._prefixLength + measure.length();
+   bool fits = !measure.tooManyAttachments() && fitsPayload(messageLength) && SIO_MAX_HEADER_SIZE + messageLength + 1 <= _frameBufferSize;
+   for (uint8_t i = 0; fits && i < measure.attachments(); i++) {
+      size_t length = measure.attachment(i).length;
+      fits = (!_maxPayload || length <= _maxPayload) && WEBSOCKETS_MAX_HEADER_SIZE + length <= _frameBufferSize;
+   }
+   if (!fits) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] volatile packet too large (%u bytes)\n", messageLength);
+      result = sIOemit_TOO_LARGE;
+      _stats.droppedPackets++;
+      return NULL;
+   }
+
+   char *message = (char *)_frameBuffer + SIO_MAX_HEADER_SIZE;
+   memcpy(message, count, countWriter.length());
+   message += countWriter.length();
+   if (nsp._prefixLength) {
+      memcpy(message, nsp._name, nsp._nameLength);
+      message[nsp._nameLength] = ',';
+   }
+   return message + nsp._prefixLength;
+}
+
+/**
+ * @brief Write the volatile packet started by beginVolatile, then its
+ * attachments, each copied in turn into the frame buffer
+ *
+ * @param message const char * returned by beginVolatile
+ * @param writer const SocketIOFrameWriter & the array, written
+ * @return socketIOemitResult_t sIOemit_SENT, or sIOemit_VOLATILE_DROPPED if
+ * the connection broke while writing
+ */
+socketIOemitResult_t ArduinoSocketIOClient::endVolatile(const char *message, const SocketIOFrameWriter &writer) {
+   size_t messageLength = (const uint8_t *)message + writer.length() - (_frameBuffer + SIO_MAX_HEADER_SIZE);
+   bool sent = send(writer.attachments() ? sIOtype_BINARY_EVENT : sIOtype_EVENT, _frameBuffer, messageLength, true);
+   for (uint8_t i = 0; sent && i < writer.attachments(); i++) {
+      const SocketIOBinary &binary = writer.attachment(i);
+      if (binary.length) {
+         memcpy(_frameBuffer + WEBSOCKETS_MAX_HEADER_SIZE, binary.data, binary.length);
+      }
+      sent = WebSocketsClient::sendFrame(&_client, WSop_binary, _frameBuffer, binary.length, true, true);
+      if (sent) {
+         SocketIOStats::count(_stats.binaryOut, binary.length);
+      }
+   }
+   return sent ? sIOemit_SENT : dropVolatile();
+}
+
+/**
+ * @brief Remove the oldest packet of a lane
+ *
+ * @param queue SocketIOPacketQueue &
+ * @return bool true if it was the pending packet of a coalesced event
+ */
+bool ArduinoSocketIOClient::popPacket(SocketIOPacketQueue &queue) {
+   size_t length;
+   uint8_t *packet = queue.front(&length);
+   bool coalesced = false;
+   for (uint8_t i = 0; packet && i < _coalescedCount; i++) {
+      if (_coalesced[i].packet == packet) {
+         _coalesced[i].packet = NULL;
+         coalesced = true;
+      }
+   }
+   queue.pop();
+   return coalesced;
+}
+
+/**
+ * @brief Move every packet of a lane to the offline log, while the connection
+ * is down. A record is the packet without its header room: [type][uint32_t
+ * message length][message] then [uint32_t length][data] for each attachment.
+ * Acks are dropped: they answer the connection that was lost. So are events
+ * with an ack id: their callbacks failed with that connection.
+ *
+ * @param queue SocketIOPacketQueue &
+ */
+void ArduinoSocketIOClient::spillPackets(SocketIOPacketQueue &queue) {
+   size_t length;
+   uint8_t *packet;
+   while ((packet = queue.front(&length)) != NULL) {
+      uint32_t messageLength;
+      memcpy(&messageLength, packet, sizeof(messageLength));
+      socketIOmessageType_t type = (socketIOmessageType_t)packet[SIO_MAX_HEADER_SIZE - 1];
+      uint8_t *attachments = packet + SIO_MAX_HEADER_SIZE + messageLength + 1;
+      uint8_t *end = packet + length;
+
+      if ((type == sIOtype_EVENT || type == sIOtype_BINARY_EVENT) && !packet[SIO_PACKET_ACK_ID]) {
+         size_t recordLength = 1 + sizeof(messageLength) + messageLength;
+         for (uint8_t *attachment = attachments; attachment < end;) {
+            uint32_t attachmentLength;
+            memcpy(&attachmentLength, attachment, sizeof(attachmentLength));
+            recordLength += sizeof(attachmentLength) + attachmentLength;
+            attachment += sizeof(attachmentLength) + WEBSOCKETS_MAX_HEADER_SIZE + attachmentLength;
+         }
+
+         bool stored = _offline->beginRecord(recordLength) && _offline->write(&packet[SIO_MAX_HEADER_SIZE - 1], 1) && _offline->write(&messageLength, sizeof(messageLength)) && _offline->write(packet + SIO_MAX_HEADER_SIZE, messageLength);
+         for (uint8_t *attachment = attachments; stored && attachment < end;) {
+            uint32_t attachmentLength;
+            memcpy(&attachmentLength, attachment, sizeof(attachmentLength));
+            stored = _offline->write(attachment, sizeof(attachmentLength)) && _offline->write(attachment + sizeof(attachmentLength) + WEBSOCKETS_MAX_HEADER_SIZE, attachmentLength);
+            attachment += sizeof(attachmentLength) + WEBSOCKETS_MAX_HEADER_SIZE + attachmentLength;
+         }
+         stored = _offline->endRecord() && stored;
+         if (!stored) {
+            SOCKETIOCLIENT_DEBUG("[SIoC] offline log full, packet lost (%u bytes)\n", recordLength);
+            _stats.lostPackets++;
+         }
+      } else {
+         _stats.droppedPackets++;
+      }
+      popPacket(queue);
+   }
+}
+
+/**
+ * @brief Send a burst of records of the offline log, oldest first. A record is
+ * consumed once sent, or when it can not be loaded; the read offset is saved
+ * once per burst. A record is loaded in scratch room of the normal lane: when
+ * the packets held back there leave too little, it stays first in the log and
+ * the lane may send one packet to make room for the next burst.
+ *
+ */
+void ArduinoSocketIOClient::replayPackets(void) {
+   _replayBlocked = false;
+   for (uint16_t i = 0; i < _replayPackets && isWritable() && (!_budgetSent || withinBudget()); i++) {
+      size_t recordLength = _offline->peekRecord();
+      if (!recordLength) {
+         break;
+      }
+
+      // Attachments take header room in the queue, not in the log
+      size_t room = SIO_MAX_HEADER_SIZE + recordLength + SIO_MAX_ATTACHMENTS * WEBSOCKETS_MAX_HEADER_SIZE;
+      uint8_t *packet = _packets.fits(room) ? _packets.reserveScratch(room) : NULL;
+      if (!packet && _packets.fits(room)) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] record kept, no room in the queue to load it\n");
+         _replayBlocked = true;
+         break;
+      }
+
+      size_t length;
+      if (!packet || !loadRecord(packet, recordLength, &length)) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] offline record dropped (%u bytes)\n", recordLength);
+         _offline->consume();
+         _stats.lostPackets++;
+         continue;
+      }
+      if (!sendPacket(packet, length)) {
+         // Still the oldest record: replayed on the next connection
+         SOCKETIOCLIENT_DEBUG("[SIoC] record kept, connection broken while sending\n");
+         break;
+      }
+      _offline->consume();
+      _budgetSent += length;
+   }
+   _offline->flush();
+}
+
+/**
+ * @brief Rebuild the record opened by peekRecord as a queue packet, in scratch
+ * room reserved but not committed in the normal lane: it is sent from there
+ * and the room is reused by the next record
+ *
+ * @param packet uint8_t * room for the record and the headers of its
+ * attachments
+ * @param recordLength size_t
+ * @param length size_t * length of the packet
+ * @return bool false if the record is malformed
+ */
+bool ArduinoSocketIOClient::loadRecord(uint8_t *packet, size_t recordLength, size_t *length) {
+   uint8_t type;
+   uint32_t messageLength;
+   if (recordLength < 1 + sizeof(messageLength) || !_offline->read(&type, 1) || !_offline->read(&messageLength, sizeof(messageLength)) || messageLength > recordLength - 1 - sizeof(messageLength)) {
+      return false;
+   }
+
+   size_t rest = recordLength - 1 - sizeof(messageLength) - messageLength;
+   if (!_offline->read(packet + SIO_MAX_HEADER_SIZE, messageLength)) {
+      return false;
+   }
+   memcpy(packet, &messageLength, sizeof(messageLength));
+   packet[SIO_MAX_HEADER_SIZE - 1] = type;
+   uint8_t *end = packet + SIO_MAX_HEADER_SIZE + messageLength;
+   *end++ = '\0';
+
+   for (uint8_t i = 0; rest > 0; i++) {
+      uint32_t attachmentLength;
+      if (i >= SIO_MAX_ATTACHMENTS || rest < sizeof(attachmentLength) || !_offline->read(&attachmentLength, sizeof(attachmentLength))) {
+         return false;
+      }
+      rest -= sizeof(attachmentLength);
+      if (attachmentLength > rest) {
+         return false;
+      }
+      memcpy(end, &attachmentLength, sizeof(attachmentLength));
+      end += sizeof(attachmentLength) + WEBSOCKETS_MAX_HEADER_SIZE;
+      if (!_offline->read(end, attachmentLength)) {
+         return false;
+      }
+      end += attachmentLength;
+      rest -= attachmentLength;
+   }
+
+   *length = end - packet;
+   return true;
+}
+
+/**
+ * @brief Function send event + message to server. This function support format
+ * JSON message
+ *
+ * @param event String
+ * @param payload String
+ * @return socketIOemitResult_t
+ */
+socketIOemitResult_t ArduinoSocketIOClient::emit(String event, String payload) { return emit(event.c_str(), payload.c_str()); }
+
+/**
+ * @brief This function is used for calling listener function in _packets to
+ * handle event.
+ *
+ * @param event const char *
+ * @param payload const char *
+ * @param length size_t
+ */
+void ArduinoSocketIOClient::trigger(const char *event, const char *payload, size_t length) { trigger(_namespaces[0], event, payload, length); }
+
+/**
+ * @brief Call the listener of an event in a namespace, else the listener of
+ * the most specific route matching its name
+ *
+ * @param nsp SocketIONamespace &
+ * @param event const char *
+ * @param payload const char *
+ * @param length size_t
+ */
+void ArduinoSocketIOClient::trigger(SocketIONamespace &nsp, const char *event, const char *payload, size_t length) {
+   if (nsp._events.dispatch(event, payload, length)) {
+      // SOCKETIOCLIENT_DEBUG("[SIoC] trigger event %s\n", event);
+   } else if (!nsp._routes.dispatch(event, payload, length)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] event %s not found. %d events available\n", event, nsp._events.size());
+      _stats.unmatchedEvents++;
+   }
+}
+
+/**
+ * @brief This function is used for handling event that is sent from server.
+ *
+ * @param payload uint8_t * null terminated frame
+ * @return socketIOparseError_t
+ */
+socketIOparseError_t ArduinoSocketIOClient::handleEvent(uint8_t *payload) { return handleEvent(payload, payload ? strlen((const char *)payload) : 0); }
+
+/**
+ * @brief This function is used for handling event that is sent from server.
+ * The frame is parsed once in place: the handler gets the event argument
+ * straight from the receive buffer, which is modified.
+ *
+ * @param payload uint8_t *
+ * @param length size_t
+ * @return socketIOparseError_t sIOparse_OK if the event was dispatched
+ */
+socketIOparseError_t ArduinoSocketIOClient::handleEvent(uint8_t *payload, size_t length) {
+   if (_streamCount && handleStream(payload, length)) {
+      return sIOparse_OK;
+   }
+
+   SocketIOEventFrame frame;
+   uint32_t start = micros();
+   socketIOparseError_t err = SocketIOEventParser::parseEvent(payload, length, frame);
+   uint32_t parsed = micros();
+   _stats.parseTime.record(parsed - start);
+
+   if (err != sIOparse_OK) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop malformed event (%s): %s\n", SocketIOEventParser::errorToString(err), payload);
+      _stats.parseFailures++;
+      return err;
+   }
+
+   SocketIONamespace *nsp = findNamespace(frame.nsp, frame.nspLength);
+   if (!nsp) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] event %s of a namespace not joined\n", frame.event);
+      _stats.unmatchedEvents++;
+      return sIOparse_OK;
+   }
+
+   nsp->keepOffset(frame);
+
+   // Listeners answer with ack(), in the namespace of the event
+   _ackRequestId = frame.ackId;
+   _ackNamespace = nsp;
+   trigger(*nsp, frame.event, frame.data, frame.dataLength);
+   _ackRequestId = -1;
+   _ackNamespace = NULL;
+   _stats.handlerTime.record(micros() - parsed);
+   return sIOparse_OK;
+}
+
+/**
+ * @brief Hand an event received in one frame to its stream listener, as one
+ * sIOstream_END chunk
+ *
+ * @param payload uint8_t *
+ * @param length size_t
+ * @return bool false if the event is not streamed: it is dispatched as usual
+ */
+bool ArduinoSocketIOClient::handleStream(uint8_t *payload, size_t length) {
+   SocketIOEventFrame frame;
+   if (SocketIOEventParser::parseEventHead(payload, length, frame) != sIOparse_OK) {
+      return false;
+   }
+   StreamListener *stream = findStream(findNamespace(frame.nsp, frame.nspLength), frame.event, frame.eventLength);
+   if (!stream) {
+      return false;
+   }
+   size_t dataLength = frame.dataLength;
+   if (!endChunk(frame.data, dataLength)) {
+      return false;
+   }
+   deliverChunk(stream, frame.ackId, frame.data, dataLength, sIOstream_END);
+   return true;
+}
+
+/**
+ * @brief Strip the end of the array, and the whitespace around it, from the
+ * last chunk of a stream
+ *
+ * @param chunk const char *
+ * @param length size_t & trimmed
+ * @return bool false if the chunk does not end the array
+ */
+bool ArduinoSocketIOClient::endChunk(const char *chunk, size_t &length) {
+   bool closed = false;
+   while (length) {
+      char c = chunk[length - 1];
+      if (c == ']' && !closed) {
+         closed = true;
+      } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+         break;
+      }
+      length--;
+   }
+   return closed;
+}
+
+/**
+ * @brief Call a stream listener. The last chunk can be answered with ack().
  *
+ * @param stream StreamListener *
+ * @param ackId int32_t
+ * @param chunk const char *
+ * @param length size_t
+ * @param state socketIOstreamState_t
  */
-void ArduinoSocketIOClient::initClient(void) {
-   onEvent(std::bind(&ArduinoSocketIOClient::socketEvent, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-
-   if (_client.cUrl.indexOf("EIO=4") != -1) {
-      SOCKETIOCLIENT_DEBUG("[wsIOc] found EIO=4 disable EIO ping on client\n");
-      configureEIOping(true);
+void ArduinoSocketIOClient::deliverChunk(StreamListener *stream, int32_t ackId, const char *chunk, size_t length, socketIOstreamState_t state) {
+   uint32_t start = micros();
+   if (state == sIOstream_END) {
+      _ackRequestId = ackId;
+      _ackNamespace = stream->nsp;
    }
+   stream->handler(chunk, length, state);
+   _ackRequestId = -1;
+   _ackNamespace = NULL;
+   _stats.handlerTime.record(micros() - start);
 }
 
 /**
- * @brief Add a listener function into _packets, this listener can handle event
- * that is sent from server
+ * @brief First fragment of a message too large for one frame. Only events
+ * with a stream listener are received this way: the name, namespace and ack
+ * id are read from this fragment, which must hold them, and the arguments
+ * go to the listener as they arrive. Nothing is buffered.
  *
- * @param event const char *
- * @param func std::function<void(const char *payload, size_t length)>
+ * @param type WStype_t
+ * @param payload uint8_t *
+ * @param length size_t
  */
-void ArduinoSocketIOClient::on(const char *event, std::function<void(const char *payload, size_t length)> func) { _events[event] = func; }
+void ArduinoSocketIOClient::beginFragments(WStype_t type, uint8_t *payload, size_t length) {
+   if (_stream) {
+      deliverChunk(_stream, -1, NULL, 0, sIOstream_ABORT);
+   }
+   _stream = NULL;
+   _streamSkip = true;
+   if (type != WStype_FRAGMENT_TEXT_START || length < 2 || payload[0] != eIOtype_MESSAGE) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop fragmented message (%u)\n", length);
+      _stats.droppedPackets++;
+      return;
+   }
+   SocketIOStats::count(_stats.eioIn, eIOtype_MESSAGE, length);
+   SocketIOStats::count(_stats.sioIn, payload[1], length - 2);
+   if (payload[1] != sIOtype_EVENT) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop fragmented packet %c\n", payload[1]);
+      _stats.droppedPackets++;
+      return;
+   }
+
+   SocketIOEventFrame frame;
+   socketIOparseError_t err = SocketIOEventParser::parseEventHead(payload + 2, length - 2, frame);
+   if (err != sIOparse_OK) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop fragmented event (%s)\n", SocketIOEventParser::errorToString(err));
+      _stats.parseFailures++;
+      return;
+   }
+   StreamListener *stream = findStream(findNamespace(frame.nsp, frame.nspLength), frame.event, frame.eventLength);
+   if (!stream) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] fragmented event without stream listener\n");
+      _stats.unmatchedEvents++;
+      return;
+   }
+
+   _stream = stream;
+   _streamAckId = frame.ackId;
+   _streamSkip = false;
+   if (frame.dataLength) {
+      deliverChunk(stream, -1, frame.data, frame.dataLength, sIOstream_DATA);
+   }
+}
 
 /**
- * @brief Add a listener function into _packets, this listener can handle event
- * that is sent from server
+ * @brief Next fragment of the message started by beginFragments
  *
- * @param event String
- * @param func std::function<void(const char *payload, size_t length)>
+ * @param payload uint8_t *
+ * @param length size_t
+ * @param fin bool whether it is the last one
  */
-void ArduinoSocketIOClient::on(String event, std::function<void(const char *payload, size_t length)> func) { on(event.c_str(), func); }
+void ArduinoSocketIOClient::handleFragment(uint8_t *payload, size_t length, bool fin) {
+   if (!_streamSkip) {
+      _stats.eioIn[eIOtype_MESSAGE - '0'].bytes += length;
+      _stats.sioIn[sIOtype_EVENT - '0'].bytes += length;
+   }
+   StreamListener *stream = _stream;
+   if (!stream) {
+      _streamSkip = _streamSkip && !fin;
+      return;
+   }
+   if (!fin) {
+      if (length) {
+         deliverChunk(stream, -1, (const char *)payload, length, sIOstream_DATA);
+      }
+      return;
+   }
+
+   _stream = NULL;
+   _streamSkip = false;
+   if (!endChunk((const char *)payload, length)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] fragmented event not terminated\n");
+      _stats.parseFailures++;
+      deliverChunk(stream, -1, NULL, 0, sIOstream_ABORT);
+      return;
+   }
+   deliverChunk(stream, _streamAckId, (const char *)payload, length, sIOstream_END);
+}
 
 /**
- * @brief Remove the event handle function in _events of class
- * ArduinoSocketIOClient
+ * @brief Deliver an ack sent by the server to the handler given to
+ * emitWithAck. The frame is parsed in place like an event.
  *
- * @param event const char *
+ * @param payload uint8_t *
+ * @param length size_t
+ * @return socketIOparseError_t sIOparse_OK if the frame was well formed
  */
-void ArduinoSocketIOClient::remove(const char *event) {
-   auto e = _events.find(event);
-   if (e != _events.end()) {
-      _events.erase(e);
+socketIOparseError_t ArduinoSocketIOClient::handleAck(uint8_t *payload, size_t length) {
+   SocketIOEventFrame frame;
+   uint32_t start = micros();
+   socketIOparseError_t err = SocketIOEventParser::parseAck(payload, length, frame);
+   uint32_t parsed = micros();
+   _stats.parseTime.record(parsed - start);
+
+   if (err != sIOparse_OK) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop malformed ack (%s): %s\n", SocketIOEventParser::errorToString(err), payload);
+      _stats.parseFailures++;
+      return err;
+   }
+
+   SocketIONamespace *nsp = findNamespace(frame.nsp, frame.nspLength);
+   if (!nsp || !nsp->_acks.resolve(frame.ackId, frame.data, frame.dataLength)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] ack %d not pending\n", frame.ackId);
+      _stats.unmatchedAcks++;
    } else {
-      SOCKETIOCLIENT_DEBUG("[SIoC] event %s not found, can not be removed", event);
+      _stats.handlerTime.record(micros() - parsed);
    }
+   return sIOparse_OK;
 }
 
 /**
- * @brief Remove the event handle function in _events of class
- * ArduinoSocketIOClient
+ * @brief Handle the text frame of a binary event: N-[/nsp,][ackId]["event",...].
+ * The listener runs once the N binary frames that follow arrived, and reads
+ * them with getAttachment.
  *
- * @param event String
+ * @param payload uint8_t *
+ * @param length size_t
+ * @return socketIOparseError_t sIOparse_OK if the frame was well formed
  */
-void ArduinoSocketIOClient::remove(String event) { remove(event.c_str()); }
+socketIOparseError_t ArduinoSocketIOClient::handleBinaryEvent(uint8_t *payload, size_t length) { return beginBinary(sIOtype_BINARY_EVENT, payload, length); }
 
 /**
- * @brief Remove all of event handle functions in _events of class
- * ArduinoSocketIOClient
+ * @brief Handle the text frame of a binary ack, see handleBinaryEvent
  *
+ * @param payload uint8_t *
+ * @param length size_t
+ * @return socketIOparseError_t sIOparse_OK if the frame was well formed
  */
-void ArduinoSocketIOClient::removeAll() { _events.clear(); }
+socketIOparseError_t ArduinoSocketIOClient::handleBinaryAck(uint8_t *payload, size_t length) { return beginBinary(sIOtype_BINARY_ACK, payload, length); }
 
 /**
- * @brief Function send event + message to server. This function support format
- * JSON message
+ * @brief Get an attachment of the binary event or ack being dispatched. Only
+ * valid inside the listener: the last attachment is read straight from the
+ * receive buffer.
  *
- * @param event const char *
- * @param payload const char *
+ * @param num uint8_t "num" of the placeholder
+ * @param length size_t *
+ * @return const uint8_t * NULL if there is no such attachment
  */
-void ArduinoSocketIOClient::emit(const char *event, const char *payload) {
-   if (isConnected()) {
-      const int capacity = FACTOR * (String(_nsp).length() + String(event).length() + String(payload).length());
-
-      DynamicJsonDocument _doc(capacity);
-      JsonArray _ms = _doc.to<JsonArray>();
+const uint8_t *ArduinoSocketIOClient::getAttachment(uint8_t num, size_t *length) const {
+   if (num >= _attachmentCount) {
+      *length = 0;
+      return NULL;
+   }
+   *length = _attachments[num].length;
+   return _attachments[num].data;
+}
 
-      // Add event name
-      // Hint: socket.on('event_name', ....
-      _ms.add(event);
+/**
+ * @brief Read the attachment count of a binary packet and keep its text until
+ * the attachments arrived
+ *
+ * @param type socketIOmessageType_t sIOtype_BINARY_EVENT or sIOtype_BINARY_ACK
+ * @param payload uint8_t *
+ * @param length size_t
+ * @return socketIOparseError_t
+ */
+socketIOparseError_t ArduinoSocketIOClient::beginBinary(socketIOmessageType_t type, uint8_t *payload, size_t length) {
+   // A packet still waiting for attachments is incomplete: drop it
+   _binaryExpected = 0;
+   _binarySkip = 0;
+
+   size_t i = 0;
+   uint32_t count = 0;
+   while (i < length && payload[i] >= '0' && payload[i] <= '9' && count <= 255) {
+      count = count * 10 + (payload[i++] - '0');
+   }
+   if (i == 0 || i >= length || payload[i] != '-' || count > 255) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop binary packet without attachment count: %s\n", payload);
+      _stats.parseFailures++;
+      return sIOparse_BAD_ATTACHMENTS;
+   }
+   payload += i + 1;
+   length -= i + 1;
 
-      // Add message
-      _ms.add(payload);
+   if (count == 0) {
+      return type == sIOtype_BINARY_ACK ? handleAck(payload, length) : handleEvent(payload, length);
+   }
 
-      // JSON to String (serializion)
-      String message;
-      serializeJson(_ms, message);
+   if (count > SIO_MAX_ATTACHMENTS || !_binaryBuffer || length > _binaryBufferSize) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop binary packet (%u attachments, %u bytes)\n", count, length);
+      _binarySkip = count;
+      _stats.droppedPackets++;
+      return sIOparse_BAD_ATTACHMENTS;
+   }
 
-      // Add namespace
-      if (!String(_nsp).equals("/")) {
-         // Hint: _nsp,[_event_name,_message]
-         message = String(_nsp) + "," + message;
-      }
+   // The receive buffer is reused by the next frame: keep the text
+   memcpy(_binaryBuffer, payload, length);
+   _binaryHeaderLength = length;
+   _binaryUsed = length;
+   _binaryType = type;
+   _binaryExpected = count;
+   _attachmentCount = 0;
+   return sIOparse_OK;
+}
 
-      // SOCKETIOCLIENT_DEBUG("[SIoC] add packet %s\n", message.c_str());
-      _packets.push_back(message);
+/**
+ * @brief Handle a binary frame: an attachment of the pending binary packet.
+ * All but the last one are copied, the last one is delivered in place.
+ *
+ * @param payload uint8_t *
+ * @param length size_t
+ */
+void ArduinoSocketIOClient::handleAttachment(uint8_t *payload, size_t length) {
+   if (_binarySkip) {
+      _binarySkip--;
+      return;
+   }
+   if (!_binaryExpected) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] unexpected binary frame (%u bytes)\n", length);
+      _stats.parseFailures++;
+      return;
+   }
 
-      // Clear store
-      _doc.clear();
-   } else {
-      SOCKETIOCLIENT_DEBUG("[SIoC]: Disconnected!");
+   if (_attachmentCount + 1 < _binaryExpected) {
+      if (length > _binaryBufferSize - _binaryUsed) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] drop binary packet, attachment %u too large (%u bytes)\n", _attachmentCount, length);
+         _binarySkip = _binaryExpected - _attachmentCount - 1;
+         _binaryExpected = 0;
+         _attachmentCount = 0;
+         _stats.droppedPackets++;
+         return;
+      }
+      memcpy(_binaryBuffer + _binaryUsed, payload, length);
+      _attachments[_attachmentCount++] = SocketIOBinary(_binaryBuffer + _binaryUsed, length);
+      _binaryUsed += length;
+      return;
    }
+
+   _attachments[_attachmentCount++] = SocketIOBinary(payload, length);
+   dispatchBinary();
 }
 
 /**
- * @brief Function send event + message to server. This function support format
- * JSON message
+ * @brief Dispatch a binary packet whose attachments all arrived
  *
- * @param event String
- * @param payload String
+ * @return socketIOparseError_t
  */
-void ArduinoSocketIOClient::emit(String event, String payload) { emit(event.c_str(), payload.c_str()); }
+socketIOparseError_t ArduinoSocketIOClient::dispatchBinary(void) {
+   _binaryExpected = 0;
+   socketIOparseError_t err = _binaryType == sIOtype_BINARY_ACK ? handleAck(_binaryBuffer, _binaryHeaderLength) : handleEvent(_binaryBuffer, _binaryHeaderLength);
+   _attachmentCount = 0;
+   return err;
+}
 
 /**
- * @brief This function is used for calling listener function in _packets to
- * handle event.
+ * @brief Update the connect state of a namespace: [/nsp,][data] of a CONNECT
+ * (accepted), DISCONNECT (left by the server) or ERROR (refused) packet
  *
- * @param event const char *
- * @param payload const char *
+ * @param type socketIOmessageType_t
+ * @param payload uint8_t *
  * @param length size_t
  */
-void ArduinoSocketIOClient::trigger(const char *event, const char *payload, size_t length) {
-   auto e = _events.find(event);
-   if (e != _events.end()) {
-      // SOCKETIOCLIENT_DEBUG("[SIoC] trigger event %s\n", event);
-      e->second(payload, length);
-   } else {
-      SOCKETIOCLIENT_DEBUG("[SIoC] event %s not found. %d events available\n", event, _events.size());
+void ArduinoSocketIOClient::handleNamespace(socketIOmessageType_t type, uint8_t *payload, size_t length) {
+   const char *name = "/";
+   size_t nameLength = 1;
+   const char *data = (const char *)payload;
+   if (length && payload[0] == '/') {
+      const char *comma = (const char *)memchr(payload, ',', length);
+      name = (const char *)payload;
+      nameLength = comma ? (size_t)(comma - name) : length;
+      data = comma ? comma + 1 : name + length;
+   }
+   size_t dataLength = length - (data - (const char *)payload);
+
+   SocketIONamespace *nsp = findNamespace(name, nameLength);
+   if (!nsp) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] packet of a namespace not joined (%u)\n", nameLength);
+      return;
    }
+   updateNamespace(*nsp, type, data, dataLength);
 }
 
 /**
- * @brief Get event name of message string that is sent from server
+ * @brief Apply a CONNECT, DISCONNECT or ERROR packet to its namespace
  *
- * @param msg String
- * @return String
+ * @param nsp SocketIONamespace &
+ * @param type socketIOmessageType_t
+ * @param data const char * JSON text of the packet data
+ * @param length size_t
  */
-String ArduinoSocketIOClient::getEventName(String msg) {
-   const int capacity = FACTOR * msg.length();
-   DynamicJsonDocument doc(capacity);
-
-   String result = "";
-
-   // Remove prefix namespace of message
-   if (!String(_nsp).equals("/")) {
-      msg = msg.substring(msg.indexOf("["));
+void ArduinoSocketIOClient::updateNamespace(SocketIONamespace &nsp, socketIOmessageType_t type, const char *data, size_t length) {
+   switch (type) {
+   case sIOtype_CONNECT:
+      if (&nsp == &_namespaces[0] && _connecting) {
+         _connecting = false;
+         _stats.connectTime.record(micros() - _connectStart);
+      }
+      nsp.connected(data, length);
+      break;
+   case sIOtype_DISCONNECT:
+      // Not joined again on reconnection, as with socket.disconnect() on the server
+      nsp._joined = false;
+      nsp.disconnected("io server disconnect", 20);
+      break;
+   default:
+      nsp.disconnected(data, length);
+      break;
    }
+}
 
-   // Deserialize msg to array: [event,payload]
-   DeserializationError err = deserializeJson(doc, msg);
-
-   if (err == DeserializationError::Ok) {
-      // Get a reference to the root array
-      JsonArray arr = doc.as<JsonArray>();
-      // Get first element that is event name
-      result = String((const char *)arr.getElement(0));
-
-      // Remove character "
-      if (result.startsWith("\"")) {
-         result.remove(0, 1);
+/**
+ * @brief Handle a packet of the MessagePack encoding. Its arguments are
+ * translated to JSON text in the binary buffer, so listeners, acks and typed
+ * listeners get what the JSON encoding would hand them; bin values are read
+ * with getAttachment while the listener runs.
+ *
+ * @param payload uint8_t * the binary frame
+ * @param length size_t
+ * @return socketIOparseError_t sIOparse_OK if the packet was well formed
+ */
+socketIOparseError_t ArduinoSocketIOClient::handleMsgPack(uint8_t *payload, size_t length) {
+   SocketIOMsgPackPacket packet;
+   uint32_t start = micros();
+   socketIOparseError_t err = SocketIOMsgPackParser::parsePacket(payload, length, packet);
+   if (err != sIOparse_OK) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop malformed packet (%s)\n", SocketIOEventParser::errorToString(err));
+      _stats.parseFailures++;
+      return err;
+   }
+   socketIOmessageType_t type = (socketIOmessageType_t)packet.type;
+   SocketIOStats::count(_stats.sioIn, type, length);
+   SocketIONamespace *nsp = findNamespace(packet.nsp, packet.nspLength);
+   bool named = type == sIOtype_EVENT || type == sIOtype_BINARY_EVENT;
+
+   if (type == sIOtype_CONNECT || type == sIOtype_DISCONNECT || type == sIOtype_ERROR) {
+      if (!nsp) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] packet of a namespace not joined (%u)\n", packet.nspLength);
+         return sIOparse_OK;
       }
-
-      if (result.endsWith("\"")) {
-         result.remove(result.length() - 1);
+      // The data (handshake or error) as JSON text
+      SocketIOFrameWriter writer((char *)_binaryBuffer, _binaryBufferSize);
+      if (_binaryBuffer && packet.data && SocketIOMsgPackParser::toJson(packet.data, packet.dataEnd, writer) && writer.length() < _binaryBufferSize) {
+         _binaryBuffer[writer.length()] = '\0';
+         updateNamespace(*nsp, type, (const char *)_binaryBuffer, writer.length());
+      } else {
+         updateNamespace(*nsp, type, "", 0);
       }
+      return sIOparse_OK;
+   }
+
+   if (!nsp) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] packet of a namespace not joined (%u)\n", packet.nspLength);
+      named ? _stats.unmatchedEvents++ : _stats.unmatchedAcks++;
+      return sIOparse_OK;
    }
 
-   // Clear store
-   doc.clear();
+   SocketIOEventFrame frame;
+   err = decodeMsgPack(packet, named, frame);
+   uint32_t parsed = micros();
+   _stats.parseTime.record(parsed - start);
+   if (err != sIOparse_OK) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] drop malformed packet (%s)\n", SocketIOEventParser::errorToString(err));
+      _stats.parseFailures++;
+      _attachmentCount = 0;
+      return err;
+   }
 
-   // Return result
-   return result;
+   if (named) {
+      nsp->keepOffset(frame);
+      _ackRequestId = frame.ackId;
+      _ackNamespace = nsp;
+      trigger(*nsp, frame.event, frame.data, frame.dataLength);
+      _ackRequestId = -1;
+      _ackNamespace = NULL;
+      _stats.handlerTime.record(micros() - parsed);
+   } else if (frame.ackId < 0 || !nsp->_acks.resolve(frame.ackId, frame.data, frame.dataLength)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] ack %d not pending\n", frame.ackId);
+      _stats.unmatchedAcks++;
+   } else {
+      _stats.handlerTime.record(micros() - parsed);
+   }
+   _attachmentCount = 0;
+   return sIOparse_OK;
 }
 
 /**
- * @brief Get payload of message string that is sent from server
+ * @brief Translate the data of an event or ack packet into a frame, as
+ * SocketIOEventParser would parse its JSON encoding: the event name and the
+ * first argument (string content, JSON text otherwise) are written to the
+ * binary buffer, with the last argument if it is a string. The bin values of
+ * every argument become the attachments of the packet.
  *
- * @param msg String
- * @return String
+ * @param packet const SocketIOMsgPackPacket &
+ * @param named bool the first element is the event name
+ * @param frame SocketIOEventFrame &
+ * @return socketIOparseError_t
  */
-String ArduinoSocketIOClient::getEventPayload(String msg) {
-   const int capacity = FACTOR * msg.length();
-   DynamicJsonDocument doc(capacity);
-
-   String result = "";
-
-   // Remove prefix namespace of message
-   if (!String(_nsp).equals("/")) {
-      msg = msg.substring(msg.indexOf("["));
+socketIOparseError_t ArduinoSocketIOClient::decodeMsgPack(const SocketIOMsgPackPacket &packet, bool named, SocketIOEventFrame &frame) {
+   frame.nsp = packet.nsp;
+   frame.nspLength = packet.nspLength;
+   frame.ackId = packet.ackId;
+   frame.event = NULL;
+   frame.eventLength = 0;
+   frame.data = "";
+   frame.dataLength = 0;
+   frame.argc = 0;
+   frame.last = "";
+   frame.lastLength = 0;
+   _attachmentCount = 0;
+   if (!named && packet.ackId < 0) {
+      return sIOparse_MISSING_ACK_ID;
    }
 
-   // Deserialize msg to array: [event,payload]
-   DeserializationError err = deserializeJson(doc, msg);
-
-   if (err == DeserializationError::Ok) {
-      // Get a reference to the root array
-      JsonArray arr = doc.as<JsonArray>();
-      // Get second element that is payload
-      result = String((const char *)arr.getElement(1));
+   const uint8_t *end = packet.dataEnd;
+   SocketIOMsgPackValue array;
+   const uint8_t *p = packet.data ? SocketIOMsgPackParser::read(packet.data, end, array) : NULL;
+   if (!p || array.type != sIOmsgpack_ARRAY) {
+      return sIOparse_NOT_ARRAY;
+   }
+   if (!_binaryBuffer) {
+      return sIOparse_BAD_ARGUMENT;
+   }
 
-      // Remove character "
-      if (result.startsWith("\"")) {
-         result.remove(0, 1);
+   SocketIOFrameWriter writer((char *)_binaryBuffer, _binaryBufferSize);
+   uint64_t count = array.value;
+   const char *str;
+   size_t length;
+   if (named) {
+      if (!count || (p = SocketIOMsgPackParser::readString(p, end, &str, &length)) == NULL) {
+         return sIOparse_BAD_EVENT_NAME;
       }
-
-      if (result.endsWith("\"")) {
-         result.remove(result.length() - 1);
+      writer.raw(str, length);
+      writer.raw('\0');
+      frame.eventLength = length;
+      count--;
+   }
+   frame.argc = count < 255 ? count : 255;
+
+   // Attachments of the arguments after the first one, nothing written
+   SocketIOFrameWriter rest;
+   size_t dataAt = 0;
+   size_t lastAt = 0;
+   for (uint64_t i = 0; i < count; i++) {
+      const uint8_t *string = SocketIOMsgPackParser::readString(p, end, &str, &length);
+      const uint8_t *next = string;
+      if (i == 0) {
+         // A string is handed over as its content, like in the JSON encoding
+         dataAt = writer.length();
+         string ? writer.raw(str, length) : (void)(next = SocketIOMsgPackParser::toJson(p, end, writer));
+         frame.dataLength = writer.length() - dataAt;
+         writer.raw('\0');
+      } else if (!string) {
+         next = SocketIOMsgPackParser::toJson(p, end, rest);
+      }
+      if (!next) {
+         return sIOparse_BAD_ARGUMENT;
       }
+      if (string && i == count - 1) {
+         // Offset of connection state recovery, quoted like JSON text
+         lastAt = writer.length();
+         writer.string(str, length);
+         frame.lastLength = writer.length() - lastAt;
+      }
+      p = next;
    }
 
-   // Clear store
-   doc.clear();
-
-   // Return result
-   return result;
-}
+   if (writer.overflowed()) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] arguments larger than the binary buffer (%u)\n", writer.length());
+      return sIOparse_BAD_ARGUMENT;
+   }
+   if (writer.tooManyAttachments() || rest.tooManyAttachments() || writer.attachments() + rest.attachments() > SIO_MAX_ATTACHMENTS) {
+      return sIOparse_BAD_ATTACHMENTS;
+   }
+   for (uint8_t i = 0; i < writer.attachments(); i++) {
+      _attachments[_attachmentCount++] = writer.attachment(i);
+   }
+   for (uint8_t i = 0; i < rest.attachments(); i++) {
+      _attachments[_attachmentCount++] = rest.attachment(i);
+   }
 
-/**
- * @brief This function is used for handling event that is sent from server.
- *
- * @param payload uint8_t *
- */
-void ArduinoSocketIOClient::handleEvent(uint8_t *payload) {
-   String msg = String((char *)payload);
-   trigger(getEventName(msg).c_str(), getEventPayload(msg).c_str(), getEventPayload(msg).length());
+   if (named) {
+      frame.event = (const char *)_binaryBuffer;
+   }
+   if (count) {
+      frame.data = (const char *)_binaryBuffer + dataAt;
+   }
+   if (frame.lastLength) {
+      frame.last = (const char *)_binaryBuffer + lastAt;
+   }
+   return sIOparse_OK;
 }
 
 /**
@@ -380,36 +2099,90 @@ void ArduinoSocketIOClient::socketEvent(socketIOmessageType_t type, uint8_t *pay
       SOCKETIOCLIENT_DEBUG("[SIoC] Connected to url: %s\n", payload);
 
       // join default namespace (no auto join in Socket.IO V4)
-      // Connect to server with default path: "/" or with namespace
-      send(sIOtype_CONNECT, _nsp);
+      // Connect to server with default path: "/" or with namespace, then to
+      // the namespaces added by of()
+      for (uint8_t i = 0; i < _namespaceCount; i++) {
+         if (_namespaces[i]._joined) {
+            _namespaces[i].sendConnect();
+         }
+      }
 
       break;
    case sIOtype_EVENT:
       SOCKETIOCLIENT_DEBUG("[SIoC] get event: %s\n", payload);
 
-      // Serial.println("Message: " + String((char *)payload));
       // Handle message sent from server
-      handleEvent(payload);
+      handleEvent(payload, length);
       break;
    case sIOtype_ACK:
-      SOCKETIOCLIENT_DEBUG("[SIoC] get ack: %u\n", length);
-      hexdump(payload, length);
+      SOCKETIOCLIENT_DEBUG("[SIoC] get ack: %s\n", payload);
+
+      // Call the handler given to emitWithAck
+      handleAck(payload, length);
       break;
    case sIOtype_ERROR:
       SOCKETIOCLIENT_DEBUG("[SIoCc] get error: %u\n", length);
       hexdump(payload, length);
       break;
    case sIOtype_BINARY_EVENT:
-      SOCKETIOCLIENT_DEBUG("[SIoC] get binary: %u\n", length);
-      hexdump(payload, length);
+      SOCKETIOCLIENT_DEBUG("[SIoC] get binary: %s\n", payload);
+
+      // The listener runs when the attachments arrived
+      handleBinaryEvent(payload, length);
       break;
    case sIOtype_BINARY_ACK:
-      SOCKETIOCLIENT_DEBUG("[SIoC] get binary ack: %u\n", length);
-      hexdump(payload, length);
+      SOCKETIOCLIENT_DEBUG("[SIoC] get binary ack: %s\n", payload);
+      handleBinaryAck(payload, length);
       break;
    }
 }
 
+/**
+ * @brief Take the session parameters of the Engine.IO OPEN packet:
+ * {"sid":...,"pingInterval":25000,"pingTimeout":20000,"maxPayload":1000000}.
+ * Those missing keep their defaults.
+ *
+ * @param data const char *
+ * @param length size_t
+ */
+void ArduinoSocketIOClient::handleOpen(const char *data, size_t length) {
+   _pingInterval = EIO_HEARTBEAT_INTERVAL;
+   _pingTimeout = EIO_HEARTBEAT_TIMEOUT;
+   _maxPayload = 0;
+   SocketIOEventParser::findNumber(data, length, "pingInterval", &_pingInterval);
+   SocketIOEventParser::findNumber(data, length, "pingTimeout", &_pingTimeout);
+   SocketIOEventParser::findNumber(data, length, "maxPayload", &_maxPayload);
+   SOCKETIOCLIENT_DEBUG("[wsIOc] open: ping %u ms, timeout %u ms, max payload %u\n", _pingInterval, _pingTimeout, _maxPayload);
+
+   _lastHeartbeat = millis();
+   _lastPing = _lastHeartbeat;
+}
+
+/**
+ * @brief Run the heartbeat of the connection: the server pings every
+ * pingInterval (with EIO=3 the client pings and the server answers), and a
+ * connection silent for pingInterval + pingTimeout is closed so that the
+ * reconnection starts. It runs from the connection on, with the defaults
+ * until the OPEN packet gives the server's values.
+ *
+ * @param t unsigned long millis()
+ */
+void ArduinoSocketIOClient::checkHeartbeat(unsigned long t) {
+   if (!isConnected()) {
+      return;
+   }
+   if (!_disableHeartbeat && t - _lastPing >= _pingInterval) {
+      _lastPing = t;
+      SOCKETIOCLIENT_DEBUG("[wsIOc] send ping\n");
+      sendEngineIO("2");
+   }
+   if (t - _lastHeartbeat > (unsigned long)_pingInterval + _pingTimeout) {
+      SOCKETIOCLIENT_DEBUG("[wsIOc] no heartbeat for %lu ms, disconnect\n", t - _lastHeartbeat);
+      _stats.pingTimeouts++;
+      WebSocketsClient::disconnect();
+   }
+}
+
 /**
  * @brief Check status connection to server
  *
@@ -417,38 +2190,131 @@ void ArduinoSocketIOClient::socketEvent(socketIOmessageType_t type, uint8_t *pay
  */
 bool ArduinoSocketIOClient::isConnected(void) { return WebSocketsClient::isConnected(); }
 
+/**
+ * @brief Check whether a frame can be written now: send() would not fail
+ * before touching the transport
+ *
+ * @return bool
+ */
+bool ArduinoSocketIOClient::isWritable(void) { return clientIsConnected(&_client) && _client.status == WSC_CONNECTED; }
+
 /**
  * send text data to client
  * @param type socketIOmessageType_t
  * @param payload uint8_t *
  * @param length size_t
- * @param headerToPayload bool (see sendFrame for more details)
+ * @param headerToPayload bool (see sendFrame for more details): payload starts
+ * with SIO_MAX_HEADER_SIZE free bytes, followed by length bytes of data. The
+ * WebSocket and Engine.IO / Socket.IO headers are written into the free bytes
+ * and the data is masked in place, so the frame can not be sent twice.
  * @return true if ok
  */
 bool ArduinoSocketIOClient::send(socketIOmessageType_t type, uint8_t *payload, size_t length, bool headerToPayload) {
-   bool ret = false;
-   if (length == 0) {
-      length = strlen((const char *)payload);
-   }
-
-   if (clientIsConnected(&_client) && _client.status == WSC_CONNECTED) {
-      if (!headerToPayload) {
-         // webSocket Header
-         ret = WebSocketsClient::sendFrameHeader(&_client, WSop_text, length + 2, true);
-         // Engine.IO / Socket.IO Header
-         if (ret) {
-            uint8_t buf[3] = {eIOtype_MESSAGE, type, 0x00};
-            ret = WebSocketsClient::write(&_client, buf, 2);
-         }
-         if (ret && payload && length > 0) {
-            ret = WebSocketsClient::write(&_client, payload, length);
-         }
-         return ret;
-      } else {
-         // TODO implement
+   if (length == 0 && payload) {
+      length = strlen((const char *)payload + (headerToPayload ? SIO_MAX_HEADER_SIZE : 0));
+   }
+
+   if (!isWritable()) {
+      return false;
+   }
+   if (!fitsPayload(length)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] frame larger than maxPayload (%u)\n", _maxPayload);
+      _stats.droppedPackets++;
+      return false;
+   }
+
+   bool sent;
+   if (!headerToPayload) {
+      if (!_frameBuffer || SIO_MAX_HEADER_SIZE + length > _frameBufferSize) {
+         // Too large to be copied: headers in one write, data in a second
+         sent = sendSplit(type, payload, length);
+         countSent(sent, type, length);
+         return sent;
       }
+      // Assemble the frame after room for the headers
+      if (payload && length > 0) {
+         memcpy(_frameBuffer + SIO_MAX_HEADER_SIZE, payload, length);
+      }
+      payload = _frameBuffer;
    }
-   return false;
+
+   // Engine.IO / Socket.IO Header right in front of the data, sendFrame puts
+   // the webSocket Header before it: one write, no copy
+   payload[EIO_MAX_HEADER_SIZE - 1] = eIOtype_MESSAGE;
+   payload[SIO_MAX_HEADER_SIZE - 1] = type;
+   sent = WebSocketsClient::sendFrame(&_client, WSop_text, payload, length + 2, true, true);
+   countSent(sent, type, length);
+   return sent;
+}
+
+/**
+ * @brief Count a Socket.IO packet sent in an Engine.IO message frame
+ *
+ * @param sent bool
+ * @param type socketIOmessageType_t
+ * @param length size_t bytes after the type
+ */
+void ArduinoSocketIOClient::countSent(bool sent, socketIOmessageType_t type, size_t length) {
+   if (sent) {
+      SocketIOStats::count(_stats.eioOut, eIOtype_MESSAGE, length + 2);
+      SocketIOStats::count(_stats.sioOut, type, length);
+   }
+}
+
+/**
+ * @brief Send an Engine.IO frame of one character (ping, pong, upgrade) or
+ * text, counted
+ *
+ * @param payload const char *
+ * @return true if ok
+ */
+bool ArduinoSocketIOClient::sendEngineIO(const char *payload) {
+   size_t length = strlen(payload);
+   bool sent = WebSocketsClient::sendTXT(payload, length);
+   if (sent) {
+      SocketIOStats::count(_stats.eioOut, payload[0], length);
+   }
+   return sent;
+}
+
+/**
+ * @brief Send a frame whose data can not be copied into the frame buffer: the
+ * webSocket and Engine.IO / Socket.IO headers are written together, then the
+ * data, masked chunk by chunk on the stack with a random key so the caller's
+ * buffer is left as it is.
+ *
+ * @param type socketIOmessageType_t
+ * @param payload uint8_t *
+ * @param length size_t
+ * @return true if ok
+ */
+bool ArduinoSocketIOClient::sendSplit(socketIOmessageType_t type, uint8_t *payload, size_t length) {
+   uint8_t header[SIO_MAX_HEADER_SIZE];
+   uint8_t maskKey[4];
+   for (uint8_t i = 0; i < sizeof(maskKey); i++) {
+      maskKey[i] = random(0xFF);
+   }
+
+   uint8_t headerSize = WebSockets::createHeader(header, WSop_text, length + 2, _client.cIsClient, maskKey, true);
+   // The type bytes are the first two bytes of the masked data
+   header[headerSize++] = eIOtype_MESSAGE ^ maskKey[0];
+   header[headerSize++] = type ^ maskKey[1];
+
+   if (WebSocketsClient::write(&_client, header, headerSize) != headerSize) {
+      return false;
+   }
+   uint8_t chunk[SIO_MASK_CHUNK_SIZE];
+   for (size_t offset = 0; payload && offset < length;) {
+      size_t size = length - offset < sizeof(chunk) ? length - offset : sizeof(chunk);
+      for (size_t i = 0; i < size; i++) {
+         chunk[i] = payload[offset + i] ^ maskKey[(offset + i + 2) % 4];
+      }
+      if (WebSocketsClient::write(&_client, chunk, size) != size) {
+         return false;
+      }
+      offset += size;
+   }
+   return true;
 }
 
 bool ArduinoSocketIOClient::send(socketIOmessageType_t type, const uint8_t *payload, size_t length) { return send(type, (uint8_t *)payload, length); }
@@ -478,29 +2344,117 @@ bool ArduinoSocketIOClient::sendEVENT(const char *payload, size_t length) { retu
 bool ArduinoSocketIOClient::sendEVENT(String &payload) { return sendEVENT((uint8_t *)payload.c_str(), payload.length()); }
 
 /**
- * @brief Loop function is used for handling and sending events to server
+ * @brief Loop function is used for handling and sending events to server.
+ * With a budget the call returns once it is spent and the next call resumes
+ * where it stopped; at least one frame is read and one packet is sent per
+ * call, so work always moves on.
  *
+ * @param timeBudget uint32_t microseconds, 0 for no limit (and a single frame
+ * read, as without budget)
+ * @param byteBudget size_t bytes of packets sent, 0 for no limit
+ * @return bool true if work is left that could be done now: frames to read,
+ * or packets to send while connected
  */
-void ArduinoSocketIOClient::loop(void) {
-   WebSocketsClient::loop();
+bool ArduinoSocketIOClient::loop(uint32_t timeBudget, size_t byteBudget) {
+   _budgetStart = micros();
+   _timeBudget = timeBudget;
+   _byteBudget = byteBudget;
+   _budgetSent = 0;
+
+   // One frame per WebSocketsClient::loop(), more while the time budget lasts
+   if (reconnectDue()) {
+      if (_client.status == WSC_NOT_CONNECTED) {
+         // Connection attempt: timed until the main namespace is joined
+         _connectStart = micros();
+         _connecting = true;
+      }
+      WebSocketsClient::loop();
+   }
+   for (uint8_t frames = 1; timeBudget && frames < SIO_LOOP_MAX_INBOUND && isReadable() && withinBudget(); frames++) {
+      WebSocketsClient::loop();
+   }
+
    unsigned long t = millis();
-   if (!_disableHeartbeat && (t - _lastHeartbeat) > EIO_HEARTBEAT_INTERVAL) {
-      _lastHeartbeat = t;
-      SOCKETIOCLIENT_DEBUG("[wsIOc] send ping\n");
-      WebSocketsClient::sendTXT(eIOtype_PING);
+   for (uint8_t i = 0; i < _namespaceCount; i++) {
+      _namespaces[i]._acks.sweep(t);
+   }
+   checkHeartbeat(t);
+
+   if (_offline && _offline->isReady()) {
+      // Keep the order: while the log holds packets, nextLane() holds the
+      // normal lane back until they are replayed
+      if (!isWritable()) {
+         spillPackets(_priorityPackets);
+         spillPackets(_packets);
+      } else if (!_offline->isEmpty() && t - _lastReplay >= _replayInterval) {
+         _lastReplay = t;
+         replayPackets();
+      }
    }
 
-   for (auto packet = _packets.begin(); packet != _packets.end();) {
-      if (sendEVENT(*packet)) {
-         // SOCKETIOCLIENT_DEBUG("[SIoC] packet \"%s\" emitted\n",
-         // packet->c_str());
-         packet = _packets.erase(packet);
-      } else {
-         ++packet;
+   // High priority lane first, oldest first in a lane, stop at the first
+   // failure to keep the order. The heartbeat and namespace CONNECT packets
+   // are never queued: they were written as soon as they were due.
+   size_t length;
+   uint8_t *packet;
+   SocketIOPacketQueue *queue;
+   while (isWritable() && (queue = nextLane()) != NULL) {
+      packet = queue->front(&length);
+      if (_budgetSent && !withinBudget()) {
+         break;
+      }
+      uint32_t messageLength;
+      memcpy(&messageLength, packet, sizeof(messageLength));
+      if (!fitsPayload(messageLength)) {
+         // Queued before the OPEN packet told the limit
+         SOCKETIOCLIENT_DEBUG("[SIoC] packet larger than maxPayload dropped (%u bytes)\n", messageLength);
+         _stats.droppedPackets++;
+         popPacket(*queue);
+         continue;
       }
+      bool urgent = queue == &_priorityPackets;
+      uint32_t stamp;
+      memcpy(&stamp, packet + SIO_PACKET_STAMP, sizeof(stamp));
+      if (!sendPacket(packet, length)) {
+         // Left at the head of its lane as it was queued: retried, or stored
+         // by the offline log once the connection is down
+         SOCKETIOCLIENT_DEBUG("[SIoC] packet kept, connection broken while sending\n");
+         break;
+      }
+      (urgent ? _stats.priorityDelay : _stats.queueDelay).record(micros() - stamp);
+      _budgetSent += length;
+      _priorityBurst = urgent ? _priorityBurst + 1 : 0;
+      // One packet made room for the record it held back
+      _replayBlocked = _replayBlocked && urgent;
+      if (popPacket(*queue)) {
+         _coalescedSent++;
+      }
+      // SOCKETIOCLIENT_DEBUG("[SIoC] packet \"%s\" emitted\n", (char *)packet + SIO_MAX_HEADER_SIZE);
+   }
+
+   bool outbound = !_packets.isEmpty() || !_priorityPackets.isEmpty() || (_offline && !_offline->isEmpty());
+   return isReadable() || (outbound && isWritable());
+}
+
+/**
+ * @brief Check whether the budget of the running loop() call is left
+ *
+ * @return bool
+ */
+bool ArduinoSocketIOClient::withinBudget(void) {
+   if (_timeBudget && (uint32_t)(micros() - _budgetStart) >= _timeBudget) {
+      return false;
    }
+   return !_byteBudget || _budgetSent < _byteBudget;
 }
 
+/**
+ * @brief Check whether received data waits to be read
+ *
+ * @return bool
+ */
+bool ArduinoSocketIOClient::isReadable(void) { return _client.tcp && _client.tcp->available() > 0; }
+
 /**
  * @brief Handle event that is sent from server. This function is called in
  * websocket layer.
@@ -512,15 +2466,43 @@ void ArduinoSocketIOClient::loop(void) {
 void ArduinoSocketIOClient::handleCbEvent(WStype_t type, uint8_t *payload, size_t length) {
    switch (type) {
    case WStype_DISCONNECTED:
+      // The server will not answer acks of this connection
+      for (uint8_t i = 0; i < _namespaceCount; i++) {
+         _namespaces[i].disconnected(NULL, 0);
+      }
+      _binaryExpected = 0;
+      _binarySkip = 0;
+      if (_stream) {
+         deliverChunk(_stream, -1, NULL, 0, sIOstream_ABORT);
+         _stream = NULL;
+      }
+      _streamSkip = false;
+      _stats.disconnects++;
+      _reconnectAttempts = 0;
+      _reconnecting = false;
+      if (_reconnectDelay) {
+         scheduleReconnect();
+      }
       runIOCbEvent(sIOtype_DISCONNECT, NULL, 0);
       SOCKETIOCLIENT_DEBUG("[wsIOc] Disconnected!\n");
       break;
    case WStype_CONNECTED: {
       SOCKETIOCLIENT_DEBUG("[wsIOc] Connected to url: %s\n", payload);
-      // send message to server when Connected
-      // Engine.io upgrade confirmation message (required)
-      WebSocketsClient::sendTXT("2probe");
-      WebSocketsClient::sendTXT(eIOtype_UPGRADE);
+      if (_connectedOnce) {
+         _stats.reconnects++;
+      }
+      _reconnectAttempts = 0;
+      _reconnectWait = 0;
+      _reconnecting = false;
+      _connectedOnce = true;
+      // Native WebSocket transport: no probe nor upgrade, the namespaces are
+      // joined right away. The heartbeat runs with the defaults until the
+      // OPEN packet: a server that never sends it is still detected.
+      _pingInterval = EIO_HEARTBEAT_INTERVAL;
+      _pingTimeout = EIO_HEARTBEAT_TIMEOUT;
+      _maxPayload = 0;
+      _lastHeartbeat = millis();
+      _lastPing = _lastHeartbeat;
       runIOCbEvent(sIOtype_CONNECT, payload, length);
    } break;
    case WStype_TEXT: {
@@ -529,14 +2511,19 @@ void ArduinoSocketIOClient::handleCbEvent(WStype_t type, uint8_t *payload, size_
       }
 
       engineIOmessageType_t eType = (engineIOmessageType_t)payload[0];
+      SocketIOStats::count(_stats.eioIn, eType, length);
       switch (eType) {
       case eIOtype_PING:
+         _lastHeartbeat = millis();
          payload[0] = eIOtype_PONG;
          SOCKETIOCLIENT_DEBUG("[wsIOc] get ping send pong (%s)\n", payload);
-         WebSocketsClient::sendTXT(payload, length, false);
+         if (WebSocketsClient::sendTXT(payload, length, false)) {
+            SocketIOStats::count(_stats.eioOut, eIOtype_PONG, length);
+         }
          break;
       case eIOtype_PONG:
          SOCKETIOCLIENT_DEBUG("[wsIOc] get pong\n");
+         _lastHeartbeat = millis();
          break;
       case eIOtype_MESSAGE: {
          if (length < 2) {
@@ -545,18 +2532,27 @@ void ArduinoSocketIOClient::handleCbEvent(WStype_t type, uint8_t *payload, size_
          socketIOmessageType_t ioType = (socketIOmessageType_t)payload[1];
          uint8_t *data = &payload[2];
          size_t lData = length - 2;
+         SocketIOStats::count(_stats.sioIn, ioType, lData);
          switch (ioType) {
          case sIOtype_EVENT:
             SOCKETIOCLIENT_DEBUG("[wsIOc] get event (%d): %s\n", lData, data);
             break;
          case sIOtype_CONNECT:
             SOCKETIOCLIENT_DEBUG("[wsIOc] connected (%d): %s\n", lData, data);
+            handleNamespace(ioType, data, lData);
             return;
-         case sIOtype_DISCONNECT:
          case sIOtype_ACK:
-         case sIOtype_ERROR:
+            SOCKETIOCLIENT_DEBUG("[wsIOc] get ack (%d): %s\n", lData, data);
+            break;
          case sIOtype_BINARY_EVENT:
          case sIOtype_BINARY_ACK:
+            SOCKETIOCLIENT_DEBUG("[wsIOc] get binary packet (%d): %s\n", lData, data);
+            break;
+         case sIOtype_DISCONNECT:
+         case sIOtype_ERROR:
+            SOCKETIOCLIENT_DEBUG("[wsIOc] namespace left or refused (%d): %s\n", lData, data);
+            handleNamespace(ioType, data, lData);
+            break;
          default:
             SOCKETIOCLIENT_DEBUG("[wsIOc] Socket.IO Message Type %c (%02X) is not implemented\n", ioType, ioType);
             SOCKETIOCLIENT_DEBUG("[wsIOc] get text: %s\n", payload);
@@ -566,6 +2562,8 @@ void ArduinoSocketIOClient::handleCbEvent(WStype_t type, uint8_t *payload, size_
          runIOCbEvent(ioType, data, lData);
       } break;
       case eIOtype_OPEN:
+         handleOpen((const char *)payload + 1, length - 1);
+         break;
       case eIOtype_CLOSE:
       case eIOtype_UPGRADE:
       case eIOtype_NOOP:
@@ -575,12 +2573,27 @@ void ArduinoSocketIOClient::handleCbEvent(WStype_t type, uint8_t *payload, size_
          break;
       }
    } break;
-   case WStype_ERROR:
    case WStype_BIN:
+      if (_encoding == sIOencoding_MSGPACK) {
+         // A whole packet, binary arguments inlined
+         SocketIOStats::count(_stats.eioIn, eIOtype_MESSAGE, length);
+         handleMsgPack(payload, length);
+         break;
+      }
+      // Attachment of a binary event or ack
+      SocketIOStats::count(_stats.binaryIn, length);
+      handleAttachment(payload, length);
+      break;
    case WStype_FRAGMENT_TEXT_START:
    case WStype_FRAGMENT_BIN_START:
+      // Large message: streamed to its listener, fragment by fragment
+      beginFragments(type, payload, length);
+      break;
    case WStype_FRAGMENT:
    case WStype_FRAGMENT_FIN:
+      handleFragment(payload, length, type == WStype_FRAGMENT_FIN);
+      break;
+   case WStype_ERROR:
    case WStype_PING:
    case WStype_PONG:
       break;
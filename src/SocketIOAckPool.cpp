@@ -0,0 +1,160 @@
+/*
+ * SocketIOAckPool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOAckPool.h"
+
+SocketIOAckPool::SocketIOAckPool() {
+   for (uint8_t i = 0; i < SIO_MAX_PENDING_ACKS; i++) {
+      _slots[i].id = -1;
+      _free[_freeCount++] = SIO_MAX_PENDING_ACKS - 1 - i;
+   }
+}
+
+SocketIOAckPool::~SocketIOAckPool() {}
+
+/**
+ * @brief Take a free slot for an ack
+ *
+ * @param handler SocketIOAckHandler
+ * @param timeout uint32_t milliseconds, 0 to wait until the ack or the end of
+ * the connection
+ * @param now uint32_t millis()
+ * @return int32_t ack id to send, -1 if every slot is taken
+ */
+int32_t SocketIOAckPool::acquire(SocketIOAckHandler handler, uint32_t timeout, uint32_t now) {
+   if (_freeCount == 0) {
+      return -1;
+   }
+
+   uint8_t index = _free[--_freeCount];
+   Slot &slot = _slots[index];
+
+   // Keep ids positive on 31 bits
+   if (++_sequence > 0x7FFFFFFF / SIO_MAX_PENDING_ACKS) {
+      _sequence = 0;
+   }
+   slot.id = (int32_t)(_sequence * SIO_MAX_PENDING_ACKS + index);
+   slot.handler = std::move(handler);
+   slot.expires = timeout > 0;
+   slot.deadline = now + timeout;
+
+   if (slot.expires && (!_hasDeadline || (int32_t)(slot.deadline - _nextDeadline) < 0)) {
+      _hasDeadline = true;
+      _nextDeadline = slot.deadline;
+   }
+   return slot.id;
+}
+
+/**
+ * @brief Free the slot of an ack without calling its handler (the packet
+ * could not be sent)
+ *
+ * @param id int32_t
+ * @return bool false if the id is not pending
+ */
+bool SocketIOAckPool::release(int32_t id) {
+   Slot *slot = find(id);
+   if (!slot) {
+      return false;
+   }
+   take(*slot);
+   return true;
+}
+
+/**
+ * @brief Deliver the server's ack to its handler
+ *
+ * @param id int32_t
+ * @param payload const char *
+ * @param length size_t
+ * @return bool false if the id is not pending (unknown, late or duplicated ack)
+ */
+bool SocketIOAckPool::resolve(int32_t id, const char *payload, size_t length) {
+   Slot *slot = find(id);
+   if (!slot) {
+      return false;
+   }
+   // The slot is free before the handler runs: it may emit with ack again
+   SocketIOAckHandler handler = take(*slot);
+   if (handler) {
+      handler(payload, length);
+   }
+   return true;
+}
+
+/**
+ * @brief Time out the acks whose deadline passed. Cheap to call from every
+ * loop(): the slots are only scanned once the earliest deadline is reached.
+ *
+ * @param now uint32_t millis()
+ */
+void SocketIOAckPool::sweep(uint32_t now) {
+   if (!_hasDeadline || (int32_t)(now - _nextDeadline) < 0) {
+      return;
+   }
+
+   _hasDeadline = false;
+   for (uint8_t i = 0; i < SIO_MAX_PENDING_ACKS; i++) {
+      Slot &slot = _slots[i];
+      if (slot.id < 0 || !slot.expires) {
+         continue;
+      }
+      if ((int32_t)(now - slot.deadline) >= 0) {
+         SocketIOAckHandler handler = take(slot);
+         if (handler) {
+            handler(NULL, 0);
+         }
+      } else if (!_hasDeadline || (int32_t)(slot.deadline - _nextDeadline) < 0) {
+         _hasDeadline = true;
+         _nextDeadline = slot.deadline;
+      }
+   }
+}
+
+/**
+ * @brief Fail every pending ack (connection lost: the server will not answer
+ * them)
+ *
+ */
+void SocketIOAckPool::clear(void) {
+   _hasDeadline = false;
+   for (uint8_t i = 0; i < SIO_MAX_PENDING_ACKS; i++) {
+      if (_slots[i].id >= 0) {
+         SocketIOAckHandler handler = take(_slots[i]);
+         if (handler) {
+            handler(NULL, 0);
+         }
+      }
+   }
+}
+
+/**
+ * @brief Get the pending slot of an id
+ *
+ * @param id int32_t
+ * @return Slot * NULL if the id is not pending
+ */
+SocketIOAckPool::Slot *SocketIOAckPool::find(int32_t id) {
+   if (id < 0) {
+      return NULL;
+   }
+   Slot &slot = _slots[id % SIO_MAX_PENDING_ACKS];
+   return slot.id == id ? &slot : NULL;
+}
+
+/**
+ * @brief Free a slot
+ *
+ * @param slot Slot &
+ * @return SocketIOAckHandler the handler it held
+ */
+SocketIOAckHandler SocketIOAckPool::take(Slot &slot) {
+   SocketIOAckHandler handler = std::move(slot.handler);
+   slot.handler = nullptr;
+   slot.id = -1;
+   _free[_freeCount++] = &slot - _slots;
+   return handler;
+}
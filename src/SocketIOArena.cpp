@@ -0,0 +1,97 @@
+/*
+ * SocketIOArena.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOArena.h"
+
+#include <stdlib.h>
+
+#define SIO_ARENA_ALIGN 4
+
+SocketIOArena::SocketIOArena() {}
+
+SocketIOArena::~SocketIOArena() { end(); }
+
+/**
+ * @brief Allocate the region on the heap. This is the only heap allocation of
+ * the arena.
+ *
+ * @param capacity size_t
+ * @return bool false if the allocation failed
+ */
+bool SocketIOArena::begin(size_t capacity) {
+   end();
+   capacity &= ~(size_t)(SIO_ARENA_ALIGN - 1);
+   if (capacity == 0) {
+      return false;
+   }
+   _buffer = (uint8_t *)malloc(capacity);
+   if (!_buffer) {
+      return false;
+   }
+   _capacity = capacity;
+   _owned = true;
+   return true;
+}
+
+/**
+ * @brief Use a buffer owned by the caller (e.g. a static array). It must
+ * outlive the arena.
+ *
+ * @param buffer uint8_t *
+ * @param capacity size_t
+ * @return bool
+ */
+bool SocketIOArena::begin(uint8_t *buffer, size_t capacity) {
+   end();
+   if (!buffer) {
+      return false;
+   }
+   // Keep every block aligned even if the caller's buffer is not
+   size_t skew = (SIO_ARENA_ALIGN - ((uintptr_t)buffer % SIO_ARENA_ALIGN)) % SIO_ARENA_ALIGN;
+   if (skew >= capacity) {
+      return false;
+   }
+   _buffer = buffer + skew;
+   _capacity = (capacity - skew) & ~(size_t)(SIO_ARENA_ALIGN - 1);
+   _owned = false;
+   return true;
+}
+
+/**
+ * @brief Release the region if it was allocated by begin(size_t)
+ *
+ */
+void SocketIOArena::end(void) {
+   if (_owned) {
+      free(_buffer);
+   }
+   _buffer = NULL;
+   _capacity = 0;
+   _used = 0;
+   _owned = false;
+}
+
+/**
+ * @brief Carve a block from the region
+ *
+ * @param size size_t
+ * @return uint8_t * NULL if the arena is not ready or too small
+ */
+uint8_t *SocketIOArena::allocate(size_t size) {
+   size = (size + SIO_ARENA_ALIGN - 1) & ~(size_t)(SIO_ARENA_ALIGN - 1);
+   if (!_buffer || size > available()) {
+      return NULL;
+   }
+   uint8_t *block = _buffer + _used;
+   _used += size;
+   return block;
+}
+
+/**
+ * @brief Give every block back to the arena
+ *
+ */
+void SocketIOArena::reset(void) { _used = 0; }
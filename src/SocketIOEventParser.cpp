@@ -0,0 +1,759 @@
+/*
+ * SocketIOEventParser.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOEventParser.h"
+
+#include <string.h>
+
+static bool isHex(char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+static const char *skipDigits(const char *p, const char *end) {
+   while (p < end && isDigit(*p)) {
+      p++;
+   }
+   return p;
+}
+
+static uint16_t hexValue(const char *p) {
+   uint16_t value = 0;
+   for (uint8_t i = 0; i < 4; i++) {
+      char c = p[i];
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+         value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+         value |= c - 'a' + 10;
+      } else {
+         value |= c - 'A' + 10;
+      }
+   }
+   return value;
+}
+
+// Append a code point in UTF-8 at out[n], or only count it when out is NULL
+static size_t writeUtf8(char *out, size_t n, uint32_t codepoint) {
+   char bytes[4];
+   size_t count;
+   if (codepoint < 0x80) {
+      bytes[0] = (char)codepoint;
+      count = 1;
+   } else if (codepoint < 0x800) {
+      bytes[0] = (char)(0xC0 | (codepoint >> 6));
+      bytes[1] = (char)(0x80 | (codepoint & 0x3F));
+      count = 2;
+   } else if (codepoint < 0x10000) {
+      bytes[0] = (char)(0xE0 | (codepoint >> 12));
+      bytes[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+      bytes[2] = (char)(0x80 | (codepoint & 0x3F));
+      count = 3;
+   } else {
+      bytes[0] = (char)(0xF0 | (codepoint >> 18));
+      bytes[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+      bytes[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+      bytes[3] = (char)(0x80 | (codepoint & 0x3F));
+      count = 4;
+   }
+   if (out) {
+      memcpy(out + n, bytes, count);
+   }
+   return n + count;
+}
+
+/**
+ * @brief Skip JSON whitespace
+ *
+ * @param p const char *
+ * @param end const char *
+ * @return const char * first non whitespace character or end
+ */
+const char *SocketIOEventParser::skipSpace(const char *p, const char *end) {
+   while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+      p++;
+   }
+   return p;
+}
+
+/**
+ * @brief Skip a JSON string. p must point to the opening quote.
+ *
+ * @param p const char *
+ * @param end const char *
+ * @return const char * character after the closing quote, NULL if the string
+ * is unterminated or has a broken escape sequence
+ */
+const char *SocketIOEventParser::skipString(const char *p, const char *end) {
+   p++;
+   while (p < end) {
+      if (*p == '"') {
+         return p + 1;
+      }
+      if (*p == '\\') {
+         if (p + 1 >= end) {
+            return NULL;
+         }
+         if (p[1] == 'u') {
+            if (p + 6 > end || !isHex(p[2]) || !isHex(p[3]) || !isHex(p[4]) || !isHex(p[5])) {
+               return NULL;
+            }
+            p += 6;
+         } else {
+            p += 2;
+         }
+      } else {
+         p++;
+      }
+   }
+   return NULL;
+}
+
+/**
+ * @brief Skip one JSON value (string, object, array or literal) without
+ * building it
+ *
+ * @param p const char *
+ * @param end const char *
+ * @return const char * character after the value, NULL if the value is
+ * malformed or runs past end
+ */
+const char *SocketIOEventParser::skipValue(const char *p, const char *end) {
+   if (p >= end) {
+      return NULL;
+   }
+
+   if (*p == '"') {
+      return skipString(p, end);
+   }
+
+   if (*p == '{' || *p == '[') {
+      size_t depth = 0;
+      while (p < end) {
+         char c = *p;
+         if (c == '"') {
+            p = skipString(p, end);
+            if (!p) {
+               return NULL;
+            }
+            continue;
+         }
+         if (c == '{' || c == '[') {
+            depth++;
+         } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+               return p + 1;
+            }
+         }
+         p++;
+      }
+      return NULL;
+   }
+
+   // Number, true, false or null
+   const char *start = p;
+   while (p < end && ((*p >= '0' && *p <= '9') || (*p >= 'a' && *p <= 'z') || *p == '-' || *p == '+' || *p == '.' || *p == 'E')) {
+      p++;
+   }
+   return p == start ? NULL : p;
+}
+
+/**
+ * @brief Check a JSON string strictly: no control character, only the escape
+ * sequences of RFC 8259. p must point to the opening quote.
+ *
+ * @param p const char *
+ * @param end const char *
+ * @return const char * character after the closing quote, NULL if malformed
+ */
+const char *SocketIOEventParser::checkString(const char *p, const char *end) {
+   for (p++; p < end; p++) {
+      unsigned char c = *p;
+      if (c == '"') {
+         return p + 1;
+      }
+      if (c < 0x20) {
+         return NULL;
+      }
+      if (c == '\\') {
+         if (++p >= end) {
+            return NULL;
+         }
+         if (*p == 'u') {
+            if (p + 5 > end || !isHex(p[1]) || !isHex(p[2]) || !isHex(p[3]) || !isHex(p[4])) {
+               return NULL;
+            }
+            p += 4;
+         } else if (!strchr("\"\\/bfnrt", *p)) {
+            return NULL;
+         }
+      }
+   }
+   return NULL;
+}
+
+/**
+ * @brief Check a JSON number or one of the literals true, false and null
+ *
+ * @param p const char *
+ * @param end const char *
+ * @return const char * character after it, NULL if malformed
+ */
+const char *SocketIOEventParser::checkScalar(const char *p, const char *end) {
+   static const char *literals[] = {"true", "false", "null"};
+   for (uint8_t i = 0; i < 3; i++) {
+      size_t length = strlen(literals[i]);
+      if ((size_t)(end - p) >= length && memcmp(p, literals[i], length) == 0) {
+         return p + length;
+      }
+   }
+
+   // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+   if (p < end && *p == '-') {
+      p++;
+   }
+   if (p < end && *p == '0') {
+      p++;
+   } else if (p < end && isDigit(*p)) {
+      p = skipDigits(p, end);
+   } else {
+      return NULL;
+   }
+   if (p < end && *p == '.') {
+      const char *digits = ++p;
+      if ((p = skipDigits(p, end)) == digits) {
+         return NULL;
+      }
+   }
+   if (p < end && (*p == 'e' || *p == 'E')) {
+      if (++p < end && (*p == '+' || *p == '-')) {
+         p++;
+      }
+      const char *digits = p;
+      if ((p = skipDigits(p, end)) == digits) {
+         return NULL;
+      }
+   }
+   return p;
+}
+
+/**
+ * @brief Check that text is exactly one JSON value, whitespace around it
+ * allowed. Unlike skipValue, brackets must match, literals and numbers follow
+ * the grammar and members are separated properly; nesting is limited to
+ * SIO_JSON_MAX_DEPTH levels.
+ *
+ * @param json const char *
+ * @param length size_t
+ * @return bool
+ */
+bool SocketIOEventParser::isJson(const char *json, size_t length) {
+   const char *end = json + length;
+   // One bit per open container, 1 for an object
+   uint32_t objects = 0;
+   uint8_t depth = 0;
+   bool member = false;
+
+   const char *p = skipSpace(json, end);
+   while (p < end) {
+      // In an object, the member name and ':' come first
+      if (member) {
+         p = *p == '"' ? checkString(p, end) : NULL;
+         p = p ? skipSpace(p, end) : NULL;
+         if (!p || p >= end || *p != ':') {
+            return false;
+         }
+         p = skipSpace(p + 1, end);
+         if (p >= end) {
+            return false;
+         }
+      }
+
+      if (*p == '{' || *p == '[') {
+         if (depth == SIO_JSON_MAX_DEPTH) {
+            return false;
+         }
+         bool object = *p == '{';
+         objects = (objects << 1) | object;
+         depth++;
+         p = skipSpace(p + 1, end);
+         if (p < end && *p != (object ? '}' : ']')) {
+            member = object;
+            continue;
+         }
+      } else {
+         p = *p == '"' ? checkString(p, end) : checkScalar(p, end);
+         if (!p) {
+            return false;
+         }
+         p = skipSpace(p, end);
+      }
+
+      // After a value: close containers, then ',' and the next value
+      while (depth && p < end && *p == ((objects & 1) ? '}' : ']')) {
+         objects >>= 1;
+         depth--;
+         p = skipSpace(p + 1, end);
+      }
+      if (!depth) {
+         return p == end;
+      }
+      if (p >= end || *p != ',') {
+         return false;
+      }
+      member = objects & 1;
+      p = skipSpace(p + 1, end);
+   }
+   return false;
+}
+
+/**
+ * @brief Decode the escape sequences of a JSON string content in place. The
+ * decoded string is never longer than the encoded one.
+ *
+ * @param str char * string content, without the quotes
+ * @param length size_t
+ * @return size_t length of the decoded string
+ */
+size_t SocketIOEventParser::unescape(char *str, size_t length) { return unescape(str, length, str); }
+
+/**
+ * @brief Decode the escape sequences of a JSON string content into out, which
+ * may be the string itself
+ *
+ * @param str const char * string content, without the quotes
+ * @param length size_t
+ * @param out char * NULL to only measure the decoded string
+ * @return size_t length of the decoded string
+ */
+size_t SocketIOEventParser::unescape(const char *str, size_t length, char *out) {
+   const char *in = str;
+   const char *end = str + length;
+   size_t n = 0;
+
+   while (in < end) {
+      if (*in != '\\') {
+         if (out) {
+            out[n] = *in;
+         }
+         n++;
+         in++;
+         continue;
+      }
+
+      char c = in[1];
+      in += 2;
+      switch (c) {
+      case 'b':
+         c = '\b';
+         break;
+      case 'f':
+         c = '\f';
+         break;
+      case 'n':
+         c = '\n';
+         break;
+      case 'r':
+         c = '\r';
+         break;
+      case 't':
+         c = '\t';
+         break;
+      case 'u': {
+         uint32_t codepoint = hexValue(in);
+         in += 4;
+         // Combine a surrogate pair into one code point
+         if (codepoint >= 0xD800 && codepoint < 0xDC00 && in + 6 <= end && in[0] == '\\' && in[1] == 'u') {
+            uint16_t low = hexValue(in + 2);
+            if (low >= 0xDC00 && low < 0xE000) {
+               codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+               in += 6;
+            }
+         }
+         n = writeUtf8(out, n, codepoint);
+      }
+         continue;
+      default:
+         // \" \\ \/ and anything else: keep the escaped character
+         break;
+      }
+      if (out) {
+         out[n] = c;
+      }
+      n++;
+   }
+
+   return n;
+}
+
+/**
+ * @brief Parse an event frame in a single pass: [/nsp,][ackId]["event",args...]
+ * (the Engine.IO / Socket.IO type characters already stripped). Nothing is
+ * allocated, the event name and the first argument are unescaped and
+ * terminated inside payload and frame points to them.
+ *
+ * @param payload uint8_t * modified in place
+ * @param length size_t
+ * @param frame SocketIOEventFrame &
+ * @return socketIOparseError_t sIOparse_OK on success
+ */
+socketIOparseError_t SocketIOEventParser::parseEvent(uint8_t *payload, size_t length, SocketIOEventFrame &frame) { return parse(payload, length, frame, true); }
+
+/**
+ * @brief Parse an ack frame the same way: [/nsp,]ackId[args...]. frame.event
+ * stays NULL.
+ *
+ * @param payload uint8_t * modified in place
+ * @param length size_t
+ * @param frame SocketIOEventFrame &
+ * @return socketIOparseError_t sIOparse_MISSING_ACK_ID if the frame has no ack
+ * id
+ */
+socketIOparseError_t SocketIOEventParser::parseAck(uint8_t *payload, size_t length, SocketIOEventFrame &frame) {
+   socketIOparseError_t err = parse(payload, length, frame, false);
+   if (err == sIOparse_OK && frame.ackId < 0) {
+      return sIOparse_MISSING_ACK_ID;
+   }
+   return err;
+}
+
+/**
+ * @brief Walk [/nsp,][ackId][ , the start of every event and ack frame
+ *
+ * @param p const char *& moved after the '[' and the whitespace that follows
+ * @param end const char *
+ * @param frame SocketIOEventFrame & reset, namespace and ack id set
+ * @return socketIOparseError_t
+ */
+socketIOparseError_t SocketIOEventParser::parseHead(const char *&p, const char *end, SocketIOEventFrame &frame) {
+   frame.nsp = "/";
+   frame.nspLength = 1;
+   frame.ackId = -1;
+   frame.event = NULL;
+   frame.eventLength = 0;
+   frame.data = "";
+   frame.dataLength = 0;
+   frame.argc = 0;
+   frame.last = "";
+   frame.lastLength = 0;
+
+   if (!p || p >= end) {
+      return sIOparse_EMPTY;
+   }
+
+   // Namespace prefix: /nsp,
+   if (*p == '/') {
+      const char *nsp = p;
+      while (p < end && *p != ',') {
+         if (*p == '[') {
+            return sIOparse_BAD_NAMESPACE;
+         }
+         p++;
+      }
+      if (p >= end) {
+         return sIOparse_BAD_NAMESPACE;
+      }
+      frame.nsp = nsp;
+      frame.nspLength = p - nsp;
+      p++;
+   }
+
+   // Ack id
+   if (p < end && *p >= '0' && *p <= '9') {
+      uint32_t id = 0;
+      while (p < end && *p >= '0' && *p <= '9') {
+         id = id * 10 + (*p - '0');
+         if (id > 0x7FFFFFFF) {
+            return sIOparse_BAD_ACK_ID;
+         }
+         p++;
+      }
+      frame.ackId = (int32_t)id;
+   }
+
+   p = skipSpace(p, end);
+   if (p >= end) {
+      return sIOparse_EMPTY;
+   }
+   if (*p != '[') {
+      return sIOparse_NOT_ARRAY;
+   }
+   p = skipSpace(p + 1, end);
+
+   return sIOparse_OK;
+}
+
+/**
+ * @brief Parse the start of an event whose end has not arrived yet, the first
+ * fragment of a large message: [/nsp,][ackId]["event",... Nothing is
+ * modified: frame.event points to the name as received (not unescaped nor
+ * terminated) and frame.data to the argument text that follows, up to the
+ * end of payload.
+ *
+ * @param payload const uint8_t *
+ * @param length size_t
+ * @param frame SocketIOEventFrame &
+ * @return socketIOparseError_t sIOparse_UNTERMINATED if the event name and
+ * the separator after it are not all there
+ */
+socketIOparseError_t SocketIOEventParser::parseEventHead(const uint8_t *payload, size_t length, SocketIOEventFrame &frame) {
+   const char *p = (const char *)payload;
+   const char *end = p + length;
+
+   socketIOparseError_t err = parseHead(p, end, frame);
+   if (err != sIOparse_OK) {
+      return err;
+   }
+   if (p >= end || *p != '"') {
+      return p >= end ? sIOparse_UNTERMINATED : sIOparse_BAD_EVENT_NAME;
+   }
+   const char *event = p + 1;
+   p = skipString(p, end);
+   if (!p) {
+      return sIOparse_UNTERMINATED;
+   }
+   frame.event = event;
+   frame.eventLength = p - 1 - event;
+
+   p = skipSpace(p, end);
+   if (p >= end) {
+      return sIOparse_UNTERMINATED;
+   }
+   if (*p == ',') {
+      p = skipSpace(p + 1, end);
+   } else if (*p != ']') {
+      return sIOparse_BAD_ARGUMENT;
+   }
+   frame.data = p;
+   frame.dataLength = end - p;
+   return sIOparse_OK;
+}
+
+/**
+ * @brief Walk [/nsp,][ackId][("event",)args...] once
+ *
+ * @param payload uint8_t * modified in place
+ * @param length size_t
+ * @param frame SocketIOEventFrame &
+ * @param named bool whether the array starts with an event name
+ * @return socketIOparseError_t
+ */
+socketIOparseError_t SocketIOEventParser::parse(uint8_t *payload, size_t length, SocketIOEventFrame &frame, bool named) {
+   const char *p = (const char *)payload;
+   const char *end = p + length;
+
+   socketIOparseError_t err = parseHead(p, end, frame);
+   if (err != sIOparse_OK) {
+      return err;
+   }
+
+   // Event name
+   char *event = NULL;
+   size_t eventLength = 0;
+   if (named) {
+      if (p >= end || *p != '"') {
+         return sIOparse_BAD_EVENT_NAME;
+      }
+      event = (char *)p + 1;
+      p = skipString(p, end);
+      if (!p) {
+         return sIOparse_BAD_EVENT_NAME;
+      }
+      eventLength = p - 1 - event;
+      p = skipSpace(p, end);
+   }
+
+   // Arguments: only the first one is kept, the others are validated and skipped
+   char *data = NULL;
+   size_t dataLength = 0;
+   bool dataIsString = false;
+   uint16_t argc = 0;
+
+   // Without an event name the first argument has no leading ','
+   bool separated = !named && p < end && *p != ']';
+   while (p < end && (separated || *p == ',')) {
+      p = skipSpace(separated ? p : p + 1, end);
+      separated = false;
+      const char *value = p;
+      if (value >= end) {
+         return sIOparse_UNTERMINATED;
+      }
+      p = skipValue(value, end);
+      if (!p) {
+         return sIOparse_BAD_ARGUMENT;
+      }
+      if (argc == 0) {
+         dataIsString = *value == '"';
+         data = (char *)value + (dataIsString ? 1 : 0);
+         dataLength = (p - value) - (dataIsString ? 2 : 0);
+      }
+      frame.last = value;
+      frame.lastLength = p - value;
+      if (argc < 255) {
+         argc++;
+      }
+      p = skipSpace(p, end);
+   }
+
+   if (p >= end) {
+      return sIOparse_UNTERMINATED;
+   }
+   if (*p != ']') {
+      return sIOparse_BAD_ARGUMENT;
+   }
+
+   // The walk is done, decode in place. Terminators always land on a quote or
+   // on the separator that follows the value.
+   if (event) {
+      eventLength = unescape(event, eventLength);
+      event[eventLength] = '\0';
+      frame.event = event;
+      frame.eventLength = eventLength;
+   }
+
+   if (data) {
+      if (dataIsString) {
+         dataLength = unescape(data, dataLength);
+      }
+      data[dataLength] = '\0';
+      frame.data = data;
+      frame.dataLength = dataLength;
+   }
+   frame.argc = (uint8_t)argc;
+
+   return sIOparse_OK;
+}
+
+/**
+ * @brief Find a member of a flat JSON object, such as the "pingInterval" of
+ * the Engine.IO OPEN packet
+ *
+ * @param json const char *
+ * @param length size_t
+ * @param key const char *
+ * @param valueLength size_t * length of the value found
+ * @return const char * raw JSON text of the value (not terminated), NULL if
+ * there is no such member
+ */
+const char *SocketIOEventParser::findMember(const char *json, size_t length, const char *key, size_t *valueLength) {
+   const char *end = json + length;
+   const char *p = skipSpace(json, end);
+   if (p >= end || *p != '{') {
+      return NULL;
+   }
+   size_t keyLength = strlen(key);
+   p = skipSpace(p + 1, end);
+   while (p < end && *p == '"') {
+      const char *name = p + 1;
+      p = skipString(p, end);
+      if (!p) {
+         return NULL;
+      }
+      bool found = (size_t)(p - 1 - name) == keyLength && memcmp(name, key, keyLength) == 0;
+      p = skipSpace(p, end);
+      if (p >= end || *p != ':') {
+         return NULL;
+      }
+      const char *value = skipSpace(p + 1, end);
+      p = skipValue(value, end);
+      if (!p) {
+         return NULL;
+      }
+      if (found) {
+         *valueLength = p - value;
+         return value;
+      }
+      p = skipSpace(p, end);
+      if (p >= end || *p != ',') {
+         return NULL;
+      }
+      p = skipSpace(p + 1, end);
+   }
+   return NULL;
+}
+
+/**
+ * @brief Find a string member of a flat JSON object, such as the "pid" of
+ * {"sid":"...","pid":"..."}
+ *
+ * @param json const char *
+ * @param length size_t
+ * @param key const char *
+ * @param valueLength size_t * length of the value found
+ * @return const char * content of the string (not terminated, not
+ * unescaped), NULL if there is no such member or it is not a string
+ */
+const char *SocketIOEventParser::findString(const char *json, size_t length, const char *key, size_t *valueLength) {
+   const char *value = findMember(json, length, key, valueLength);
+   if (!value || *value != '"') {
+      return NULL;
+   }
+   *valueLength -= 2;
+   return value + 1;
+}
+
+/**
+ * @brief Find a number member of a flat JSON object
+ *
+ * @param json const char *
+ * @param length size_t
+ * @param key const char *
+ * @param value uint32_t * left as it is if the member is missing
+ * @return bool false if there is no such member or it is not a positive
+ * integer
+ */
+bool SocketIOEventParser::findNumber(const char *json, size_t length, const char *key, uint32_t *value) {
+   size_t valueLength;
+   const char *p = findMember(json, length, key, &valueLength);
+   if (!p || !valueLength || valueLength > 10) {
+      return false;
+   }
+   uint64_t number = 0;
+   for (size_t i = 0; i < valueLength; i++) {
+      if (p[i] < '0' || p[i] > '9') {
+         return false;
+      }
+      number = number * 10 + (p[i] - '0');
+   }
+   if (number > 0xFFFFFFFF) {
+      return false;
+   }
+   *value = (uint32_t)number;
+   return true;
+}
+
+/**
+ * @brief Get a readable name of a parse error
+ *
+ * @param error socketIOparseError_t
+ * @return const char *
+ */
+const char *SocketIOEventParser::errorToString(socketIOparseError_t error) {
+   switch (error) {
+   case sIOparse_OK:
+      return "ok";
+   case sIOparse_EMPTY:
+      return "empty frame";
+   case sIOparse_BAD_NAMESPACE:
+      return "bad namespace";
+   case sIOparse_BAD_ACK_ID:
+      return "bad ack id";
+   case sIOparse_NOT_ARRAY:
+      return "not an array";
+   case sIOparse_BAD_EVENT_NAME:
+      return "bad event name";
+   case sIOparse_BAD_ARGUMENT:
+      return "bad argument";
+   case sIOparse_UNTERMINATED:
+      return "unterminated array";
+   case sIOparse_MISSING_ACK_ID:
+      return "missing ack id";
+   case sIOparse_BAD_ATTACHMENTS:
+      return "bad attachments";
+   case sIOparse_BAD_PACKET:
+      return "bad packet";
+   }
+   return "unknown";
+}
@@ -0,0 +1,406 @@
+/*
+ * SocketIOEventRouter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOEventRouter.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+// Listener slots allocated by the first add(), doubled when full
+#define SIO_ROUTER_HANDLERS 4
+
+SocketIOEventRouter::SocketIOEventRouter() {}
+
+SocketIOEventRouter::~SocketIOEventRouter() {
+   free(_nodes);
+   free(_labels);
+   delete[] _handlers;
+}
+
+// A "*" making up a whole segment of the pattern
+static bool isWildcard(const char *pattern, const char *p) { return *p == '*' && (p == pattern || p[-1] == '/') && (p[1] == '/' || p[1] == '\0'); }
+
+/**
+ * @brief Add a route, or replace the listener of a pattern already routed
+ *
+ * @param pattern const char * copied
+ * @param handler SocketIORouteHandler
+ * @return bool false if the pattern is empty or memory is exhausted
+ */
+bool SocketIOEventRouter::add(const char *pattern, SocketIORouteHandler handler) {
+   if (!*pattern || !handler) {
+      return false;
+   }
+   uint16_t node = walk(pattern, true);
+   if (node == SIO_ROUTE_NONE) {
+      return false;
+   }
+   if (_nodes[node].route != SIO_ROUTE_NONE) {
+      changed(_nodes[node].route);
+      _handlers[_nodes[node].route] = handler;
+      return true;
+   }
+
+   // Slots of removed routes are used again, not those of running listeners
+   size_t slot = 0;
+   while (slot < _handlerCapacity && (_handlers[slot] || isRunning(slot))) {
+      slot++;
+   }
+   if (slot == _handlerCapacity) {
+      size_t capacity = _handlerCapacity ? _handlerCapacity * 2 : SIO_ROUTER_HANDLERS;
+      SocketIORouteHandler *handlers = new (std::nothrow) SocketIORouteHandler[capacity];
+      if (!handlers || capacity >= SIO_ROUTE_NONE) {
+         delete[] handlers;
+         return false;
+      }
+      for (size_t i = 0; i < _handlerCapacity; i++) {
+         handlers[i] = std::move(_handlers[i]);
+      }
+      delete[] _handlers;
+      _handlers = handlers;
+      _handlerCapacity = capacity;
+   }
+   _handlers[slot] = handler;
+   _nodes[node].route = slot;
+   _count++;
+   return true;
+}
+
+/**
+ * @brief Remove the route of a pattern. Its nodes stay until clear().
+ *
+ * @param pattern const char * as given to add
+ * @return bool false if the pattern is not routed
+ */
+bool SocketIOEventRouter::remove(const char *pattern) {
+   uint16_t node = *pattern ? walk(pattern, false) : SIO_ROUTE_NONE;
+   if (node == SIO_ROUTE_NONE || _nodes[node].route == SIO_ROUTE_NONE) {
+      return false;
+   }
+   changed(_nodes[node].route);
+   _handlers[_nodes[node].route] = nullptr;
+   _nodes[node].route = SIO_ROUTE_NONE;
+   _count--;
+   return true;
+}
+
+/**
+ * @brief Remove every route. The memory is kept for the next add().
+ *
+ */
+void SocketIOEventRouter::clear(void) {
+   for (size_t i = 0; i < _handlerCapacity; i++) {
+      _handlers[i] = nullptr;
+   }
+   for (Running *running = _running; running; running = running->outer) {
+      running->changed = true;
+   }
+   _nodeCount = 0;
+   _labelLength = 0;
+   _count = 0;
+}
+
+/**
+ * @brief Get the listener of the most specific route matching an event
+ *
+ * @param event const char *
+ * @param length size_t
+ * @return SocketIORouteHandler * NULL if no route matches
+ */
+SocketIORouteHandler *SocketIOEventRouter::find(const char *event, size_t length) const {
+   if (!_count || !length) {
+      return NULL;
+   }
+   uint16_t route = match(0, event, 0, length);
+   return route != SIO_ROUTE_NONE ? &_handlers[route] : NULL;
+}
+
+/**
+ * @brief Call the listener of the most specific route matching an event. The
+ * listener is moved out of its slot while it runs, so it may add, replace or
+ * remove routes, itself included.
+ *
+ * @param event const char * null terminated
+ * @param payload const char *
+ * @param length size_t
+ * @return bool false if no route matches
+ */
+bool SocketIOEventRouter::dispatch(const char *event, const char *payload, size_t length) {
+   if (!_count || !*event) {
+      return false;
+   }
+   uint16_t route = match(0, event, 0, strlen(event));
+   // Empty while its listener runs: not called again from inside it
+   if (route == SIO_ROUTE_NONE || !_handlers[route]) {
+      return false;
+   }
+
+   Running running = {route, false, _running};
+   _running = &running;
+   SocketIORouteHandler handler = std::move(_handlers[route]);
+   _handlers[route] = nullptr;
+   handler(event, payload, length);
+   _running = running.outer;
+   if (!running.changed) {
+      _handlers[route] = std::move(handler);
+   }
+   return true;
+}
+
+/**
+ * @brief Check whether the listener of a slot is running, moved out of it
+ *
+ * @param route uint16_t
+ * @return bool
+ */
+bool SocketIOEventRouter::isRunning(uint16_t route) const {
+   for (const Running *running = _running; running; running = running->outer) {
+      if (running->route == route) {
+         return true;
+      }
+   }
+   return false;
+}
+
+/**
+ * @brief Keep the running listeners of a slot from being put back over the
+ * listener that replaced them, or in a removed route
+ *
+ * @param route uint16_t
+ */
+void SocketIOEventRouter::changed(uint16_t route) {
+   for (Running *running = _running; running; running = running->outer) {
+      if (running->route == route) {
+         running->changed = true;
+      }
+   }
+}
+
+/**
+ * @brief Bytes held by the router: nodes, labels and listener slots
+ *
+ * @return size_t
+ */
+size_t SocketIOEventRouter::memoryUsage(void) const { return _nodeCapacity * sizeof(Node) + _labelCapacity + _handlerCapacity * sizeof(SocketIORouteHandler); }
+
+/**
+ * @brief Follow a pattern down the trie, one literal run or wildcard at a
+ * time
+ *
+ * @param pattern const char *
+ * @param insert bool add the nodes missing
+ * @return uint16_t node where the pattern ends, SIO_ROUTE_NONE if it is not
+ * there (or memory is exhausted)
+ */
+uint16_t SocketIOEventRouter::walk(const char *pattern, bool insert) {
+   if (!_nodeCount) {
+      if (!insert || !reserve(1, 0)) {
+         return SIO_ROUTE_NONE;
+      }
+      newNode(SIO_ROUTE_NONE, 0, 0, false);
+   }
+
+   uint16_t node = 0;
+   const char *p = pattern;
+   while (*p && node != SIO_ROUTE_NONE) {
+      if (isWildcard(pattern, p)) {
+         node = wildcard(node, insert);
+         p++;
+         continue;
+      }
+      const char *end = p + 1;
+      while (*end && !isWildcard(pattern, end)) {
+         end++;
+      }
+      node = literal(node, p, end - p, insert);
+      p = end;
+   }
+   return node;
+}
+
+/**
+ * @brief Follow a literal run, splitting the label it leaves in the middle
+ *
+ * @param node uint16_t
+ * @param str const char *
+ * @param length size_t
+ * @param insert bool
+ * @return uint16_t node where the run ends
+ */
+uint16_t SocketIOEventRouter::literal(uint16_t node, const char *str, size_t length, bool insert) {
+   while (length) {
+      uint16_t child = _nodes[node].child;
+      while (child != SIO_ROUTE_NONE && (_nodes[child].wildcard || _labels[_nodes[child].label] != *str)) {
+         child = _nodes[child].sibling;
+      }
+
+      if (child == SIO_ROUTE_NONE) {
+         size_t part = length < 255 ? length : 255;
+         if (!insert || !reserve(_nodeCount + 1, _labelLength + part)) {
+            return SIO_ROUTE_NONE;
+         }
+         memcpy(_labels + _labelLength, str, part);
+         node = newNode(node, _labelLength, part, false);
+         _labelLength += part;
+         str += part;
+         length -= part;
+         continue;
+      }
+
+      size_t common = 0;
+      while (common < _nodes[child].length && common < length && _labels[_nodes[child].label + common] == str[common]) {
+         common++;
+      }
+      if (common < _nodes[child].length) {
+         if (!insert || !reserve(_nodeCount + 1, _labelLength)) {
+            return SIO_ROUTE_NONE;
+         }
+         // The end of the label moves to a node of its own, below
+         uint16_t tail = _nodeCount++;
+         Node &head = _nodes[child];
+         _nodes[tail].label = head.label + common;
+         _nodes[tail].length = head.length - common;
+         _nodes[tail].wildcard = 0;
+         _nodes[tail].child = head.child;
+         _nodes[tail].sibling = SIO_ROUTE_NONE;
+         _nodes[tail].route = head.route;
+         head.length = common;
+         head.child = tail;
+         head.route = SIO_ROUTE_NONE;
+      }
+      node = child;
+      str += common;
+      length -= common;
+   }
+   return node;
+}
+
+/**
+ * @brief Follow the wildcard child of a node
+ *
+ * @param node uint16_t
+ * @param insert bool
+ * @return uint16_t
+ */
+uint16_t SocketIOEventRouter::wildcard(uint16_t node, bool insert) {
+   for (uint16_t child = _nodes[node].child; child != SIO_ROUTE_NONE; child = _nodes[child].sibling) {
+      if (_nodes[child].wildcard) {
+         return child;
+      }
+   }
+   if (!insert || !reserve(_nodeCount + 1, _labelLength)) {
+      return SIO_ROUTE_NONE;
+   }
+   return newNode(node, 0, 0, true);
+}
+
+/**
+ * @brief Append a node, first child of its parent
+ *
+ * @param parent uint16_t SIO_ROUTE_NONE for the root
+ * @param label uint16_t
+ * @param length size_t
+ * @param wildcard bool
+ * @return uint16_t
+ */
+uint16_t SocketIOEventRouter::newNode(uint16_t parent, uint16_t label, size_t length, bool wildcard) {
+   uint16_t node = _nodeCount++;
+   _nodes[node].label = label;
+   _nodes[node].length = length;
+   _nodes[node].wildcard = wildcard;
+   _nodes[node].child = SIO_ROUTE_NONE;
+   _nodes[node].sibling = SIO_ROUTE_NONE;
+   _nodes[node].route = SIO_ROUTE_NONE;
+   if (parent != SIO_ROUTE_NONE) {
+      _nodes[node].sibling = _nodes[parent].child;
+      _nodes[parent].child = node;
+   }
+   return node;
+}
+
+/**
+ * @brief Match the end of an event name below a node: the literal child
+ * first, then the wildcard, as one segment then as the rest of the name
+ *
+ * @param node uint16_t
+ * @param event const char *
+ * @param pos size_t
+ * @param length size_t
+ * @return uint16_t listener slot, SIO_ROUTE_NONE if nothing matches
+ */
+uint16_t SocketIOEventRouter::match(uint16_t node, const char *event, size_t pos, size_t length) const {
+   if (pos == length) {
+      return _nodes[node].route;
+   }
+
+   uint16_t any = SIO_ROUTE_NONE;
+   for (uint16_t child = _nodes[node].child; child != SIO_ROUTE_NONE; child = _nodes[child].sibling) {
+      const Node &n = _nodes[child];
+      if (n.wildcard) {
+         any = child;
+      } else if (_labels[n.label] == event[pos] && n.length <= length - pos && memcmp(_labels + n.label, event + pos, n.length) == 0) {
+         uint16_t route = match(child, event, pos + n.length, length);
+         if (route != SIO_ROUTE_NONE) {
+            return route;
+         }
+      }
+   }
+   if (any == SIO_ROUTE_NONE) {
+      return SIO_ROUTE_NONE;
+   }
+
+   size_t end = pos;
+   while (end < length && event[end] != '/') {
+      end++;
+   }
+   if (end == pos) {
+      return SIO_ROUTE_NONE;
+   }
+   uint16_t route = match(any, event, end, length);
+   return route != SIO_ROUTE_NONE ? route : _nodes[any].route;
+}
+
+/**
+ * @brief Make room for nodes and label characters, doubling the arrays
+ *
+ * @param nodes size_t
+ * @param labels size_t
+ * @return bool false if the allocation failed or the indexes would overflow
+ */
+bool SocketIOEventRouter::reserve(size_t nodes, size_t labels) {
+   if (nodes >= SIO_ROUTE_NONE || labels > SIO_ROUTE_NONE) {
+      return false;
+   }
+   if (nodes > _nodeCapacity) {
+      size_t capacity = _nodeCapacity ? _nodeCapacity : SIO_ROUTER_NODES;
+      while (capacity < nodes) {
+         capacity *= 2;
+      }
+      if (capacity >= SIO_ROUTE_NONE) {
+         capacity = SIO_ROUTE_NONE - 1;
+      }
+      Node *grown = (Node *)realloc(_nodes, capacity * sizeof(Node));
+      if (!grown) {
+         return false;
+      }
+      _nodes = grown;
+      _nodeCapacity = capacity;
+   }
+   if (labels > _labelCapacity) {
+      size_t capacity = _labelCapacity ? _labelCapacity : SIO_ROUTER_LABELS;
+      while (capacity < labels) {
+         capacity *= 2;
+      }
+      char *grown = (char *)realloc(_labels, capacity);
+      if (!grown) {
+         return false;
+      }
+      _labels = grown;
+      _labelCapacity = capacity;
+   }
+   return true;
+}
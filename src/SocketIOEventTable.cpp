@@ -0,0 +1,324 @@
+/*
+ * SocketIOEventTable.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOEventTable.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+SocketIOEventTable::SocketIOEventTable() {}
+
+SocketIOEventTable::~SocketIOEventTable() {
+   _dispatching = 0;
+   while (_pending) {
+      Pending *pending = _pending;
+      _pending = pending->next;
+      if (pending->ownsName) {
+         free((void *)pending->name);
+      }
+      delete pending;
+   }
+   clear();
+   delete[] _slots;
+}
+
+/**
+ * @brief Runtime version of SocketIOEvent::hashOf
+ *
+ * @param name const char *
+ * @return uint32_t
+ */
+uint32_t SocketIOEventTable::hash(const char *name) {
+   uint32_t hash = SIO_HASH_OFFSET;
+   while (*name) {
+      hash = (hash ^ (uint8_t)*name++) * SIO_HASH_PRIME;
+   }
+   return hash;
+}
+
+/**
+ * @brief Find the slot of an event, or the slot where it would be inserted
+ * (the first tombstone met, else the empty slot ending the probe chain)
+ *
+ * @param event const SocketIOEvent &
+ * @return Slot * NULL if the table has no slot
+ */
+SocketIOEventTable::Slot *SocketIOEventTable::lookup(const SocketIOEvent &event) const {
+   if (!_slots) {
+      return NULL;
+   }
+
+   size_t mask = _capacity - 1;
+   Slot *insertAt = NULL;
+   for (size_t i = event.hash & mask;; i = (i + 1) & mask) {
+      Slot &slot = _slots[i];
+      if (slot.state == sIOslot_EMPTY) {
+         return insertAt ? insertAt : &slot;
+      }
+      if (slot.state == sIOslot_REMOVED) {
+         if (!insertAt) {
+            insertAt = &slot;
+         }
+      } else if (slot.hash == event.hash && strcmp(slot.name, event.name) == 0) {
+         return &slot;
+      }
+   }
+}
+
+/**
+ * @brief Add a handler, or replace the handler of an event already in the
+ * table
+ *
+ * @param event const SocketIOEvent &
+ * @param handler SocketIOEventHandler
+ * @param copyName bool false to keep the pointer to the name (literal)
+ * @return bool false if memory is exhausted
+ */
+bool SocketIOEventTable::set(const SocketIOEvent &event, SocketIOEventHandler handler, bool copyName) {
+   if (_dispatching) {
+      return defer(sIOpending_SET, &event, &handler, copyName);
+   }
+
+   // Keep at least one empty slot every 4 so probe chains stay short and end
+   if (!_slots || (_count + _removed + 1) * 4 > _capacity * 3) {
+      size_t capacity = _capacity ? _capacity : SIO_EVENT_TABLE_SIZE;
+      while ((_count + 1) * 4 > capacity * 3) {
+         capacity *= 2;
+      }
+      if (!grow(capacity)) {
+         return false;
+      }
+   }
+
+   Slot *slot = lookup(event);
+   if (slot->state == sIOslot_USED) {
+      slot->handler = handler;
+      return true;
+   }
+
+   const char *name = event.name;
+   if (copyName) {
+      name = strdup(event.name);
+      if (!name) {
+         return false;
+      }
+   }
+
+   if (slot->state == sIOslot_REMOVED) {
+      _removed--;
+   }
+   slot->hash = event.hash;
+   slot->state = sIOslot_USED;
+   slot->ownsName = copyName;
+   slot->name = name;
+   slot->handler = handler;
+   _count++;
+   return true;
+}
+
+/**
+ * @brief Remove the handler of an event
+ *
+ * @param event const SocketIOEvent &
+ * @return bool false if the event is not in the table
+ */
+bool SocketIOEventTable::remove(const SocketIOEvent &event) {
+   if (_dispatching) {
+      return find(event) && defer(sIOpending_REMOVE, &event, NULL, true);
+   }
+   Slot *slot = lookup(event);
+   if (!slot || slot->state != sIOslot_USED) {
+      return false;
+   }
+   release(*slot);
+   slot->state = sIOslot_REMOVED;
+   _count--;
+   _removed++;
+   return true;
+}
+
+/**
+ * @brief Remove every handler. The slot array is kept for the next on().
+ *
+ */
+void SocketIOEventTable::clear(void) {
+   if (_dispatching) {
+      defer(sIOpending_CLEAR, NULL, NULL, false);
+      return;
+   }
+   for (size_t i = 0; i < _capacity; i++) {
+      if (_slots[i].state == sIOslot_USED) {
+         release(_slots[i]);
+      }
+      _slots[i].state = sIOslot_EMPTY;
+   }
+   _count = 0;
+   _removed = 0;
+}
+
+/**
+ * @brief Get the handler of an event
+ *
+ * @param event const SocketIOEvent &
+ * @return SocketIOEventHandler * NULL if the event is not in the table
+ */
+SocketIOEventHandler *SocketIOEventTable::find(const SocketIOEvent &event) const {
+   Slot *slot = lookup(event);
+   return slot && slot->state == sIOslot_USED ? &slot->handler : NULL;
+}
+
+/**
+ * @brief Get the handler of an event, hashing its name at runtime
+ *
+ * @param name const char *
+ * @return SocketIOEventHandler * NULL if the event is not in the table
+ */
+SocketIOEventHandler *SocketIOEventTable::find(const char *name) const { return find(SocketIOEvent(name, hash(name))); }
+
+/**
+ * @brief Call the handler of an event. The table may be changed by the
+ * handler, see defer().
+ *
+ * @param event const SocketIOEvent &
+ * @param payload const char *
+ * @param length size_t
+ * @return bool false if the event is not in the table
+ */
+bool SocketIOEventTable::dispatch(const SocketIOEvent &event, const char *payload, size_t length) {
+   SocketIOEventHandler *handler = find(event);
+   if (!handler) {
+      return false;
+   }
+   _dispatching++;
+   (*handler)(payload, length);
+   if (--_dispatching == 0 && _pending) {
+      applyPending();
+   }
+   return true;
+}
+
+/**
+ * @brief Call the handler of an event, hashing its name at runtime
+ *
+ * @param name const char *
+ * @param payload const char *
+ * @param length size_t
+ * @return bool false if the event is not in the table
+ */
+bool SocketIOEventTable::dispatch(const char *name, const char *payload, size_t length) { return dispatch(SocketIOEvent(name, hash(name)), payload, length); }
+
+/**
+ * @brief Record a change made while a handler runs: growing the slot array or
+ * replacing or removing a handler now would move or destroy the running one
+ *
+ * @param op pendingOp_t
+ * @param event const SocketIOEvent * NULL for sIOpending_CLEAR
+ * @param handler SocketIOEventHandler * NULL but for sIOpending_SET
+ * @param copyName bool false to keep the pointer to the name (literal)
+ * @return bool false if memory is exhausted
+ */
+bool SocketIOEventTable::defer(pendingOp_t op, const SocketIOEvent *event, SocketIOEventHandler *handler, bool copyName) {
+   Pending *pending = new (std::nothrow) Pending();
+   if (!pending) {
+      return false;
+   }
+   pending->op = op;
+   if (event) {
+      pending->hash = event->hash;
+      pending->name = copyName ? strdup(event->name) : event->name;
+      pending->ownsName = copyName;
+      if (!pending->name) {
+         delete pending;
+         return false;
+      }
+   }
+   if (handler) {
+      pending->handler = *handler;
+   }
+
+   if (_pendingTail) {
+      _pendingTail->next = pending;
+   } else {
+      _pending = pending;
+   }
+   _pendingTail = pending;
+   return true;
+}
+
+/**
+ * @brief Apply the changes recorded while handlers ran
+ *
+ */
+void SocketIOEventTable::applyPending(void) {
+   while (_pending) {
+      Pending *pending = _pending;
+      _pending = pending->next;
+      if (!_pending) {
+         _pendingTail = NULL;
+      }
+
+      SocketIOEvent event(pending->name, pending->hash);
+      if (pending->op == sIOpending_SET) {
+         set(event, pending->handler, pending->ownsName);
+      } else if (pending->op == sIOpending_REMOVE) {
+         remove(event);
+      } else {
+         clear();
+      }
+      if (pending->ownsName) {
+         free((void *)pending->name);
+      }
+      delete pending;
+   }
+}
+
+/**
+ * @brief Move every handler to a new slot array, dropping the tombstones
+ *
+ * @param capacity size_t power of two
+ * @return bool false if the allocation failed
+ */
+bool SocketIOEventTable::grow(size_t capacity) {
+   Slot *slots = new (std::nothrow) Slot[capacity]();
+   if (!slots) {
+      return false;
+   }
+
+   Slot *old = _slots;
+   size_t oldCapacity = _capacity;
+   _slots = slots;
+   _capacity = capacity;
+   _removed = 0;
+
+   for (size_t i = 0; i < oldCapacity; i++) {
+      if (old[i].state == sIOslot_USED) {
+         Slot *slot = lookup(SocketIOEvent(old[i].name, old[i].hash));
+         slot->hash = old[i].hash;
+         slot->state = sIOslot_USED;
+         slot->ownsName = old[i].ownsName;
+         slot->name = old[i].name;
+         slot->handler = std::move(old[i].handler);
+      }
+   }
+
+   delete[] old;
+   return true;
+}
+
+/**
+ * @brief Free what a used slot owns
+ *
+ * @param slot Slot &
+ */
+void SocketIOEventTable::release(Slot &slot) {
+   if (slot.ownsName) {
+      free((void *)slot.name);
+   }
+   slot.ownsName = false;
+   slot.name = NULL;
+   slot.handler = nullptr;
+}
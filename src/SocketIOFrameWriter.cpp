@@ -0,0 +1,150 @@
+/*
+ * SocketIOFrameWriter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOFrameWriter.h"
+
+#include "SocketIOStats.h"
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+/**
+ * @brief Write into buffer, or only measure when buffer is NULL
+ *
+ * @param buffer char *
+ * @param capacity size_t
+ */
+SocketIOFrameWriter::SocketIOFrameWriter(char *buffer, size_t capacity) : _buffer(buffer), _capacity(capacity) {}
+
+/**
+ * @brief Append a character
+ *
+ * @param c char
+ */
+void SocketIOFrameWriter::raw(char c) {
+   if (_buffer) {
+      if (_length < _capacity) {
+         _buffer[_length] = c;
+      } else {
+         _overflowed = true;
+      }
+   }
+   _length++;
+}
+
+/**
+ * @brief Append bytes as they are
+ *
+ * @param data const char *
+ * @param length size_t
+ */
+void SocketIOFrameWriter::raw(const char *data, size_t length) {
+   if (_buffer) {
+      if (_length + length <= _capacity) {
+         memcpy(_buffer + _length, data, length);
+      } else {
+         _overflowed = true;
+      }
+   }
+   _length += length;
+}
+
+/**
+ * @brief Append a JSON string, escaped. It may hold '\0' characters.
+ *
+ * @param str const char *
+ * @param length size_t
+ */
+void SocketIOFrameWriter::string(const char *str, size_t length) {
+   raw('"');
+   const char *run = str;
+   const char *end = str + length;
+   for (const char *p = str; p < end; p++) {
+      uint8_t c = (uint8_t)*p;
+      if (c >= 0x20 && c != '"' && c != '\\') {
+         continue;
+      }
+
+      // Copy the characters that need no escaping in one go
+      raw(run, p - run);
+      run = p + 1;
+
+      raw('\\');
+      switch (c) {
+      case '"':
+      case '\\':
+         raw((char)c);
+         break;
+      case '\b':
+         raw('b');
+         break;
+      case '\f':
+         raw('f');
+         break;
+      case '\n':
+         raw('n');
+         break;
+      case '\r':
+         raw('r');
+         break;
+      case '\t':
+         raw('t');
+         break;
+      default:
+         raw("u00", 3);
+         raw(HEX_DIGITS[c >> 4]);
+         raw(HEX_DIGITS[c & 0x0F]);
+         break;
+      }
+   }
+   raw(run, end - run);
+   raw('"');
+}
+
+/**
+ * @brief Append the placeholder of a binary attachment and keep the
+ * attachment to be sent after the packet
+ *
+ * @param binary const SocketIOBinary &
+ */
+void SocketIOFrameWriter::value(const SocketIOBinary &binary) {
+   if (_attachmentCount >= SIO_MAX_ATTACHMENTS) {
+      _tooManyAttachments = true;
+      raw("null", 4);
+      return;
+   }
+
+   raw("{\"_placeholder\":true,\"num\":", 27);
+   integer(_attachmentCount, false);
+   raw('}');
+   _attachments[_attachmentCount++] = binary;
+}
+
+/**
+ * @brief Append the JSON snapshot of client statistics
+ *
+ * @param stats const SocketIOStats &
+ */
+void SocketIOFrameWriter::value(const SocketIOStats &stats) { stats.write(*this); }
+
+/**
+ * @brief Append an integer in decimal
+ *
+ * @param n unsigned long long magnitude
+ * @param negative bool
+ */
+void SocketIOFrameWriter::integer(unsigned long long n, bool negative) {
+   char digits[21];
+   char *p = digits + sizeof(digits);
+   do {
+      *--p = '0' + (n % 10);
+      n /= 10;
+   } while (n);
+
+   if (negative) {
+      raw('-');
+   }
+   raw(p, digits + sizeof(digits) - p);
+}
@@ -0,0 +1,354 @@
+/*
+ * SocketIOMsgPackParser.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOMsgPackParser.h"
+
+#include <string.h>
+
+static uint64_t bigEndian(const uint8_t *p, uint8_t bytes) {
+   uint64_t n = 0;
+   while (bytes--) {
+      n = (n << 8) | *p++;
+   }
+   return n;
+}
+
+static bool isKey(const char *key, size_t length, const char *name) { return length == strlen(name) && memcmp(key, name, length) == 0; }
+
+/**
+ * @brief Parse a packet encoded by socket.io-msgpack-parser: a map with
+ * "type", and maybe "nsp", "data" and "id". Other keys are skipped.
+ *
+ * @param payload const uint8_t * the whole binary frame
+ * @param length size_t
+ * @param packet SocketIOMsgPackPacket &
+ * @return socketIOparseError_t
+ */
+socketIOparseError_t SocketIOMsgPackParser::parsePacket(const uint8_t *payload, size_t length, SocketIOMsgPackPacket &packet) {
+   packet.type = 0;
+   packet.nsp = "/";
+   packet.nspLength = 1;
+   packet.ackId = -1;
+   packet.data = NULL;
+   packet.dataEnd = NULL;
+   if (!length) {
+      return sIOparse_EMPTY;
+   }
+
+   const uint8_t *end = payload + length;
+   SocketIOMsgPackValue map;
+   const uint8_t *p = read(payload, end, map);
+   if (!p || map.type != sIOmsgpack_MAP) {
+      return sIOparse_BAD_PACKET;
+   }
+
+   for (uint64_t i = 0; i < map.value; i++) {
+      const char *key;
+      size_t keyLength;
+      p = readString(p, end, &key, &keyLength);
+      if (!p) {
+         return sIOparse_BAD_PACKET;
+      }
+      const uint8_t *start = p;
+      SocketIOMsgPackValue member;
+      if (!read(start, end, member) || (p = skip(start, end)) == NULL) {
+         return sIOparse_UNTERMINATED;
+      }
+
+      if (isKey(key, keyLength, "type")) {
+         if (member.type != sIOmsgpack_UINT || member.value > 6) {
+            return sIOparse_BAD_PACKET;
+         }
+         packet.type = '0' + member.value;
+      } else if (isKey(key, keyLength, "nsp")) {
+         if (member.type != sIOmsgpack_STR || !member.value) {
+            return sIOparse_BAD_NAMESPACE;
+         }
+         packet.nsp = (const char *)member.data;
+         packet.nspLength = member.value;
+      } else if (isKey(key, keyLength, "id")) {
+         if (member.type == sIOmsgpack_UINT && member.value <= 0x7FFFFFFF) {
+            packet.ackId = member.value;
+         } else if (member.type != sIOmsgpack_NIL) {
+            return sIOparse_BAD_ACK_ID;
+         }
+      } else if (isKey(key, keyLength, "data")) {
+         packet.data = start;
+         packet.dataEnd = p;
+      }
+   }
+   return packet.type ? sIOparse_OK : sIOparse_BAD_PACKET;
+}
+
+/**
+ * @brief Read the head of a value
+ *
+ * @param p const uint8_t *
+ * @param end const uint8_t *
+ * @param value SocketIOMsgPackValue &
+ * @return const uint8_t * after the value, or after its header for an array
+ * or a map (at its first element), NULL if it is truncated or invalid
+ */
+const uint8_t *SocketIOMsgPackParser::read(const uint8_t *p, const uint8_t *end, SocketIOMsgPackValue &value) {
+   if (p >= end) {
+      return NULL;
+   }
+   uint8_t b = *p++;
+   value.data = NULL;
+
+   // Fix forms: the value or the length is in the first byte
+   if (b <= 0x7F || b >= 0xE0) {
+      value.type = b <= 0x7F ? sIOmsgpack_UINT : sIOmsgpack_INT;
+      value.value = b <= 0x7F ? b : (uint64_t)(int64_t)(int8_t)b;
+      return p;
+   }
+   if (b <= 0x9F) {
+      value.type = b <= 0x8F ? sIOmsgpack_MAP : sIOmsgpack_ARRAY;
+      value.value = b & 0x0F;
+      value.data = p;
+      return p;
+   }
+   if (b <= 0xBF) {
+      value.type = sIOmsgpack_STR;
+      value.value = b & 0x1F;
+      if ((uint64_t)(end - p) < value.value) {
+         return NULL;
+      }
+      value.data = p;
+      return p + value.value;
+   }
+
+   uint8_t size;          // Bytes of the number or length after the first byte
+   bool sized = true;     // The number is a length of bytes that follow
+   uint64_t fixed = 0;    // Length of a fixext
+   switch (b) {
+   case 0xC0:
+      value.type = sIOmsgpack_NIL;
+      value.value = 0;
+      return p;
+   case 0xC2:
+   case 0xC3:
+      value.type = sIOmsgpack_BOOL;
+      value.value = b & 1;
+      return p;
+   case 0xC4:
+   case 0xC5:
+   case 0xC6:
+      value.type = sIOmsgpack_BIN;
+      size = 1 << (b - 0xC4);
+      break;
+   case 0xC7:
+   case 0xC8:
+   case 0xC9:
+      value.type = sIOmsgpack_EXT;
+      size = 1 << (b - 0xC7);
+      break;
+   case 0xCA:
+   case 0xCB:
+      value.type = b == 0xCA ? sIOmsgpack_FLOAT : sIOmsgpack_DOUBLE;
+      size = b == 0xCA ? 4 : 8;
+      sized = false;
+      break;
+   case 0xCC:
+   case 0xCD:
+   case 0xCE:
+   case 0xCF:
+      value.type = sIOmsgpack_UINT;
+      size = 1 << (b - 0xCC);
+      sized = false;
+      break;
+   case 0xD0:
+   case 0xD1:
+   case 0xD2:
+   case 0xD3:
+      value.type = sIOmsgpack_INT;
+      size = 1 << (b - 0xD0);
+      sized = false;
+      break;
+   case 0xD4:
+   case 0xD5:
+   case 0xD6:
+   case 0xD7:
+   case 0xD8:
+      value.type = sIOmsgpack_EXT;
+      size = 0;
+      fixed = 1 << (b - 0xD4);
+      break;
+   case 0xD9:
+   case 0xDA:
+   case 0xDB:
+      value.type = sIOmsgpack_STR;
+      size = 1 << (b - 0xD9);
+      break;
+   case 0xDC:
+   case 0xDD:
+   case 0xDE:
+   case 0xDF:
+      value.type = b <= 0xDD ? sIOmsgpack_ARRAY : sIOmsgpack_MAP;
+      size = (b & 1) ? 4 : 2;
+      sized = false;
+      break;
+   default:
+      // 0xC1 is never used
+      return NULL;
+   }
+
+   if ((size_t)(end - p) < size) {
+      return NULL;
+   }
+   uint64_t n = size ? bigEndian(p, size) : fixed;
+   p += size;
+
+   if (!sized) {
+      if (value.type == sIOmsgpack_INT && size < 8 && (n >> (size * 8 - 1))) {
+         // Sign extension
+         n |= ~0ULL << (size * 8);
+      }
+      value.value = n;
+      if (value.type == sIOmsgpack_ARRAY || value.type == sIOmsgpack_MAP) {
+         value.data = p;
+      }
+      return p;
+   }
+
+   if (value.type == sIOmsgpack_EXT) {
+      // Type of the extension
+      if (p >= end) {
+         return NULL;
+      }
+      p++;
+   }
+   if ((uint64_t)(end - p) < n) {
+      return NULL;
+   }
+   value.value = n;
+   value.data = p;
+   return p + n;
+}
+
+/**
+ * @brief Skip a value, arrays and maps included
+ *
+ * @param p const uint8_t *
+ * @param end const uint8_t *
+ * @param depth uint8_t nesting of the value
+ * @return const uint8_t * after the value, NULL if it is truncated, invalid or
+ * nested deeper than SIO_MSGPACK_MAX_DEPTH
+ */
+const uint8_t *SocketIOMsgPackParser::skip(const uint8_t *p, const uint8_t *end, uint8_t depth) {
+   SocketIOMsgPackValue value;
+   p = read(p, end, value);
+   if (!p || (value.type != sIOmsgpack_ARRAY && value.type != sIOmsgpack_MAP)) {
+      return p;
+   }
+   if (depth >= SIO_MSGPACK_MAX_DEPTH) {
+      return NULL;
+   }
+   uint64_t count = value.type == sIOmsgpack_MAP ? value.value * 2 : value.value;
+   for (uint64_t i = 0; p && i < count; i++) {
+      p = skip(p, end, depth + 1);
+   }
+   return p;
+}
+
+/**
+ * @brief Read a str value
+ *
+ * @param p const uint8_t *
+ * @param end const uint8_t *
+ * @param str const char ** its bytes, not terminated
+ * @param length size_t *
+ * @return const uint8_t * after the value, NULL if it is not a str
+ */
+const uint8_t *SocketIOMsgPackParser::readString(const uint8_t *p, const uint8_t *end, const char **str, size_t *length) {
+   SocketIOMsgPackValue value;
+   p = read(p, end, value);
+   if (!p || value.type != sIOmsgpack_STR) {
+      return NULL;
+   }
+   *str = (const char *)value.data;
+   *length = value.value;
+   return p;
+}
+
+/**
+ * @brief Write a value as JSON text. A bin value becomes the placeholder of an
+ * attachment ({"_placeholder":true,"num":N}, kept by the writer) as it would
+ * be in the JSON encoding, an ext value becomes null.
+ *
+ * @param p const uint8_t *
+ * @param end const uint8_t *
+ * @param writer SocketIOFrameWriter &
+ * @param depth uint8_t nesting of the value
+ * @return const uint8_t * after the value, NULL if it is truncated, invalid,
+ * nested too deep or if a map key is not a str
+ */
+const uint8_t *SocketIOMsgPackParser::toJson(const uint8_t *p, const uint8_t *end, SocketIOFrameWriter &writer, uint8_t depth) {
+   SocketIOMsgPackValue value;
+   p = read(p, end, value);
+   if (!p) {
+      return NULL;
+   }
+
+   switch (value.type) {
+   case sIOmsgpack_NIL:
+   case sIOmsgpack_EXT:
+      writer.raw("null", 4);
+      break;
+   case sIOmsgpack_BOOL:
+      writer.value((bool)value.value);
+      break;
+   case sIOmsgpack_UINT:
+      writer.value((unsigned long long)value.value);
+      break;
+   case sIOmsgpack_INT:
+      writer.value((long long)(int64_t)value.value);
+      break;
+   case sIOmsgpack_FLOAT: {
+      uint32_t bits = value.value;
+      float f;
+      memcpy(&f, &bits, sizeof(f));
+      writer.value(f);
+   } break;
+   case sIOmsgpack_DOUBLE: {
+      double d;
+      memcpy(&d, &value.value, sizeof(d));
+      writer.value(d);
+   } break;
+   case sIOmsgpack_STR:
+      writer.string((const char *)value.data, value.value);
+      break;
+   case sIOmsgpack_BIN:
+      writer.value(SocketIOBinary(value.data, value.value));
+      break;
+   case sIOmsgpack_ARRAY:
+   case sIOmsgpack_MAP: {
+      if (depth >= SIO_MSGPACK_MAX_DEPTH) {
+         return NULL;
+      }
+      bool map = value.type == sIOmsgpack_MAP;
+      writer.raw(map ? '{' : '[');
+      for (uint64_t i = 0; p && i < value.value; i++) {
+         if (i) {
+            writer.raw(',');
+         }
+         if (map) {
+            const char *key;
+            size_t length;
+            p = readString(p, end, &key, &length);
+            if (!p) {
+               return NULL;
+            }
+            writer.string(key, length);
+            writer.raw(':');
+         }
+         p = toJson(p, end, writer, depth + 1);
+      }
+      writer.raw(map ? '}' : ']');
+   } break;
+   }
+   return p;
+}
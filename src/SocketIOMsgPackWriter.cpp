@@ -0,0 +1,372 @@
+/*
+ * SocketIOMsgPackWriter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOMsgPackWriter.h"
+
+#include "SocketIOEventParser.h"
+#include "SocketIOStats.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *skipSpace(const char *p, const char *end) {
+   while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+      p++;
+   }
+   return p;
+}
+
+/**
+ * @brief Write into buffer, or only measure when buffer is NULL
+ *
+ * @param buffer uint8_t *
+ * @param capacity size_t
+ */
+SocketIOMsgPackWriter::SocketIOMsgPackWriter(uint8_t *buffer, size_t capacity) : _buffer(buffer), _capacity(capacity) {}
+
+/**
+ * @brief Append a byte
+ *
+ * @param b uint8_t
+ */
+void SocketIOMsgPackWriter::raw(uint8_t b) {
+   if (_buffer) {
+      if (_length < _capacity) {
+         _buffer[_length] = b;
+      } else {
+         _overflowed = true;
+      }
+   }
+   _length++;
+}
+
+/**
+ * @brief Append bytes as they are
+ *
+ * @param data const void *
+ * @param length size_t
+ */
+void SocketIOMsgPackWriter::raw(const void *data, size_t length) {
+   if (_buffer) {
+      if (_length + length <= _capacity) {
+         memcpy(_buffer + _length, data, length);
+      } else {
+         _overflowed = true;
+      }
+   }
+   _length += length;
+}
+
+/**
+ * @brief Append the header of a map of count key / value pairs
+ *
+ * @param count size_t
+ */
+void SocketIOMsgPackWriter::mapHeader(size_t count) { header(0x80, 15, 0, 0xDE, count); }
+
+/**
+ * @brief Append the header of an array of count elements
+ *
+ * @param count size_t
+ */
+void SocketIOMsgPackWriter::arrayHeader(size_t count) { header(0x90, 15, 0, 0xDC, count); }
+
+/**
+ * @brief Append a string, UTF-8 bytes as they are
+ *
+ * @param str const char *
+ * @param length size_t
+ */
+void SocketIOMsgPackWriter::string(const char *str, size_t length) {
+   header(0xA0, 31, 0xD9, 0xDA, length);
+   raw(str, length);
+}
+
+/**
+ * @brief Append a bin value
+ *
+ * @param data const uint8_t *
+ * @param length size_t
+ */
+void SocketIOMsgPackWriter::binary(const uint8_t *data, size_t length) {
+   if (length <= 0xFF) {
+      raw(0xC4);
+      raw((uint8_t)length);
+   } else if (length <= 0xFFFF) {
+      raw(0xC5);
+      bigEndian(length, 2);
+   } else {
+      raw(0xC6);
+      bigEndian(length, 4);
+   }
+   if (length) {
+      raw(data, length);
+   }
+}
+
+/**
+ * @brief Append JSON text as the MessagePack value it stands for. Strings are
+ * unescaped, integers take the smallest encoding, other numbers are float 64.
+ *
+ * @param p const char * first character of the value, spaces allowed
+ * @param end const char *
+ * @param depth uint8_t nesting of the value
+ * @return const char * just after the value, NULL if it is not well formed
+ * (part of it may have been written)
+ */
+const char *SocketIOMsgPackWriter::json(const char *p, const char *end, uint8_t depth) {
+   p = skipSpace(p, end);
+   if (p >= end) {
+      return NULL;
+   }
+
+   if (*p == '"') {
+      const char *close = SocketIOEventParser::skipString(p, end);
+      if (!close) {
+         return NULL;
+      }
+      size_t length = SocketIOEventParser::unescape(p + 1, close - p - 2, NULL);
+      header(0xA0, 31, 0xD9, 0xDA, length);
+      if (_buffer && _length + length <= _capacity) {
+         SocketIOEventParser::unescape(p + 1, close - p - 2, (char *)_buffer + _length);
+      } else if (_buffer) {
+         _overflowed = true;
+      }
+      _length += length;
+      return close;
+   }
+
+   if (*p == '[' || *p == '{') {
+      if (depth >= SIO_MSGPACK_MAX_DEPTH) {
+         return NULL;
+      }
+      bool object = *p == '{';
+      char closing = object ? '}' : ']';
+
+      // Count the elements first: the header comes before them
+      size_t count = 0;
+      const char *q = skipSpace(p + 1, end);
+      while (q < end && *q != closing) {
+         if (object) {
+            q = *q == '"' ? SocketIOEventParser::skipString(q, end) : NULL;
+            q = q ? skipSpace(q, end) : NULL;
+            if (!q || q >= end || *q != ':') {
+               return NULL;
+            }
+            q = skipSpace(q + 1, end);
+         }
+         q = SocketIOEventParser::skipValue(q, end);
+         if (!q) {
+            return NULL;
+         }
+         count++;
+         q = skipSpace(q, end);
+         if (q < end && *q == ',') {
+            q = skipSpace(q + 1, end);
+         } else if (q >= end || *q != closing) {
+            return NULL;
+         }
+      }
+      if (q >= end) {
+         return NULL;
+      }
+
+      object ? mapHeader(count) : arrayHeader(count);
+      q = p + 1;
+      for (size_t i = 0; i < count; i++) {
+         if (object) {
+            // Key, then ':'
+            q = json(q, end, depth + 1);
+            q = skipSpace(q, end) + 1;
+         }
+         q = json(q, end, depth + 1);
+         if (!q) {
+            return NULL;
+         }
+         // ',' or the closing bracket
+         q = skipSpace(q, end) + 1;
+      }
+      return count ? q : skipSpace(p + 1, end) + 1;
+   }
+
+   const char *q = SocketIOEventParser::skipValue(p, end);
+   if (!q) {
+      return NULL;
+   }
+   size_t length = q - p;
+   if (length == 4 && memcmp(p, "true", 4) == 0) {
+      value(true);
+   } else if (length == 5 && memcmp(p, "false", 5) == 0) {
+      value(false);
+   } else if (length == 4 && memcmp(p, "null", 4) == 0) {
+      nil();
+   } else {
+      bool negative = *p == '-';
+      const char *digit = negative ? p + 1 : p;
+      unsigned long long n = 0;
+      while (digit < q && *digit >= '0' && *digit <= '9' && n <= (~0ULL - 9) / 10) {
+         n = n * 10 + (*digit++ - '0');
+      }
+      if (digit == q && digit > p + negative) {
+         integer(n, negative && n);
+         return q;
+      }
+
+      // Fraction, exponent or too many digits
+      char number[32];
+      if (length >= sizeof(number)) {
+         return NULL;
+      }
+      memcpy(number, p, length);
+      number[length] = '\0';
+      char *parsed;
+      double d = strtod(number, &parsed);
+      if (parsed != number + length) {
+         return NULL;
+      }
+      value(d);
+   }
+   return q;
+}
+
+/**
+ * @brief Append the value of JSON text, nil if it is not well formed
+ *
+ * @param json const SocketIORawJson &
+ */
+void SocketIOMsgPackWriter::value(const SocketIORawJson &json) {
+   size_t start = _length;
+   if (!json.json || !this->json(json.json, json.json + json.length)) {
+      // Drop what a malformed value left half written
+      _length = start;
+      nil();
+   }
+}
+
+/**
+ * @brief Append the snapshot of client statistics, as a string holding its
+ * JSON (see SocketIOStats::write)
+ *
+ * @param stats const SocketIOStats &
+ */
+void SocketIOMsgPackWriter::value(const SocketIOStats &stats) {
+   SocketIOFrameWriter measure;
+   stats.write(measure);
+   size_t length = measure.length();
+
+   header(0xA0, 31, 0xD9, 0xDA, length);
+   if (_buffer && _length + length <= _capacity) {
+      SocketIOFrameWriter writer((char *)_buffer + _length, length);
+      stats.write(writer);
+   } else if (_buffer) {
+      _overflowed = true;
+   }
+   _length += length;
+}
+
+/**
+ * @brief Append a float 32
+ *
+ * @param n float
+ */
+void SocketIOMsgPackWriter::value(float n) {
+   uint32_t bits;
+   memcpy(&bits, &n, sizeof(bits));
+   raw(0xCA);
+   bigEndian(bits, 4);
+}
+
+/**
+ * @brief Append a float 64
+ *
+ * @param n double
+ */
+void SocketIOMsgPackWriter::value(double n) {
+   uint64_t bits;
+   memcpy(&bits, &n, sizeof(bits));
+   raw(0xCB);
+   bigEndian(bits, 8);
+}
+
+/**
+ * @brief Append an integer in the smallest encoding
+ *
+ * @param n unsigned long long magnitude
+ * @param negative bool
+ */
+void SocketIOMsgPackWriter::integer(unsigned long long n, bool negative) {
+   if (!negative) {
+      if (n <= 0x7F) {
+         raw((uint8_t)n);
+      } else if (n <= 0xFF) {
+         raw(0xCC);
+         raw((uint8_t)n);
+      } else if (n <= 0xFFFF) {
+         raw(0xCD);
+         bigEndian(n, 2);
+      } else if (n <= 0xFFFFFFFFULL) {
+         raw(0xCE);
+         bigEndian(n, 4);
+      } else {
+         raw(0xCF);
+         bigEndian(n, 8);
+      }
+      return;
+   }
+
+   // Two's complement, truncated to the size written
+   uint64_t bits = 0 - (uint64_t)n;
+   if (n <= 32) {
+      raw((uint8_t)bits);
+   } else if (n <= 0x80) {
+      raw(0xD0);
+      raw((uint8_t)bits);
+   } else if (n <= 0x8000) {
+      raw(0xD1);
+      bigEndian(bits, 2);
+   } else if (n <= 0x80000000ULL) {
+      raw(0xD2);
+      bigEndian(bits, 4);
+   } else {
+      raw(0xD3);
+      bigEndian(bits, 8);
+   }
+}
+
+/**
+ * @brief Append the header of a string, array or map
+ *
+ * @param fix uint8_t first byte of the fix form, ORed with count
+ * @param fixMax size_t largest count of the fix form
+ * @param code8 uint8_t first byte of the 8 bit form, 0 if there is none
+ * @param code16 uint8_t first byte of the 16 bit form, the 32 bit one follows
+ * @param count size_t
+ */
+void SocketIOMsgPackWriter::header(uint8_t fix, size_t fixMax, uint8_t code8, uint8_t code16, size_t count) {
+   if (count <= fixMax) {
+      raw((uint8_t)(fix | count));
+   } else if (code8 && count <= 0xFF) {
+      raw(code8);
+      raw((uint8_t)count);
+   } else if (count <= 0xFFFF) {
+      raw(code16);
+      bigEndian(count, 2);
+   } else {
+      raw((uint8_t)(code16 + 1));
+      bigEndian(count, 4);
+   }
+}
+
+/**
+ * @brief Append the low bytes of n, most significant first
+ *
+ * @param n uint64_t
+ * @param bytes uint8_t
+ */
+void SocketIOMsgPackWriter::bigEndian(uint64_t n, uint8_t bytes) {
+   while (bytes--) {
+      raw((uint8_t)(n >> (bytes * 8)));
+   }
+}
@@ -0,0 +1,261 @@
+/*
+ * SocketIONamespace.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "ArduinoSocketIOClient.h"
+
+SocketIONamespace::SocketIONamespace() {}
+
+SocketIONamespace::~SocketIONamespace() {}
+
+/**
+ * @brief Attach to the client
+ *
+ * @param client ArduinoSocketIOClient *
+ * @param name const char * "/" or "/nsp", not copied
+ */
+void SocketIONamespace::begin(ArduinoSocketIOClient *client, const char *name) {
+   _client = client;
+   _name = name;
+   _nameLength = strlen(name);
+   _prefixLength = strcmp(name, "/") != 0 ? _nameLength + 1 : 0;
+}
+
+/**
+ * @brief Check the namespace of a received packet
+ *
+ * @param name const char * not terminated
+ * @param length size_t
+ * @return bool
+ */
+bool SocketIONamespace::matches(const char *name, size_t length) const { return length == _nameLength && memcmp(name, _name, length) == 0; }
+
+/**
+ * @brief Add a listener of this namespace
+ *
+ * @param event const char *
+ * @param handler SocketIOEventHandler
+ */
+void SocketIONamespace::on(const char *event, SocketIOEventHandler handler) {
+   if (!_events.set(SocketIOEvent(event, SocketIOEventTable::hash(event)), handler)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] no memory to add event %s\n", event);
+   }
+}
+
+/**
+ * @brief Add a listener of this namespace for an event declared at compile
+ * time. Its name is not copied.
+ *
+ * @param event const SocketIOEvent &
+ * @param handler SocketIOEventHandler
+ */
+void SocketIONamespace::on(const SocketIOEvent &event, SocketIOEventHandler handler) {
+   if (!_events.set(event, handler, false)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] no memory to add event %s\n", event.name);
+   }
+}
+
+/**
+ * @brief Remove a listener of this namespace
+ *
+ * @param event const char *
+ */
+void SocketIONamespace::remove(const char *event) { remove(SocketIOEvent(event, SocketIOEventTable::hash(event))); }
+
+/**
+ * @brief Remove a listener of this namespace
+ *
+ * @param event const SocketIOEvent &
+ */
+void SocketIONamespace::remove(const SocketIOEvent &event) {
+   if (!_events.remove(event)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] event %s not found, can not be removed\n", event.name);
+   }
+}
+
+void SocketIONamespace::removeAll(void) { _events.clear(); }
+
+/**
+ * @brief Route the events of this namespace that have no listener of their
+ * own by pattern, with "*" segments (see SocketIOEventRouter)
+ *
+ * @param pattern const char * copied
+ * @param handler SocketIORouteHandler
+ * @return bool false if memory is exhausted
+ */
+bool SocketIONamespace::onRoute(const char *pattern, SocketIORouteHandler handler) {
+   if (!_routes.add(pattern, handler)) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] no memory to add route %s\n", pattern);
+      return false;
+   }
+   return true;
+}
+
+/**
+ * @brief Remove a route of this namespace
+ *
+ * @param pattern const char *
+ * @return bool false if the pattern is not routed
+ */
+bool SocketIONamespace::removeRoute(const char *pattern) { return _routes.remove(pattern); }
+
+/**
+ * @brief Read the argument of a typed listener, in place: strings are not
+ * copied into the document
+ *
+ * @param doc JsonDocument &
+ * @param payload const char * terminated, inside the receive buffer
+ * @param length size_t
+ * @param filter const JsonDocument * NULL to keep every field
+ * @return bool false if the argument is not JSON or does not fit in doc
+ */
+bool SocketIONamespace::deserialize(JsonDocument &doc, const char *payload, size_t length, const JsonDocument *filter) {
+   DeserializationError err = filter ? deserializeJson(doc, (char *)payload, length, DeserializationOption::Filter(*filter)) : deserializeJson(doc, (char *)payload, length);
+   if (err) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] typed listener of %s: %s\n", _name, err.c_str());
+      _client->_stats.parseFailures++;
+      return false;
+   }
+   return true;
+}
+
+/**
+ * @brief Receive an event of this namespace chunk by chunk (see
+ * ArduinoSocketIOClient::onStream)
+ *
+ * @param event const char * not copied
+ * @param handler SocketIOStreamHandler NULL to remove
+ * @return bool false if SIO_MAX_STREAM_EVENTS events are already streamed
+ */
+bool SocketIONamespace::onStream(const char *event, SocketIOStreamHandler handler) { return _client && _client->addStream(this, event, handler); }
+
+/**
+ * @brief Join the namespace: CONNECT is sent now if the client is connected,
+ * and again after every reconnection
+ *
+ * @return bool false if the CONNECT could not be sent now
+ */
+bool SocketIONamespace::connect(void) {
+   _joined = true;
+   return _client && _client->isConnected() && sendConnect();
+}
+
+/**
+ * @brief Send the CONNECT, with the session to recover if there is one:
+ * 40/nsp,{"pid":"...","offset":"..."}
+ *
+ * @return bool
+ */
+bool SocketIONamespace::sendConnect(void) {
+   if (_client->_encoding == sIOencoding_MSGPACK) {
+      return _client->sendNamespace(sIOtype_CONNECT, *this);
+   }
+   if (!_pid[0]) {
+      return _client->send(sIOtype_CONNECT, _name);
+   }
+
+   char packet[SIO_SESSION_ID_SIZE * 2 + 32];
+   SocketIOFrameWriter writer(packet, sizeof(packet));
+   if (_prefixLength) {
+      writer.raw(_name, _nameLength);
+      writer.raw(',');
+   }
+   writer.raw("{\"pid\":", 7);
+   writer.value(_pid);
+   if (_offset[0]) {
+      writer.raw(",\"offset\":", 10);
+      writer.value(_offset);
+   }
+   writer.raw('}');
+   if (writer.length() >= sizeof(packet)) {
+      // Namespace name too long to fit: joined as a new session
+      return _client->send(sIOtype_CONNECT, _name);
+   }
+   return _client->send(sIOtype_CONNECT, packet, writer.length());
+}
+
+/**
+ * @brief Leave the namespace: DISCONNECT is sent if it was joined, pending
+ * acks are dropped
+ *
+ * @return bool false if the DISCONNECT could not be sent
+ */
+bool SocketIONamespace::disconnect(void) {
+   _joined = false;
+   if (!_connected) {
+      return false;
+   }
+   bool sent = _client->_encoding == sIOencoding_MSGPACK ? _client->sendNamespace(sIOtype_DISCONNECT, *this) : _client->send(sIOtype_DISCONNECT, _name);
+   disconnected("io client disconnect", 20);
+   return sent;
+}
+
+/**
+ * @brief Keep the offset the server appends to the events it can replay: the
+ * last argument, when it is a string
+ *
+ * @param frame const SocketIOEventFrame &
+ */
+void SocketIONamespace::keepOffset(const SocketIOEventFrame &frame) {
+   if (!_pid[0] || !frame.argc || frame.last[0] != '"') {
+      return;
+   }
+   // A lone argument is the one already unescaped in place
+   const char *offset = frame.argc == 1 ? frame.data : frame.last + 1;
+   size_t length = frame.argc == 1 ? frame.dataLength : frame.lastLength - 2;
+   if (length < sizeof(_offset)) {
+      memcpy(_offset, offset, length);
+      _offset[length] = '\0';
+   }
+}
+
+/**
+ * @brief The server accepted the CONNECT
+ *
+ * @param data const char * {"sid":...}
+ * @param length size_t
+ */
+void SocketIONamespace::connected(const char *data, size_t length) {
+   // The server keeps the pid when it restored the session
+   size_t pidLength = 0;
+   const char *pid = SocketIOEventParser::findString(data, length, "pid", &pidLength);
+   _recovered = pid && _pid[0] && strlen(_pid) == pidLength && memcmp(_pid, pid, pidLength) == 0;
+   if (!_recovered) {
+      _offset[0] = '\0';
+   }
+   if (pid && pidLength < sizeof(_pid)) {
+      memcpy(_pid, pid, pidLength);
+      _pid[pidLength] = '\0';
+   } else {
+      _pid[0] = '\0';
+   }
+
+   _connected = true;
+   if (_onConnect) {
+      _onConnect(data, length);
+   }
+}
+
+/**
+ * @brief The namespace was left, refused or the connection lost: its acks
+ * will not be answered
+ *
+ * @param reason const char * NULL when the connection was lost
+ * @param length size_t
+ */
+void SocketIONamespace::disconnected(const char *reason, size_t length) {
+   bool wasConnected = _connected;
+   _connected = false;
+   _acks.clear();
+   if (reason) {
+      // Left or refused: nothing to recover
+      _pid[0] = '\0';
+      _offset[0] = '\0';
+      _recovered = false;
+   }
+   if (_onDisconnect && (wasConnected || reason)) {
+      _onDisconnect(reason, length);
+   }
+}
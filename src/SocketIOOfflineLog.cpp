@@ -0,0 +1,451 @@
+/*
+ * SocketIOOfflineLog.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOOfflineLog.h"
+
+#include <string.h>
+
+#define SIO_OFFLINE_MAGIC 0x4C4F4953 // "SIOL"
+#define SIO_OFFLINE_COPY_SIZE 64
+
+#if defined(SIO_OFFLINE_FS)
+static bool fileValid(SocketIOFile &file) { return (bool)file; }
+
+static size_t fileRead(SocketIOFile &file, size_t offset, void *data, size_t length) {
+   if (!file.seek(offset, SeekSet)) {
+      return 0;
+   }
+   return file.read((uint8_t *)data, length);
+}
+
+static size_t fileWrite(SocketIOFile &file, size_t offset, const void *data, size_t length) {
+   if (!file.seek(offset, SeekSet)) {
+      return 0;
+   }
+   return file.write((const uint8_t *)data, length);
+}
+
+static void fileFlush(SocketIOFile &file) { file.flush(); }
+
+static void fileClose(SocketIOFile &file) {
+   if (file) {
+      file.close();
+   }
+}
+#elif defined(SIO_OFFLINE_STDIO)
+static bool fileValid(SocketIOFile &file) { return file != NULL; }
+
+static size_t fileRead(SocketIOFile &file, size_t offset, void *data, size_t length) {
+   if (fseek(file, offset, SEEK_SET) != 0) {
+      return 0;
+   }
+   return fread(data, 1, length, file);
+}
+
+static size_t fileWrite(SocketIOFile &file, size_t offset, const void *data, size_t length) {
+   if (fseek(file, offset, SEEK_SET) != 0) {
+      return 0;
+   }
+   return fwrite(data, 1, length, file);
+}
+
+static void fileFlush(SocketIOFile &file) { fflush(file); }
+
+static void fileClose(SocketIOFile &file) {
+   if (file) {
+      fclose(file);
+      file = NULL;
+   }
+}
+#endif
+
+SocketIOOfflineLog::SocketIOOfflineLog() {
+   _path[0] = '\0';
+#if defined(SIO_OFFLINE_STDIO)
+   _file = NULL;
+#endif
+}
+
+SocketIOOfflineLog::~SocketIOOfflineLog() { end(); }
+
+#if defined(SIO_OFFLINE_FS)
+/**
+ * @brief Open (or create) the log on a file system, e.g. LittleFS, which must
+ * be mounted
+ *
+ * @param fs fs::FS &
+ * @param path const char * shorter than SIO_OFFLINE_PATH_SIZE - 1
+ * @param maxBytes size_t size cap of the file
+ * @param dropOldest bool when the cap is reached, evict the oldest records
+ * (true) or refuse the new one (false)
+ * @return bool false if the file can not be opened
+ */
+bool SocketIOOfflineLog::begin(fs::FS &fs, const char *path, size_t maxBytes, bool dropOldest) {
+   end();
+   _fs = &fs;
+#elif defined(SIO_OFFLINE_STDIO)
+/**
+ * @brief Open (or create) the log in a plain file
+ *
+ * @param path const char * shorter than SIO_OFFLINE_PATH_SIZE - 1
+ * @param maxBytes size_t size cap of the file
+ * @param dropOldest bool when the cap is reached, evict the oldest records
+ * (true) or refuse the new one (false)
+ * @return bool false if the file can not be opened
+ */
+bool SocketIOOfflineLog::begin(const char *path, size_t maxBytes, bool dropOldest) {
+   end();
+#endif
+#if defined(SIO_OFFLINE_FS) || defined(SIO_OFFLINE_STDIO)
+   if (strlen(path) >= SIO_OFFLINE_PATH_SIZE - 1 || maxBytes <= sizeof(Header) + sizeof(uint32_t)) {
+      return false;
+   }
+   strcpy(_path, path);
+   _maxBytes = maxBytes;
+   _dropOldest = dropOldest;
+
+   // Keep what a previous run left, start over if it is not a log
+   _ready = (open("r+") && recover()) || reset();
+   return _ready;
+}
+#endif
+
+/**
+ * @brief Close the file. Records stay in it for the next begin().
+ *
+ */
+void SocketIOOfflineLog::end(void) {
+   if (_ready) {
+      flush();
+   }
+   close();
+   _ready = false;
+   _count = 0;
+   _read = 0;
+   _end = 0;
+}
+
+/**
+ * @brief Start appending a record, evicting old records or compacting the
+ * file if the cap requires it
+ *
+ * @param length size_t
+ * @return bool false if the record can not be stored (larger than the cap,
+ * cap reached without dropOldest, or file error)
+ */
+bool SocketIOOfflineLog::beginRecord(size_t length) {
+   size_t total = sizeof(uint32_t) + length;
+   _writeEnd = 0;
+   if (!_ready || sizeof(Header) + total > _maxBytes) {
+      _dropped++;
+      return false;
+   }
+
+   if (_end + total > _maxBytes) {
+      if (sizeof(Header) + bytes() + total > _maxBytes) {
+         if (!_dropOldest) {
+            _dropped++;
+            return false;
+         }
+         // Evict from the read offset until the live records and this one fit
+         while (_count && sizeof(Header) + bytes() + total > _maxBytes) {
+            uint32_t oldest;
+            if (readAt(_read, &oldest, sizeof(oldest)) != sizeof(oldest)) {
+               return reset() && beginRecord(length);
+            }
+            _read += sizeof(oldest) + oldest;
+            _count--;
+            _dropped++;
+         }
+      }
+      if (!(_count ? compact() : reset())) {
+         return false;
+      }
+   }
+
+   uint32_t length32 = length;
+   if (writeAt(_end, &length32, sizeof(length32)) != sizeof(length32)) {
+      return false;
+   }
+   _writeAt = _end + sizeof(length32);
+   _writeEnd = _end + total;
+   return true;
+}
+
+/**
+ * @brief Append data to the record started by beginRecord
+ *
+ * @param data const void *
+ * @param length size_t
+ * @return bool false if it exceeds the record length or on file error
+ */
+bool SocketIOOfflineLog::write(const void *data, size_t length) {
+   if (!_writeEnd || _writeAt + length > _writeEnd) {
+      return false;
+   }
+   if (length && writeAt(_writeAt, data, length) != length) {
+      return false;
+   }
+   _writeAt += length;
+   return true;
+}
+
+/**
+ * @brief Publish the record. A record that is not complete is abandoned (and
+ * ignored after a reboot).
+ *
+ * @return bool
+ */
+bool SocketIOOfflineLog::endRecord(void) {
+   if (!_writeEnd || _writeAt != _writeEnd) {
+      _writeEnd = 0;
+      return false;
+   }
+   _end = _writeEnd;
+   _count++;
+   _writeEnd = 0;
+#if defined(SIO_OFFLINE_FS) || defined(SIO_OFFLINE_STDIO)
+   fileFlush(_file);
+#endif
+   return true;
+}
+
+/**
+ * @brief Start reading the oldest record
+ *
+ * @return size_t its length, 0 if the log is empty
+ */
+size_t SocketIOOfflineLog::peekRecord(void) {
+   uint32_t length = 0;
+   if (!_count || readAt(_read, &length, sizeof(length)) != sizeof(length)) {
+      return 0;
+   }
+   _recordLength = length;
+   _readAt = _read + sizeof(length);
+   return length;
+}
+
+/**
+ * @brief Read the next bytes of the record opened by peekRecord
+ *
+ * @param data void *
+ * @param length size_t
+ * @return bool
+ */
+bool SocketIOOfflineLog::read(void *data, size_t length) {
+   if (_readAt + length > _read + sizeof(uint32_t) + _recordLength) {
+      return false;
+   }
+   if (length && readAt(_readAt, data, length) != length) {
+      return false;
+   }
+   _readAt += length;
+   return true;
+}
+
+/**
+ * @brief Drop the oldest record. The read offset is persisted by flush(), or
+ * right away when the log becomes empty (the file is truncated).
+ *
+ */
+void SocketIOOfflineLog::consume(void) {
+   if (!_count) {
+      return;
+   }
+   uint32_t length;
+   if (readAt(_read, &length, sizeof(length)) != sizeof(length)) {
+      reset();
+      return;
+   }
+   _read += sizeof(length) + length;
+   _readDirty = true;
+   if (--_count == 0) {
+      reset();
+   }
+}
+
+/**
+ * @brief Persist the read offset: records consumed before a reboot are not
+ * replayed again
+ *
+ */
+void SocketIOOfflineLog::flush(void) {
+   if (!_readDirty) {
+      return;
+   }
+   Header header = {SIO_OFFLINE_MAGIC, (uint32_t)_read};
+   if (writeAt(0, &header, sizeof(header)) == sizeof(header)) {
+#if defined(SIO_OFFLINE_FS) || defined(SIO_OFFLINE_STDIO)
+      fileFlush(_file);
+#endif
+      _readDirty = false;
+   }
+}
+
+/**
+ * @brief Drop every record
+ *
+ */
+void SocketIOOfflineLog::clear(void) {
+   if (_ready) {
+      reset();
+   }
+}
+
+/**
+ * @brief Rebuild the state from the file: check the header, count the
+ * complete records and ignore a record cut by a reset
+ *
+ * @return bool false if the file is not a log
+ */
+bool SocketIOOfflineLog::recover(void) {
+   Header header;
+   size_t size = fileSize();
+   if (readAt(0, &header, sizeof(header)) != sizeof(header) || header.magic != SIO_OFFLINE_MAGIC || header.read < sizeof(Header) || header.read > size) {
+      return false;
+   }
+
+   _read = header.read;
+   _end = _read;
+   _count = 0;
+   _readDirty = false;
+
+   uint32_t length;
+   while (_end + sizeof(length) <= size && readAt(_end, &length, sizeof(length)) == sizeof(length) && _end + sizeof(length) + length <= size) {
+      _end += sizeof(length) + length;
+      _count++;
+   }
+
+   if (!_count) {
+      return reset();
+   }
+   return true;
+}
+
+/**
+ * @brief Truncate the file to an empty log
+ *
+ * @return bool
+ */
+bool SocketIOOfflineLog::reset(void) {
+   close();
+   _count = 0;
+   _read = sizeof(Header);
+   _end = _read;
+   _readDirty = true;
+   if (!open("w+")) {
+      return false;
+   }
+   flush();
+   return !_readDirty;
+}
+
+/**
+ * @brief Move the live records to the beginning of a new file. Written to a
+ * temporary file first: a reset during the copy leaves the old log intact.
+ *
+ * @return bool
+ */
+bool SocketIOOfflineLog::compact(void) {
+#if defined(SIO_OFFLINE_FS) || defined(SIO_OFFLINE_STDIO)
+   if (_read == sizeof(Header)) {
+      return true;
+   }
+
+   char tmpPath[SIO_OFFLINE_PATH_SIZE + 1];
+   strcpy(tmpPath, _path);
+   strcat(tmpPath, "~");
+
+#if defined(SIO_OFFLINE_FS)
+   SocketIOFile tmp = _fs->open(tmpPath, "w+");
+#else
+   SocketIOFile tmp = fopen(tmpPath, "w+b");
+#endif
+   if (!fileValid(tmp)) {
+      return false;
+   }
+
+   Header header = {SIO_OFFLINE_MAGIC, sizeof(Header)};
+   bool ok = fileWrite(tmp, 0, &header, sizeof(header)) == sizeof(header);
+   uint8_t chunk[SIO_OFFLINE_COPY_SIZE];
+   for (size_t offset = _read; ok && offset < _end;) {
+      size_t length = _end - offset < sizeof(chunk) ? _end - offset : sizeof(chunk);
+      ok = readAt(offset, chunk, length) == length && fileWrite(tmp, sizeof(Header) + offset - _read, chunk, length) == length;
+      offset += length;
+   }
+   fileClose(tmp);
+   close();
+
+   if (ok) {
+#if defined(SIO_OFFLINE_FS)
+      _fs->remove(_path);
+      ok = _fs->rename(tmpPath, _path);
+#else
+      ok = rename(tmpPath, _path) == 0;
+#endif
+   }
+   if (!ok || !open("r+")) {
+      _ready = open("r+") && recover();
+      return false;
+   }
+
+   _end -= _read - sizeof(Header);
+   _read = sizeof(Header);
+   _readDirty = false;
+   return true;
+#else
+   return false;
+#endif
+}
+
+bool SocketIOOfflineLog::open(const char *mode) {
+#if defined(SIO_OFFLINE_FS)
+   _file = _fs->open(_path, mode);
+   return fileValid(_file);
+#elif defined(SIO_OFFLINE_STDIO)
+   char binaryMode[4] = {mode[0], mode[1], 'b', '\0'};
+   _file = fopen(_path, binaryMode);
+   return fileValid(_file);
+#else
+   return false;
+#endif
+}
+
+void SocketIOOfflineLog::close(void) {
+#if defined(SIO_OFFLINE_FS) || defined(SIO_OFFLINE_STDIO)
+   fileClose(_file);
+#endif
+}
+
+size_t SocketIOOfflineLog::readAt(size_t offset, void *data, size_t length) {
+#if defined(SIO_OFFLINE_FS) || defined(SIO_OFFLINE_STDIO)
+   return fileValid(_file) ? fileRead(_file, offset, data, length) : 0;
+#else
+   return 0;
+#endif
+}
+
+size_t SocketIOOfflineLog::writeAt(size_t offset, const void *data, size_t length) {
+#if defined(SIO_OFFLINE_FS) || defined(SIO_OFFLINE_STDIO)
+   return fileValid(_file) ? fileWrite(_file, offset, data, length) : 0;
+#else
+   return 0;
+#endif
+}
+
+size_t SocketIOOfflineLog::fileSize(void) {
+#if defined(SIO_OFFLINE_FS)
+   return _file ? _file.size() : 0;
+#elif defined(SIO_OFFLINE_STDIO)
+   if (!_file || fseek(_file, 0, SEEK_END) != 0) {
+      return 0;
+   }
+   long size = ftell(_file);
+   return size < 0 ? 0 : size;
+#else
+   return 0;
+#endif
+}
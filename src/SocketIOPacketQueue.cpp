@@ -0,0 +1,285 @@
+/*
+ * SocketIOPacketQueue.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOPacketQueue.h"
+
+#define SIO_QUEUE_ALIGN 4
+#define SIO_QUEUE_WRAP 0xFFFFFFFF
+#define SIO_QUEUE_DISCARDED 0xFFFFFFFE
+
+SocketIOPacketQueue::SocketIOPacketQueue() {}
+
+SocketIOPacketQueue::~SocketIOPacketQueue() {}
+
+/**
+ * @brief Attach the queue to its storage. The buffer must be 4-byte aligned
+ * and outlive the queue.
+ *
+ * @param buffer uint8_t *
+ * @param capacity size_t
+ * @param maxCount size_t maximum number of packets, 0 for no limit
+ */
+void SocketIOPacketQueue::begin(uint8_t *buffer, size_t capacity, size_t maxCount) {
+   _buffer = buffer;
+   _capacity = capacity & ~(size_t)(SIO_QUEUE_ALIGN - 1);
+   _maxCount = maxCount;
+   clear();
+   resetHighWater();
+}
+
+/**
+ * @brief Check whether a packet can ever be queued, even in an empty queue
+ *
+ * @param length size_t
+ * @return bool
+ */
+bool SocketIOPacketQueue::fits(size_t length) const { return ((sizeof(Record) + length + SIO_QUEUE_ALIGN - 1) & ~(size_t)(SIO_QUEUE_ALIGN - 1)) <= _capacity; }
+
+/**
+ * @brief Reserve room for a packet at the tail. The caller writes the packet
+ * into the returned pointer, then calls commit(). A reservation that is not
+ * committed is simply abandoned by the next reserve().
+ *
+ * @param length size_t maximum packet length
+ * @return uint8_t * NULL if the queue has no contiguous room for the packet
+ * or holds maxCount packets
+ */
+uint8_t *SocketIOPacketQueue::reserve(size_t length) {
+   if (_maxCount && _count >= _maxCount) {
+      return NULL;
+   }
+   return reserveScratch(length);
+}
+
+/**
+ * @brief Reserve room at the tail as reserve() does, without the maxCount
+ * bound: for scratch space that is used and abandoned, never committed
+ *
+ * @param length size_t
+ * @return uint8_t * NULL if the queue has no contiguous room
+ */
+uint8_t *SocketIOPacketQueue::reserveScratch(size_t length) {
+   if (!_buffer) {
+      return NULL;
+   }
+
+   size_t size = (sizeof(Record) + length + SIO_QUEUE_ALIGN - 1) & ~(size_t)(SIO_QUEUE_ALIGN - 1);
+   size_t at = _tail;
+
+   if (_count == 0) {
+      clear();
+      at = 0;
+      if (size > _capacity) {
+         return NULL;
+      }
+   } else if (_tail > _head) {
+      if (size > _capacity - _tail) {
+         // Not enough room before the end: wrap if the beginning is free enough
+         if (size > _head) {
+            return NULL;
+         }
+         at = 0;
+      }
+   } else if (_tail < _head) {
+      if (size > _head - _tail) {
+         return NULL;
+      }
+   } else {
+      // Full
+      return NULL;
+   }
+
+   _reservedAt = at;
+   _reservedSize = size;
+   _reservedLength = length;
+   return _buffer + at + sizeof(Record);
+}
+
+/**
+ * @brief Publish the packet written into the last reservation
+ *
+ * @param length size_t actual packet length, not more than the reserved one
+ */
+void SocketIOPacketQueue::commit(size_t length) {
+   if (!_reservedSize || length > _reservedLength) {
+      return;
+   }
+
+   _lastValid = true;
+   _lastAt = _reservedAt;
+   _lastTail = _tail;
+   _lastPadding = 0;
+   if (_reservedAt != _tail) {
+      // The packet wrapped, the end of the region becomes padding
+      size_t padding = _capacity - _tail;
+      if (padding >= sizeof(Record)) {
+         Record *wrap = recordAt(_tail);
+         wrap->size = padding;
+         wrap->length = SIO_QUEUE_WRAP;
+      }
+      _used += padding;
+      _lastPadding = padding;
+   }
+
+   Record *record = recordAt(_reservedAt);
+   record->size = _reservedSize;
+   record->length = length;
+
+   _tail = _reservedAt + _reservedSize;
+   if (_tail == _capacity) {
+      _tail = 0;
+   }
+   _used += _reservedSize;
+   _count++;
+   _reservedSize = 0;
+
+   if (_count > _highWaterCount) {
+      _highWaterCount = _count;
+   }
+   if (_used > _highWaterUsed) {
+      _highWaterUsed = _used;
+   }
+}
+
+/**
+ * @brief Room of a queued packet: the longest packet that can be rewritten in
+ * its place
+ *
+ * @param packet const uint8_t * returned by reserve() and committed
+ * @return size_t
+ */
+size_t SocketIOPacketQueue::room(const uint8_t *packet) const { return ((const Record *)packet - 1)->size - sizeof(Record); }
+
+/**
+ * @brief Change the length of a queued packet rewritten in place
+ *
+ * @param packet uint8_t * returned by reserve() and committed
+ * @param length size_t not more than room(packet)
+ * @return bool
+ */
+bool SocketIOPacketQueue::resize(uint8_t *packet, size_t length) {
+   Record *record = (Record *)packet - 1;
+   if (length > record->size - sizeof(Record)) {
+      return false;
+   }
+   record->length = length;
+   return true;
+}
+
+/**
+ * @brief Remove a queued packet out of order. If it is the last one committed,
+ * the queue is as it was before its commit; otherwise it no longer counts and
+ * its bytes are given back once the head reaches it.
+ *
+ * @param packet uint8_t * returned by reserve() and committed
+ */
+void SocketIOPacketQueue::discard(uint8_t *packet) {
+   Record *record = (Record *)packet - 1;
+   if (!_count || record->length == SIO_QUEUE_DISCARDED) {
+      return;
+   }
+   _count--;
+   if (_count == 0) {
+      clear();
+      return;
+   }
+   if (_lastValid && (uint8_t *)record == _buffer + _lastAt) {
+      _tail = _lastTail;
+      _used -= record->size + _lastPadding;
+      _lastValid = false;
+      return;
+   }
+   record->length = SIO_QUEUE_DISCARDED;
+}
+
+/**
+ * @brief Get the oldest packet
+ *
+ * @param length size_t * packet length
+ * @return uint8_t * NULL if the queue is empty
+ */
+uint8_t *SocketIOPacketQueue::front(size_t *length) {
+   if (_count == 0) {
+      return NULL;
+   }
+   skipDiscarded();
+   Record *record = recordAt(_head);
+   *length = record->length;
+   return (uint8_t *)(record + 1);
+}
+
+/**
+ * @brief Remove the oldest packet
+ *
+ */
+void SocketIOPacketQueue::pop(void) {
+   if (_count == 0) {
+      return;
+   }
+   skipDiscarded();
+   Record *record = recordAt(_head);
+   _head += record->size;
+   _used -= record->size;
+   _count--;
+
+   if (_count == 0) {
+      clear();
+   } else {
+      skipWrap();
+   }
+}
+
+/**
+ * @brief Drop every packet
+ *
+ */
+void SocketIOPacketQueue::clear(void) {
+   _head = 0;
+   _tail = 0;
+   _used = 0;
+   _count = 0;
+   _reservedSize = 0;
+   _lastValid = false;
+}
+
+/**
+ * @brief Restart the high-water marks from the current depth
+ *
+ */
+void SocketIOPacketQueue::resetHighWater(void) {
+   _highWaterCount = _count;
+   _highWaterUsed = _used;
+}
+
+/**
+ * @brief Move the head back to the beginning when it reached the padding left
+ * by a wrapped packet
+ *
+ */
+void SocketIOPacketQueue::skipWrap(void) {
+   if (_head == _capacity) {
+      _head = 0;
+   } else if (_capacity - _head < sizeof(Record)) {
+      _used -= _capacity - _head;
+      _head = 0;
+   } else if (recordAt(_head)->length == SIO_QUEUE_WRAP) {
+      _used -= recordAt(_head)->size;
+      _head = 0;
+   }
+}
+
+/**
+ * @brief Move the head past the discarded packets in front of it. Only called
+ * while a packet is queued, so one is found.
+ *
+ */
+void SocketIOPacketQueue::skipDiscarded(void) {
+   while (recordAt(_head)->length == SIO_QUEUE_DISCARDED) {
+      _used -= recordAt(_head)->size;
+      _head += recordAt(_head)->size;
+      skipWrap();
+   }
+}
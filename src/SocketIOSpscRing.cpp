@@ -0,0 +1,122 @@
+/*
+ * SocketIOSpscRing.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOSpscRing.h"
+
+#define SIO_RING_ALIGN 8
+#define SIO_RING_WRAP 0xFFFFFFFF
+
+SocketIOSpscRing::SocketIOSpscRing() : _head(0), _tail(0) {}
+
+SocketIOSpscRing::~SocketIOSpscRing() {}
+
+/**
+ * @brief Attach the ring to its storage, before both threads use it. The
+ * buffer must be 8-byte aligned and outlive the ring; only the largest power
+ * of two bytes of it are used.
+ *
+ * @param buffer uint8_t *
+ * @param capacity size_t
+ */
+void SocketIOSpscRing::begin(uint8_t *buffer, size_t capacity) {
+   size_t power = capacity ? SIO_RING_ALIGN : 0;
+   while (power && power <= capacity / 2) {
+      power *= 2;
+   }
+   _buffer = capacity >= SIO_RING_ALIGN ? buffer : NULL;
+   _capacity = _buffer ? power : 0;
+   _head.store(0, std::memory_order_relaxed);
+   _tail.store(0, std::memory_order_release);
+   _reservedSize = 0;
+}
+
+/**
+ * @brief Reserve room for a record at the tail (producer). The caller writes
+ * the record into the returned pointer, then calls commit().
+ *
+ * @param length size_t maximum record length
+ * @return uint8_t * NULL if the ring has no contiguous room for it now
+ */
+uint8_t *SocketIOSpscRing::reserve(size_t length) {
+   if (!_buffer) {
+      return NULL;
+   }
+
+   size_t size = (sizeof(Record) + length + SIO_RING_ALIGN - 1) & ~(size_t)(SIO_RING_ALIGN - 1);
+   size_t tail = _tail.load(std::memory_order_relaxed);
+   size_t free = _capacity - (tail - _head.load(std::memory_order_acquire));
+   size_t contiguous = _capacity - (tail & (_capacity - 1));
+
+   // Not enough room before the end: the rest of the region becomes padding
+   size_t padding = size > contiguous ? contiguous : 0;
+   if (size > _capacity || padding + size > free) {
+      return NULL;
+   }
+
+   _reservedPadding = padding;
+   _reservedSize = size;
+   _reservedLength = length;
+   return (uint8_t *)(recordAt(tail + padding) + 1);
+}
+
+/**
+ * @brief Publish the record written into the last reservation (producer)
+ *
+ * @param length size_t actual record length, not more than the reserved one
+ */
+void SocketIOSpscRing::commit(size_t length) {
+   if (!_reservedSize || length > _reservedLength) {
+      return;
+   }
+
+   size_t tail = _tail.load(std::memory_order_relaxed);
+   if (_reservedPadding) {
+      // Records are aligned: the padding always holds a wrap marker
+      Record *wrap = recordAt(tail);
+      wrap->size = _reservedPadding;
+      wrap->length = SIO_RING_WRAP;
+   }
+   Record *record = recordAt(tail + _reservedPadding);
+   record->size = _reservedSize;
+   record->length = length;
+
+   _tail.store(tail + _reservedPadding + _reservedSize, std::memory_order_release);
+   _reservedSize = 0;
+}
+
+/**
+ * @brief Get the oldest record (consumer). It stays valid and writable until
+ * pop().
+ *
+ * @param length size_t * record length
+ * @return uint8_t * NULL if the ring is empty
+ */
+uint8_t *SocketIOSpscRing::front(size_t *length) {
+   size_t head = _head.load(std::memory_order_relaxed);
+   size_t tail = _tail.load(std::memory_order_acquire);
+   while (head != tail) {
+      Record *record = recordAt(head);
+      if (record->length != SIO_RING_WRAP) {
+         *length = record->length;
+         return (uint8_t *)(record + 1);
+      }
+      head += record->size;
+      _head.store(head, std::memory_order_release);
+   }
+   return NULL;
+}
+
+/**
+ * @brief Remove the oldest record (consumer), after front() returned it
+ *
+ */
+void SocketIOSpscRing::pop(void) {
+   size_t head = _head.load(std::memory_order_relaxed);
+   if (head == _tail.load(std::memory_order_acquire)) {
+      return;
+   }
+   _head.store(head + recordAt(head)->size, std::memory_order_release);
+}
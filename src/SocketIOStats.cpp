@@ -0,0 +1,182 @@
+/*
+ * SocketIOStats.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOStats.h"
+
+#include "SocketIOFrameWriter.h"
+#include <string.h>
+
+/**
+ * @brief Forget every duration
+ *
+ */
+void SocketIOHistogram::reset(void) {
+   memset(_buckets, 0, sizeof(_buckets));
+   _count = 0;
+   _sum = 0;
+   _max = 0;
+}
+
+/**
+ * @brief Estimate a percentile: the upper bound of the bucket holding it,
+ * never more than the longest duration
+ *
+ * @param percent uint8_t 1 to 100
+ * @return uint32_t µs, 0 if nothing was recorded
+ */
+uint32_t SocketIOHistogram::percentile(uint8_t percent) const {
+   uint64_t rank = ((uint64_t)_count * percent + 99) / 100;
+   uint64_t seen = 0;
+   for (uint8_t i = 0; i < SIO_STATS_BUCKETS && rank; i++) {
+      seen += _buckets[i];
+      if (seen >= rank) {
+         return upperBound(i) < _max ? upperBound(i) : _max;
+      }
+   }
+   return _max;
+}
+
+/**
+ * @brief Zero every counter and histogram
+ *
+ */
+void SocketIOStats::reset(void) {
+   memset(eioIn, 0, sizeof(eioIn));
+   memset(eioOut, 0, sizeof(eioOut));
+   memset(sioIn, 0, sizeof(sioIn));
+   memset(sioOut, 0, sizeof(sioOut));
+   binaryIn = {0, 0};
+   binaryOut = {0, 0};
+   droppedPackets = 0;
+   lostPackets = 0;
+   unmatchedEvents = 0;
+   unmatchedAcks = 0;
+   parseFailures = 0;
+   reconnects = 0;
+   disconnects = 0;
+   pingTimeouts = 0;
+   volatileDrops = 0;
+   queueDepth = 0;
+   queueHighWater = 0;
+   priorityDepth = 0;
+   priorityHighWater = 0;
+   handlerTime.reset();
+   parseTime.reset();
+   queueDelay.reset();
+   priorityDelay.reset();
+   connectTime.reset();
+}
+
+// [[frames,bytes],...] by type
+static void writeTraffic(SocketIOFrameWriter &writer, const SocketIOTraffic *traffic, uint8_t count) {
+   writer.raw('[');
+   for (uint8_t i = 0; i < count; i++) {
+      if (i) {
+         writer.raw(',');
+      }
+      writer.raw('[');
+      writer.value(traffic[i].frames);
+      writer.raw(',');
+      writer.value(traffic[i].bytes);
+      writer.raw(']');
+   }
+   writer.raw(']');
+}
+
+// {"n":count,"sum":µs,"max":µs,"p50":µs,"p99":µs,"b":[buckets]}
+static void writeHistogram(SocketIOFrameWriter &writer, const SocketIOHistogram &histogram) {
+   writer.raw("{\"n\":", 5);
+   writer.value(histogram.count());
+   writer.raw(",\"sum\":", 7);
+   writer.value(histogram.sum());
+   writer.raw(",\"max\":", 7);
+   writer.value(histogram.max());
+   writer.raw(",\"p50\":", 7);
+   writer.value(histogram.percentile(50));
+   writer.raw(",\"p99\":", 7);
+   writer.value(histogram.percentile(99));
+   writer.raw(",\"b\":[", 6);
+   for (uint8_t i = 0; i < SIO_STATS_BUCKETS; i++) {
+      if (i) {
+         writer.raw(',');
+      }
+      writer.value(histogram.bucket(i));
+   }
+   writer.raw("]}", 2);
+}
+
+static void writeCounter(SocketIOFrameWriter &writer, const char *key, uint32_t value) {
+   writer.raw(',');
+   writer.value(key);
+   writer.raw(':');
+   writer.value(value);
+}
+
+/**
+ * @brief Write the snapshot as one compact JSON object: traffic as
+ * [frames,bytes] pairs indexed by packet type, histograms as buckets of
+ * SocketIOHistogram
+ *
+ * @param writer SocketIOFrameWriter &
+ */
+void SocketIOStats::write(SocketIOFrameWriter &writer) const {
+   writer.raw("{\"eio\":{\"in\":", 13);
+   writeTraffic(writer, eioIn, SIO_STATS_TYPES);
+   writer.raw(",\"out\":", 7);
+   writeTraffic(writer, eioOut, SIO_STATS_TYPES);
+   writer.raw("},\"sio\":{\"in\":", 14);
+   writeTraffic(writer, sioIn, SIO_STATS_TYPES);
+   writer.raw(",\"out\":", 7);
+   writeTraffic(writer, sioOut, SIO_STATS_TYPES);
+   writer.raw("},\"bin\":{\"in\":", 14);
+   writeTraffic(writer, &binaryIn, 1);
+   writer.raw(",\"out\":", 7);
+   writeTraffic(writer, &binaryOut, 1);
+   writer.raw('}');
+
+   writeCounter(writer, "dropped", droppedPackets);
+   writeCounter(writer, "lost", lostPackets);
+   writeCounter(writer, "unmatched", unmatchedEvents);
+   writeCounter(writer, "unmatchedAcks", unmatchedAcks);
+   writeCounter(writer, "parseFailures", parseFailures);
+   writeCounter(writer, "reconnects", reconnects);
+   writeCounter(writer, "disconnects", disconnects);
+   writeCounter(writer, "pingTimeouts", pingTimeouts);
+   writeCounter(writer, "volatileDropped", volatileDrops);
+   writeCounter(writer, "queue", queueDepth);
+   writeCounter(writer, "queueHighWater", queueHighWater);
+   writeCounter(writer, "priorityQueue", priorityDepth);
+   writeCounter(writer, "priorityHighWater", priorityHighWater);
+
+   writer.raw(",\"handler\":", 11);
+   writeHistogram(writer, handlerTime);
+   writer.raw(",\"parse\":", 9);
+   writeHistogram(writer, parseTime);
+   writer.raw(",\"delay\":", 9);
+   writeHistogram(writer, queueDelay);
+   writer.raw(",\"priorityDelay\":", 17);
+   writeHistogram(writer, priorityDelay);
+   writer.raw(",\"connect\":", 11);
+   writeHistogram(writer, connectTime);
+   writer.raw('}');
+}
+
+/**
+ * @brief Serialize the snapshot into buffer, like snprintf
+ *
+ * @param buffer char * NULL to measure
+ * @param capacity size_t
+ * @return size_t length of the JSON text; it was written (NUL terminated) only
+ * if less than capacity
+ */
+size_t SocketIOStats::toJson(char *buffer, size_t capacity) const {
+   SocketIOFrameWriter writer(buffer, capacity);
+   write(writer);
+   if (buffer && writer.length() < capacity) {
+      buffer[writer.length()] = '\0';
+   }
+   return writer.length();
+}
@@ -0,0 +1,256 @@
+/*
+ * SocketIOTask.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "SocketIOTask.h"
+
+#ifdef SIO_HAS_TASK
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(SIO_TASK_STD_THREAD)
+#include <chrono>
+#endif
+
+SocketIOTask::SocketIOTask(ArduinoSocketIOClient &client) : _client(client), _running(false), _connected(false), _outboundDrops(0), _inboundDrops(0) {
+#if defined(SIO_TASK_FREERTOS)
+   _stopped.store(true);
+#endif
+}
+
+SocketIOTask::~SocketIOTask() {
+   stop();
+   release();
+}
+
+/**
+ * @brief Set the sizes of the rings, allocated by start(). Not while the task
+ * runs.
+ *
+ * @param outboundBytes size_t packets emitted by the application, headers
+ * included (a power of two is used)
+ * @param inboundBytes size_t events received for it
+ * @return bool false if the task runs
+ */
+bool SocketIOTask::configure(size_t outboundBytes, size_t inboundBytes) {
+   if (isRunning()) {
+      return false;
+   }
+   release();
+   _outboundSize = outboundBytes;
+   _inboundSize = inboundBytes;
+   return true;
+}
+
+/**
+ * @brief Add a listener called by dispatch(), on the application's task
+ *
+ * @param event const char *
+ * @param handler SocketIOEventHandler gets the argument as JSON text,
+ * terminated
+ */
+void SocketIOTask::on(const char *event, SocketIOEventHandler handler) { _events.set(SocketIOEvent(event, SocketIOEventTable::hash(event)), handler); }
+
+/**
+ * @brief Hand the client over to a network task running its loop(). Call it
+ * after begin() and after the listeners of the client and of the task are
+ * registered: it takes onAny() of the client to feed the inbound ring.
+ *
+ * @param timeBudget uint32_t of each loop() call, see ArduinoSocketIOClient::loop
+ * @param byteBudget size_t
+ * @return bool false if it runs already or the rings or the task can not be
+ * created
+ */
+bool SocketIOTask::start(uint32_t timeBudget, size_t byteBudget) {
+   if (isRunning()) {
+      return false;
+   }
+   if (!_outboundBuffer) {
+      _outboundBuffer = (uint8_t *)malloc(_outboundSize);
+      _inboundBuffer = (uint8_t *)malloc(_inboundSize);
+      if (!_outboundBuffer || !_inboundBuffer) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] task rings of %u and %u bytes can not be allocated\n", _outboundSize, _inboundSize);
+         release();
+         return false;
+      }
+      _outbound.begin(_outboundBuffer, _outboundSize);
+      _inbound.begin(_inboundBuffer, _inboundSize);
+   }
+
+   _client.onAny([this](const char *event, const char *payload, size_t length) { receive(event, payload, length); });
+   _timeBudget = timeBudget;
+   _byteBudget = byteBudget;
+   _connected.store(_client.isConnected(), std::memory_order_release);
+   _running.store(true, std::memory_order_release);
+
+#if defined(SIO_TASK_STD_THREAD)
+   _thread = std::thread(&SocketIOTask::run, this);
+#else
+   _stopped.store(false);
+   if (xTaskCreatePinnedToCore(entry, "socketio", SIO_TASK_STACK_SIZE, this, SIO_TASK_PRIORITY, &_handle, SIO_TASK_CORE) != pdPASS) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] network task can not be created\n");
+      _stopped.store(true);
+      _running.store(false);
+      return false;
+   }
+#endif
+   return true;
+}
+
+/**
+ * @brief Stop the network task and wait for it: the client belongs to the
+ * caller again. What the rings hold is kept for the next start().
+ *
+ */
+void SocketIOTask::stop(void) {
+   if (!isRunning()) {
+      return;
+   }
+   _running.store(false, std::memory_order_release);
+#if defined(SIO_TASK_STD_THREAD)
+   if (_thread.joinable()) {
+      _thread.join();
+   }
+#else
+   while (!_stopped.load()) {
+      vTaskDelay(1);
+   }
+   _handle = NULL;
+#endif
+}
+
+/**
+ * @brief Call the listeners of the events received, on the application's
+ * task. Events without listener go to onAny(), if any.
+ *
+ * @param maxEvents size_t 0 for all of them
+ * @return size_t events taken from the inbound ring
+ */
+size_t SocketIOTask::dispatch(size_t maxEvents) {
+   size_t count = 0;
+   size_t length;
+   uint8_t *record;
+   while ((!maxEvents || count < maxEvents) && (record = _inbound.front(&length)) != NULL) {
+      const char *event = (const char *)record;
+      size_t eventLength = strlen(event);
+      const char *payload = event + eventLength + 1;
+      size_t payloadLength = length - eventLength - 2;
+
+      if (!_events.dispatch(event, payload, payloadLength) && _any) {
+         _any(event, payload, payloadLength);
+      }
+      _inbound.pop();
+      count++;
+   }
+   return count;
+}
+
+/**
+ * @brief Body of the network task: loop() until stop(), pausing when there is
+ * nothing to do
+ *
+ */
+void SocketIOTask::run(void) {
+   while (isRunning()) {
+      if (!loop()) {
+#if defined(SIO_TASK_STD_THREAD)
+         std::this_thread::sleep_for(std::chrono::microseconds(SIO_TASK_IDLE_DELAY));
+#else
+         TickType_t ticks = pdMS_TO_TICKS(SIO_TASK_IDLE_DELAY / 1000);
+         vTaskDelay(ticks ? ticks : 1);
+#endif
+      }
+   }
+}
+
+#if defined(SIO_TASK_FREERTOS)
+/**
+ * @brief FreeRTOS entry of the network task
+ *
+ * @param task void * the SocketIOTask
+ */
+void SocketIOTask::entry(void *task) {
+   SocketIOTask *self = (SocketIOTask *)task;
+   self->run();
+   self->_stopped.store(true);
+   vTaskDelete(NULL);
+}
+#endif
+
+/**
+ * @brief One round of the network task: write the packets of the outbound
+ * ring, oldest first, then run the loop() of the client
+ *
+ * @return bool true if work was done or is left
+ */
+bool SocketIOTask::loop(void) {
+   bool busy = false;
+   size_t length;
+   uint8_t *packet;
+   while (_client.isWritable() && (packet = _outbound.front(&length)) != NULL) {
+      busy = true;
+      uint32_t messageLength;
+      memcpy(&messageLength, packet, sizeof(messageLength));
+      if (!_client.fitsPayload(messageLength)) {
+         SOCKETIOCLIENT_DEBUG("[SIoC] packet larger than maxPayload dropped (%u bytes)\n", messageLength);
+         _client._stats.droppedPackets++;
+         _outbound.pop();
+         continue;
+      }
+      uint32_t stamp;
+      memcpy(&stamp, packet + SIO_PACKET_STAMP, sizeof(stamp));
+      if (!_client.sendPacket(packet, length)) {
+         // Left at the front of the ring as it was written: retried
+         SOCKETIOCLIENT_DEBUG("[SIoC] packet kept, connection broken while sending\n");
+         break;
+      }
+      _client._stats.queueDelay.record(micros() - stamp);
+      _outbound.pop();
+   }
+
+   busy = _client.loop(_timeBudget, _byteBudget) || busy;
+   _connected.store(_client.isConnected(), std::memory_order_release);
+   return busy;
+}
+
+/**
+ * @brief onAny() listener of the client, on the network task: copy the event
+ * into the inbound ring, or drop it when the ring is full
+ *
+ * @param event const char *
+ * @param payload const char *
+ * @param length size_t
+ */
+void SocketIOTask::receive(const char *event, const char *payload, size_t length) {
+   size_t eventLength = strlen(event);
+   uint8_t *record = _inbound.reserve(eventLength + length + 2);
+   if (!record) {
+      SOCKETIOCLIENT_DEBUG("[SIoC] inbound ring full, event %s dropped\n", event);
+      _inboundDrops.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   memcpy(record, event, eventLength + 1);
+   if (length) {
+      memcpy(record + eventLength + 1, payload, length);
+   }
+   record[eventLength + 1 + length] = '\0';
+   _inbound.commit(eventLength + length + 2);
+}
+
+/**
+ * @brief Free the rings
+ *
+ */
+void SocketIOTask::release(void) {
+   free(_outboundBuffer);
+   free(_inboundBuffer);
+   _outboundBuffer = NULL;
+   _inboundBuffer = NULL;
+   _outbound.begin(NULL, 0);
+   _inbound.begin(NULL, 0);
+}
+
+#endif /* SIO_HAS_TASK */
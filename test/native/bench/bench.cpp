@@ -0,0 +1,349 @@
+/*
+ * bench.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "AllocTracker.h"
+#include "ArduinoSocketIOClient.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Usage: sio_bench [--quick] [--csv] [--check]
+//   --quick  fewer iterations (smoke run)
+//   --csv    one CSV line per result, to diff two runs
+//   --check  exit with 1 if a hot path allocates
+
+/**
+ * Client with the internals the benchmarks drive
+ */
+class BenchClient : public ArduinoSocketIOClient {
+ public:
+   MockTransport &transport(void) { return _transport; }
+   void dispatch(const char *event, const char *payload, size_t length) { trigger(event, payload, length); }
+   void receive(WStype_t type, uint8_t *payload, size_t length) { handleCbEvent(type, payload, length); }
+   void dropQueue(void) {
+      while (!_packets.isEmpty()) {
+         popPacket(_packets);
+      }
+      while (!_priorityPackets.isEmpty()) {
+         popPacket(_priorityPackets);
+      }
+   }
+
+   // Ack id of the packet at the head of the normal lane
+   long queuedAckId(void) {
+      size_t length;
+      uint8_t *packet = _packets.front(&length);
+      return packet ? strtol((const char *)packet + SIO_MAX_HEADER_SIZE, NULL, 10) : -1;
+   }
+
+   // Connect and forget the handshake frames
+   void connect(socketIOencoding_t encoding = sIOencoding_JSON) {
+      begin("localhost", 3000, DEFAULT_PATH, DEFAULT_URL, DEFAULT_PROTOCOL, encoding);
+      _transport.open();
+      WebSocketsClient::loop();
+      _transport.capture(false);
+      _transport.clearWrites();
+   }
+};
+
+typedef struct {
+   std::string name;
+   std::string params;
+   size_t ops;
+   double nsPerOp;
+   double allocsPerOp;
+   size_t heapPeak;
+} Result;
+
+static std::vector<Result> results;
+static size_t iterations = 200000;
+
+static double now(void) { return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+/**
+ * @brief Time ops calls of op after a warm-up and record the result
+ *
+ * @param name const char *
+ * @param params std::string
+ * @param ops size_t
+ * @param op F void(size_t i)
+ */
+template <typename F>
+static void run(const char *name, const std::string &params, size_t ops, F op) {
+   for (size_t i = 0; i < ops / 10 + 1; i++) {
+      op(i);
+   }
+
+   AllocTracker::resetPeak();
+   size_t allocations = AllocTracker::allocations();
+   double start = now();
+   for (size_t i = 0; i < ops; i++) {
+      op(i);
+   }
+   double elapsed = now() - start;
+   allocations = AllocTracker::allocations() - allocations;
+
+   Result result = {name, params, ops, elapsed / ops, (double)allocations / ops, AllocTracker::peak()};
+   results.push_back(result);
+}
+
+static std::string repeat(char c, size_t n) { return std::string(n, c); }
+
+static std::string eventName(size_t i) { return "event-" + std::to_string(i); }
+
+static void benchHandleEvent(size_t payloadSize, size_t events) {
+   BenchClient client;
+   client.connect();
+   size_t received = 0;
+   for (size_t i = 0; i < events; i++) {
+      client.on(eventName(i).c_str(), [&](const char *payload, size_t length) { received += length; });
+   }
+
+   // Parsed in place: copied into the receive buffer before every call
+   std::string frame = "[\"" + eventName(events - 1) + "\",\"" + repeat('x', payloadSize) + "\"]";
+   std::vector<uint8_t> buffer(frame.size() + 1);
+   run("handleEvent", "payload=" + std::to_string(payloadSize) + " events=" + std::to_string(events), iterations / (1 + payloadSize / 256), [&](size_t) {
+      memcpy(buffer.data(), frame.c_str(), frame.size() + 1);
+      client.handleEvent(buffer.data(), frame.size());
+   });
+}
+
+// A large event in fragments, handed to a stream listener: the client holds
+// no more than the fragment being read
+static void benchStream(size_t messageSize, size_t fragmentSize) {
+   BenchClient client;
+   client.connect();
+   size_t received = 0;
+   client.onStream("config", [&](const char *chunk, size_t length, socketIOstreamState_t state) { received += length; });
+
+   std::string message = "42[\"config\",\"" + repeat('x', messageSize) + "\"]";
+   std::vector<uint8_t> buffer(fragmentSize + 1);
+   run("stream", "size=" + std::to_string(messageSize) + " fragment=" + std::to_string(fragmentSize), iterations / (1 + messageSize / 256), [&](size_t) {
+      for (size_t offset = 0; offset < message.size(); offset += fragmentSize) {
+         size_t length = offset + fragmentSize < message.size() ? fragmentSize : message.size() - offset;
+         memcpy(buffer.data(), message.data() + offset, length);
+         WStype_t type = offset == 0 ? WStype_FRAGMENT_TEXT_START : (offset + length < message.size() ? WStype_FRAGMENT : WStype_FRAGMENT_FIN);
+         client.receive(type, buffer.data(), length);
+      }
+   });
+}
+
+// Names resolved by a route among many: the cost follows the name length
+static void benchRoute(size_t routes) {
+   BenchClient client;
+   size_t calls = 0;
+   for (size_t i = 0; i < routes; i++) {
+      client.onRoute(("device/" + std::to_string(i) + "/*").c_str(), [&](const char *event, const char *payload, size_t length) { calls++; });
+   }
+   std::string name = "device/" + std::to_string(routes / 2) + "/relay/set";
+   run("route", "routes=" + std::to_string(routes) + " bytes=" + std::to_string(client.getRouteMemory()), iterations, [&](size_t) { client.dispatch(name.c_str(), "1", 1); });
+}
+
+static void benchTrigger(size_t events) {
+   BenchClient client;
+   size_t calls = 0;
+   std::vector<std::string> names;
+   for (size_t i = 0; i < events; i++) {
+      names.push_back(eventName(i));
+      client.on(names.back().c_str(), [&](const char *payload, size_t length) { calls++; });
+   }
+   run("trigger", "events=" + std::to_string(events), iterations, [&](size_t i) { client.dispatch(names[i % events].c_str(), "1", 1); });
+}
+
+static void benchEmit(size_t payloadSize) {
+   BenchClient client;
+   client.connect();
+   std::string payload = repeat('x', payloadSize);
+   // The queue is emptied (O(1)) every 16 packets, nothing is sent
+   run("emit", "payload=" + std::to_string(payloadSize), iterations / (1 + payloadSize / 256), [&](size_t i) {
+      client.emit("telemetry", payload.c_str());
+      if (i % 16 == 15) {
+         client.dropQueue();
+      }
+   });
+}
+
+static void benchEmitArgs(void) {
+   BenchClient client;
+   client.connect();
+   run("emit", "args=int,int,bool", iterations, [&](size_t i) {
+      client.emit("move", (int)i, -(int)i, true);
+      if (i % 16 == 15) {
+         client.dropQueue();
+      }
+   });
+}
+
+static void benchEmitWithAck(void) {
+   BenchClient client;
+   client.connect();
+   char ack[32];
+   size_t answers = 0;
+   // Each ack is answered at once: its slot is taken and given back
+   run("emitWithAck", "args=int", iterations, [&](size_t i) {
+      client.emitWithAck("ask", 1000, [&](const char *payload, size_t length) { answers++; }, (int)i);
+      size_t length = snprintf(ack, sizeof(ack), "43%ld[1]", client.queuedAckId());
+      client.receive(WStype_TEXT, (uint8_t *)ack, length);
+      client.dropQueue();
+   });
+   if (answers != iterations + iterations / 10 + 1) {
+      fprintf(stderr, "emitWithAck: %zu acks answered\n", answers);
+   }
+}
+
+static void benchEmitVolatile(size_t payloadSize) {
+   BenchClient client;
+   client.connect();
+   std::string payload = repeat('x', payloadSize);
+   // Written at once from the frame buffer, the queue stays empty
+   run("emitVolatile", "payload=" + std::to_string(payloadSize), iterations, [&](size_t) { client.emitVolatile("telemetry", payload.c_str()); });
+}
+
+static void benchSend(size_t payloadSize) {
+   BenchClient client;
+   client.connect();
+   std::string payload = "[\"telemetry\",\"" + repeat('x', payloadSize) + "\"]";
+   run("send", "payload=" + std::to_string(payloadSize), iterations / (1 + payloadSize / 256), [&](size_t) { client.send(sIOtype_EVENT, payload.c_str(), payload.size()); });
+}
+
+static void benchDrain(size_t payloadSize, size_t batch) {
+   BenchClient client;
+   client.connect();
+   std::string payload = repeat('x', payloadSize);
+   size_t rounds = iterations / batch / (1 + payloadSize / 256) + 1;
+
+   // Only loop() is timed: it sends the batch queued before
+   double elapsed = 0;
+   size_t allocations = 0;
+   AllocTracker::resetPeak();
+   for (size_t r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < batch; i++) {
+         client.emit("telemetry", payload.c_str());
+      }
+      size_t before = AllocTracker::allocations();
+      double start = now();
+      client.loop();
+      elapsed += now() - start;
+      allocations += AllocTracker::allocations() - before;
+   }
+
+   size_t packets = rounds * batch;
+   Result result = {"loop", "payload=" + std::to_string(payloadSize) + " batch=" + std::to_string(batch), packets, elapsed / packets, (double)allocations / packets, AllocTracker::peak()};
+   results.push_back(result);
+}
+
+// The same event in both encodings: bytes on the wire, emit (encoded into the
+// queue) and receive (decoded and dispatched)
+static void benchEncoding(socketIOencoding_t encoding, bool binary) {
+   BenchClient client;
+   client.connect(encoding);
+   uint8_t blob[64] = {0};
+   auto emit = [&](size_t i) {
+      return binary ? client.emit("telemetry", (int)i, -56, 70000, true, "ok", SocketIOBinary(blob, sizeof(blob))) : client.emit("telemetry", (int)i, -56, 70000, true, "ok");
+   };
+
+   // Frames as the server gets them, received back as they are
+   client.transport().capture(true);
+   emit(1234);
+   client.loop();
+   std::vector<MockFrame> frames = client.transport().frames();
+   client.transport().capture(false);
+   size_t bytes = 0;
+   for (const MockFrame &frame : frames) {
+      bytes += frame.data.size();
+   }
+   std::string params = std::string(encoding == sIOencoding_MSGPACK ? "msgpack" : "json") + (binary ? " +bin64" : "") + " wire=" + std::to_string(bytes);
+
+   run("encode", params, iterations, [&](size_t i) {
+      emit(i);
+      if (i % 16 == 15) {
+         client.dropQueue();
+      }
+   });
+
+   size_t received = 0;
+   client.on("telemetry", [&](const char *payload, size_t length) { received += length; });
+   std::vector<uint8_t> buffer(bytes + 1);
+   run("decode", params, iterations, [&](size_t) {
+      // Parsed in place: copied into the receive buffer before every call
+      for (const MockFrame &frame : frames) {
+         memcpy(buffer.data(), frame.data.c_str(), frame.data.size() + 1);
+         client.receive(frame.opcode == WSop_binary ? WStype_BIN : WStype_TEXT, buffer.data(), frame.data.size());
+      }
+   });
+}
+
+int main(int argc, char **argv) {
+   bool csv = false;
+   bool check = false;
+   for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      if (arg == "--quick") {
+         iterations = 2000;
+      } else if (arg == "--csv") {
+         csv = true;
+      } else if (arg == "--check") {
+         check = true;
+      } else {
+         fprintf(stderr, "usage: %s [--quick] [--csv] [--check]\n", argv[0]);
+         return 2;
+      }
+   }
+
+   for (size_t events : {1, 16, 256}) {
+      for (size_t payloadSize : {16, 256, 4096}) {
+         benchHandleEvent(payloadSize, events);
+      }
+   }
+   benchStream(65536, 1024);
+   for (size_t routes : {1, 16, 256, 4096}) {
+      benchRoute(routes);
+   }
+   for (size_t events : {1, 16, 256, 1024}) {
+      benchTrigger(events);
+   }
+   for (size_t payloadSize : {16, 256, 1024}) {
+      benchEmit(payloadSize);
+   }
+   benchEmitArgs();
+   benchEmitWithAck();
+   for (size_t payloadSize : {16, 128}) {
+      benchEmitVolatile(payloadSize);
+   }
+   for (size_t payloadSize : {16, 256, 1024}) {
+      benchSend(payloadSize);
+   }
+   for (size_t payloadSize : {16, 256}) {
+      benchDrain(payloadSize, 8);
+   }
+   for (bool binary : {false, true}) {
+      benchEncoding(sIOencoding_JSON, binary);
+      benchEncoding(sIOencoding_MSGPACK, binary);
+   }
+
+   if (csv) {
+      printf("benchmark,params,ops,ns_per_op,ops_per_s,allocs_per_op,heap_peak_bytes\n");
+   } else {
+      printf("%-12s %-26s %10s %10s %12s %10s %10s\n", "benchmark", "params", "ops", "ns/op", "ops/s", "allocs/op", "heap peak");
+   }
+   bool allocates = false;
+   for (const Result &r : results) {
+      double opsPerSecond = r.nsPerOp > 0 ? 1e9 / r.nsPerOp : 0;
+      if (csv) {
+         printf("%s,%s,%zu,%.1f,%.0f,%.3f,%zu\n", r.name.c_str(), r.params.c_str(), r.ops, r.nsPerOp, opsPerSecond, r.allocsPerOp, r.heapPeak);
+      } else {
+         printf("%-12s %-26s %10zu %10.1f %12.0f %10.3f %10zu\n", r.name.c_str(), r.params.c_str(), r.ops, r.nsPerOp, opsPerSecond, r.allocsPerOp, r.heapPeak);
+      }
+      allocates |= r.allocsPerOp > 0;
+   }
+
+   if (check && allocates) {
+      fprintf(stderr, "a hot path allocates\n");
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,425 @@
+/*
+ * latency.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "ArduinoSocketIOClient.h"
+#include "LoopbackServer.h"
+#include "SocketIOTask.h"
+#include "TcpTransport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Usage: sio_latency [--quick] [--csv]
+//   --quick  fewer samples (smoke run)
+//   --csv    one CSV line per result, to diff two runs
+//
+// Drives the client (begin, loop, emit, handlers) over TCP against the
+// LoopbackServer on 127.0.0.1. Exits with 1 if the server does not answer.
+
+/**
+ * Client connected through a real socket
+ */
+class LoopbackClient : public ArduinoSocketIOClient {
+ public:
+   LoopbackClient(void) { useTransport(&_tcp); }
+
+ protected:
+   TcpTransport _tcp;
+};
+
+typedef struct {
+   std::string name;
+   std::string params;
+   size_t samples;
+   double p50; ///< µs
+   double p99;
+   double p999;
+   double eventsPerSecond;
+} Result;
+
+static std::vector<Result> results;
+static LoopbackServer server;
+static uint16_t port;
+
+#ifndef LATENCY_TIMEOUT
+#define LATENCY_TIMEOUT 2000 // ms
+#endif
+
+static long long now(void) { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+/**
+ * @brief Run the client until done() or LATENCY_TIMEOUT
+ *
+ * @param client LoopbackClient &
+ * @param done F bool()
+ */
+template <typename F>
+static void loopUntil(LoopbackClient &client, F done) {
+   long long deadline = now() + (long long)LATENCY_TIMEOUT * 1000000;
+   while (!done()) {
+      client.loop();
+      if (now() > deadline) {
+         fprintf(stderr, "no answer from the loopback server\n");
+         exit(1);
+      }
+   }
+}
+
+static void connect(LoopbackClient &client) {
+   bool welcome = false;
+   client.on("welcome", [&](const char *payload, size_t length) { welcome = true; });
+   client.begin("127.0.0.1", port);
+   loopUntil(client, [&]() { return welcome; });
+}
+
+static void record(const char *name, const std::string &params, std::vector<double> &samples) {
+   std::sort(samples.begin(), samples.end());
+   size_t n = samples.size();
+   Result result = {name, params, n, samples[n / 2] / 1000, samples[std::min(n - 1, n * 99 / 100)] / 1000, samples[std::min(n - 1, n * 999 / 1000)] / 1000, 0};
+   results.push_back(result);
+}
+
+// begin() to the first event of the server, a new connection each time, and
+// the connect-to-ready time measured by the client
+static void benchConnect(size_t samples) {
+   std::vector<double> latencies;
+   std::vector<double> ready;
+   for (size_t i = 0; i < samples; i++) {
+      LoopbackClient client;
+      long long start = now();
+      connect(client);
+      latencies.push_back(now() - start);
+      ready.push_back(client.getStats().connectTime.sum() * 1000.0);
+   }
+   record("connect", "to first event", latencies);
+   record("connect", "to namespace ready", ready);
+}
+
+// emit() to the packet handled by the server
+static void benchEmitToServer(size_t samples) {
+   LoopbackClient client;
+   connect(client);
+
+   std::mutex lock;
+   std::vector<double> latencies;
+   server.onPacket([&](const char *packet, size_t length) {
+      long long arrival = now();
+      const char *stamp = (const char *)memchr(packet, ',', length);
+      if (stamp) {
+         std::lock_guard<std::mutex> guard(lock);
+         latencies.push_back(arrival - strtoll(stamp + 1, NULL, 10));
+      }
+   });
+   for (size_t i = 0; i < samples; i++) {
+      size_t events = server.events();
+      client.emit("stamp", now());
+      loopUntil(client, [&]() { return server.events() > events; });
+   }
+   server.onPacket(NULL);
+   record("emit", "to server", latencies);
+}
+
+// emit() to the echo of the server handled by the client
+static void benchEcho(size_t samples) {
+   LoopbackClient client;
+   connect(client);
+
+   std::vector<double> latencies;
+   client.on("echo", [&](const char *payload, size_t length) { latencies.push_back(now() - strtoll(payload, NULL, 10)); });
+   for (size_t i = 0; i < samples; i++) {
+      client.emit("echo", now());
+      loopUntil(client, [&]() { return latencies.size() > i; });
+   }
+   record("round trip", "echo event", latencies);
+}
+
+// emitWithAck() to the ack callback
+static void benchAck(size_t samples) {
+   LoopbackClient client;
+   connect(client);
+
+   std::vector<double> latencies;
+   for (size_t i = 0; i < samples; i++) {
+      client.emitWithAck("ask", LATENCY_TIMEOUT, [&](const char *payload, size_t length) { latencies.push_back(payload ? now() - strtoll(payload, NULL, 10) : 0); }, now());
+      loopUntil(client, [&]() { return latencies.size() > i; });
+   }
+   record("round trip", "ack", latencies);
+}
+
+// Engine.IO ping of the server to the pong of the client
+static void benchPing(size_t samples) {
+   LoopbackClient client;
+   connect(client);
+
+   std::vector<double> latencies;
+   for (size_t i = 0; i < samples; i++) {
+      size_t pongs = server.pongs();
+      long long start = now();
+      server.ping();
+      loopUntil(client, [&]() { return server.pongs() > pongs; });
+      latencies.push_back(now() - start);
+   }
+   record("round trip", "ping/pong", latencies);
+}
+
+// A control event emitted behind a burst of telemetry, in the normal lane then
+// in the high priority one: emit() to the packet handled by the server
+static void benchPriority(size_t samples) {
+   LoopbackClient client;
+   connect(client);
+
+   std::mutex lock;
+   std::vector<double> latencies;
+   server.onPacket([&](const char *packet, size_t length) {
+      long long arrival = now();
+      size_t at = std::string(packet, length).find("[\"alarm\",");
+      if (at != std::string::npos) {
+         std::lock_guard<std::mutex> guard(lock);
+         latencies.push_back(arrival - strtoll(packet + at + 9, NULL, 10));
+      }
+   });
+   for (socketIOpriority_t priority : {sIOpriority_NORMAL, sIOpriority_HIGH}) {
+      latencies.clear();
+      for (size_t i = 0; i < samples; i++) {
+         size_t events = server.events();
+         for (int j = 0; j < 32; j++) {
+            client.emit("tick", j);
+         }
+         client.emitWithPriority(priority, "alarm", now());
+         loopUntil(client, [&]() { return server.events() >= events + 33; });
+      }
+      std::lock_guard<std::mutex> guard(lock);
+      record("control", priority == sIOpriority_HIGH ? "behind 32, high" : "behind 32, normal", latencies);
+   }
+   server.onPacket(NULL);
+}
+
+// Events sent back to back until the server handled them all
+static void benchOutbound(size_t events) {
+   LoopbackClient client;
+   connect(client);
+
+   size_t first = server.events();
+   long long start = now();
+   for (size_t i = 0; i < events; i++) {
+      client.emit("tick", (int)i);
+      client.loop();
+   }
+   loopUntil(client, [&]() { return server.events() >= first + events; });
+   Result result = {"sustained", "client to server", events, 0, 0, 0, events * 1e9 / (now() - start)};
+   results.push_back(result);
+}
+
+// Events emitted by the server as fast as it can, handled by the client
+static void benchInbound(size_t events) {
+   LoopbackClient client;
+   connect(client);
+
+   size_t received = 0;
+   client.on("tick", [&](const char *payload, size_t length) { received++; });
+   long long start = now();
+   std::thread sender([&]() {
+      for (size_t i = 0; i < events; i++) {
+         server.emit("2[\"tick\"," + std::to_string(i) + "]");
+      }
+   });
+   long long deadline = now() + (long long)LATENCY_TIMEOUT * 1000000 + events * 10000LL;
+   while (received < events && now() < deadline) {
+      client.loop(1000);
+   }
+   sender.join();
+   if (received < events) {
+      fprintf(stderr, "%zu of %zu events received\n", received, events);
+      exit(1);
+   }
+   Result result = {"sustained", "server to client", events, 0, 0, 0, events * 1e9 / (now() - start)};
+   results.push_back(result);
+}
+
+/**
+ * @brief Wait for done() on the application thread, dispatching the events of
+ * the task, exit after timeout milliseconds
+ *
+ * @param task SocketIOTask &
+ * @param timeout long long
+ * @param done F bool()
+ */
+template <typename F>
+static void dispatchUntil(SocketIOTask &task, long long timeout, F done) {
+   long long deadline = now() + timeout * 1000000;
+   while (!done()) {
+      task.dispatch();
+      if (now() > deadline) {
+         fprintf(stderr, "no answer from the loopback server\n");
+         exit(1);
+      }
+      std::this_thread::yield();
+   }
+}
+
+// Events emitted by the application thread into the task's ring, written by
+// the network task, until the server handled them all
+static void benchTaskOutbound(size_t events) {
+   LoopbackClient client;
+   connect(client);
+   SocketIOTask task(client);
+   task.start();
+
+   size_t first = server.events();
+   long long start = now();
+   for (size_t i = 0; i < events; i++) {
+      while (task.emit("tick", (int)i) == sIOemit_REJECTED) {
+         std::this_thread::yield();
+      }
+   }
+   dispatchUntil(task, LATENCY_TIMEOUT + events / 100, [&]() { return server.events() >= first + events; });
+   Result result = {"threaded", "app to server", events, 0, 0, 0, events * 1e9 / (now() - start)};
+   results.push_back(result);
+   task.stop();
+}
+
+// Events emitted by the server as fast as it can, read by the network task
+// and dispatched on the application thread. The inbound ring holds the whole
+// burst: on a single core the network task may run through it before the
+// application thread gets the processor.
+static void benchTaskInbound(size_t events) {
+   LoopbackClient client;
+   connect(client);
+   SocketIOTask task(client);
+   size_t received = 0;
+   task.on("tick", [&](const char *payload, size_t length) { received++; });
+   task.configure(SIO_TASK_OUTBOUND_SIZE, events * 32);
+   task.start();
+
+   long long start = now();
+   std::thread sender([&]() {
+      for (size_t i = 0; i < events; i++) {
+         server.emit("2[\"tick\"," + std::to_string(i) + "]");
+      }
+   });
+   dispatchUntil(task, LATENCY_TIMEOUT + events / 100, [&]() { return received + task.getInboundDrops() >= events; });
+   sender.join();
+   if (task.getInboundDrops()) {
+      fprintf(stderr, "%zu of %zu events dropped by the inbound ring\n", task.getInboundDrops(), events);
+   }
+   Result result = {"threaded", "server to app", events, 0, 0, 0, received * 1e9 / (now() - start)};
+   results.push_back(result);
+   task.stop();
+}
+
+// Connection cut by the server to the events broadcast meanwhile replayed:
+// the backoff wait, then the reconnection recovering the session
+static void benchReconnect(size_t samples) {
+   const uint32_t delay = 20; // ms, +/- 50%
+   LoopbackClient client;
+   client.configureReconnect(delay, delay * 4, 50);
+   server.enableRecovery(true);
+   connect(client);
+
+   std::vector<long> received;
+   client.on("seq", [&](const char *payload, size_t length) { received.push_back(strtol(payload, NULL, 10)); });
+   server.broadcast("[\"seq\",0]");
+   loopUntil(client, [&]() { return received.size() == 1; });
+
+   std::vector<double> latencies;
+   size_t recovered = server.recovered();
+   for (size_t i = 1; i <= samples; i++) {
+      server.dropClient();
+      loopUntil(client, [&]() { return !client.isConnected(); });
+      long long lost = now();
+      uint32_t wait = client.getReconnectDelay();
+      if (wait < delay / 2 || wait > delay * 3 / 2) {
+         fprintf(stderr, "reconnect wait %u ms out of [%u, %u]\n", wait, delay / 2, delay * 3 / 2);
+         exit(1);
+      }
+      server.broadcast("[\"seq\"," + std::to_string(i) + "]");
+      loopUntil(client, [&]() { return received.size() > i; });
+      long long elapsed = now() - lost;
+      if (elapsed < (long long)(wait - 1) * 1000000) {
+         fprintf(stderr, "reconnected after %lld us, before the %u ms wait\n", elapsed / 1000, wait);
+         exit(1);
+      }
+      latencies.push_back(elapsed);
+   }
+   server.enableRecovery(false);
+
+   // Every missed event replayed once, in order, by a recovered session
+   for (size_t i = 0; i < received.size(); i++) {
+      if (received[i] != (long)i) {
+         fprintf(stderr, "event %zu replayed as %ld\n", i, received[i]);
+         exit(1);
+      }
+   }
+   if (!client.isRecovered() || server.recovered() - recovered != samples) {
+      fprintf(stderr, "%zu of %zu sessions recovered\n", server.recovered() - recovered, samples);
+      exit(1);
+   }
+   record("reconnect", "20 ms +/-50%, replay", latencies);
+}
+
+int main(int argc, char **argv) {
+   bool csv = false;
+   size_t samples = 10000;
+   size_t connects = 200;
+   size_t events = 100000;
+   size_t reconnects = 200;
+   for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      if (arg == "--quick") {
+         samples = 200;
+         connects = 20;
+         events = 2000;
+         reconnects = 10;
+      } else if (arg == "--csv") {
+         csv = true;
+      } else {
+         fprintf(stderr, "usage: %s [--quick] [--csv]\n", argv[0]);
+         return 2;
+      }
+   }
+
+   server.setWelcome("welcome");
+   port = server.start();
+   if (port == 0) {
+      fprintf(stderr, "cannot listen on 127.0.0.1\n");
+      return 1;
+   }
+
+   benchConnect(connects);
+   benchEmitToServer(samples);
+   benchEcho(samples);
+   benchAck(samples);
+   benchPing(samples);
+   benchPriority(samples / 10);
+   benchOutbound(events);
+   benchInbound(events);
+   benchTaskOutbound(events);
+   benchTaskInbound(events);
+   benchReconnect(reconnects);
+   server.stop();
+
+   if (csv) {
+      printf("benchmark,params,samples,p50_us,p99_us,p999_us,events_per_s\n");
+   } else {
+      printf("%-12s %-18s %8s %10s %10s %10s %12s\n", "benchmark", "params", "samples", "p50 us", "p99 us", "p999 us", "events/s");
+   }
+   for (const Result &r : results) {
+      if (csv) {
+         printf("%s,%s,%zu,%.1f,%.1f,%.1f,%.0f\n", r.name.c_str(), r.params.c_str(), r.samples, r.p50, r.p99, r.p999, r.eventsPerSecond);
+      } else if (r.eventsPerSecond > 0) {
+         printf("%-12s %-18s %8zu %10s %10s %10s %12.0f\n", r.name.c_str(), r.params.c_str(), r.samples, "", "", "", r.eventsPerSecond);
+      } else {
+         printf("%-12s %-18s %8zu %10.1f %10.1f %10.1f %12s\n", r.name.c_str(), r.params.c_str(), r.samples, r.p50, r.p99, r.p999, "");
+      }
+   }
+   return 0;
+}
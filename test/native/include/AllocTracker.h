@@ -0,0 +1,25 @@
+/**
+ * AllocTracker.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef ALLOCTRACKER_H_
+#define ALLOCTRACKER_H_
+
+#include <stddef.h>
+
+/**
+ * Heap usage of the process, counted by malloc / free replacements (glibc):
+ * every allocation of the library, of std::function and of operator new goes
+ * through them.
+ */
+namespace AllocTracker {
+size_t allocations(void); ///< malloc / calloc / realloc calls so far
+size_t inUse(void);       ///< Bytes allocated now
+size_t peak(void);        ///< Highest inUse() since resetPeak()
+void resetPeak(void);
+} // namespace AllocTracker
+
+#endif /* ALLOCTRACKER_H_ */
@@ -0,0 +1,59 @@
+/**
+ * Arduino.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef NATIVE_ARDUINO_H_
+#define NATIVE_ARDUINO_H_
+
+// Stand-in for the Arduino core on a host build: the parts the library uses
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+
+// Move the clock seen by millis() / micros() forward, to run timeouts without
+// waiting for them
+void advanceClock(unsigned long ms);
+
+// rand() based, like the ESP8266 core once randomSeed() was called
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+void hexdump(const void *mem, uint32_t len, uint8_t cols = 16);
+
+class String {
+ public:
+   String(const char *str = "") : _str(str ? str : "") {}
+   String(const std::string &str) : _str(str) {}
+
+   const char *c_str(void) const { return _str.c_str(); }
+   unsigned int length(void) const { return _str.length(); }
+   int indexOf(const char *str) const {
+      size_t at = _str.find(str);
+      return at == std::string::npos ? -1 : (int)at;
+   }
+
+   String &operator+=(const String &str) {
+      _str += str._str;
+      return *this;
+   }
+   bool operator==(const String &str) const { return _str == str._str; }
+   bool operator!=(const String &str) const { return _str != str._str; }
+
+ protected:
+   std::string _str;
+};
+
+#endif /* NATIVE_ARDUINO_H_ */
@@ -0,0 +1,94 @@
+/**
+ * LoopbackServer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef LOOPBACKSERVER_H_
+#define LOOPBACKSERVER_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Engine.IO v4 / Socket.IO v4 server standing in for a real one on
+ * 127.0.0.1, over WebSocket only (transport=websocket in the URL), serving one
+ * client at a time on its own thread:
+ *    - sends the Engine.IO OPEN packet, answers "2probe" with "3probe" and
+ *      the client pings with a pong, ignores the upgrade ("5")
+ *    - accepts the CONNECT of any namespace, then emits the welcome event
+ *    - sends the "echo" events back, answers the events asking for an ack
+ *      with their arguments
+ *    - with enableRecovery, recovers the connection state of the main
+ *      namespace like connectionStateRecovery: the CONNECT answer carries a
+ *      pid, broadcast events an offset, and a client presenting both back
+ *      gets the events broadcast since
+ */
+class LoopbackServer {
+ public:
+   /**
+    * Socket.IO packet received from the client ("2[\"event\",...]"), called on
+    * the server thread: set it while the client sends nothing
+    */
+   typedef std::function<void(const char *packet, size_t length)> PacketHandler;
+
+   LoopbackServer(void);
+   virtual ~LoopbackServer(void);
+
+   uint16_t start(void);
+   void stop(void);
+
+   void onPacket(PacketHandler handler) { _handler = handler; }
+   void setWelcome(const char *event) { _welcome = event; }
+   void enableRecovery(bool enable) { _recovery = enable; }
+
+   bool broadcast(const std::string &event);
+   void dropClient(void);
+
+   bool emit(const std::string &packet);
+   bool ping(void);
+
+   size_t connections(void) const { return _connections; }
+   size_t events(void) const { return _events; }
+   size_t pongs(void) const { return _pongs; }
+   size_t recovered(void) const { return _recovered; }
+
+ protected:
+   int _listener = -1;
+   int _client = -1;
+   std::mutex _sendLock; ///< Guards _client: the owner thread sends too
+   std::thread _thread;
+   std::atomic<bool> _running{false};
+   PacketHandler _handler;
+   std::string _welcome;
+   std::atomic<size_t> _connections{0};
+   std::atomic<size_t> _events{0};
+   std::atomic<size_t> _pongs{0};
+
+   // Connection state recovery of the main namespace
+   std::atomic<bool> _recovery{false};
+   std::mutex _logLock; ///< Guards the fields below: broadcast() runs on the owner thread
+   std::vector<std::string> _log; ///< Events broadcast, offset i + 1 at index i
+   bool _joined = false;          ///< The client joined the main namespace
+   size_t _sessions = 0;
+   std::string _pid;
+   std::atomic<size_t> _recovered{0};
+
+   void run(void);
+   bool upgrade(int fd, std::string &rest);
+   void serve(int fd, std::string &received);
+   void handleEngineIO(const std::string &text);
+   void handleSocketIO(const char *packet, size_t length);
+   void connectMain(const std::string &auth);
+   bool sendText(const std::string &text);
+   void closeClient(void);
+};
+
+#endif /* LOOPBACKSERVER_H_ */
@@ -0,0 +1,89 @@
+/**
+ * MockTransport.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef MOCKTRANSPORT_H_
+#define MOCKTRANSPORT_H_
+
+#include <deque>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * WebSocket frame as the server sees it: unmasked, data NUL terminated
+ */
+struct MockFrame {
+   uint8_t opcode;
+   bool fin;
+   std::string data;
+   uint8_t maskKey[4]; ///< Zero when the frame is not masked
+};
+
+/**
+ * In-memory connection standing in for the TCP client of the host build. The
+ * client writes its frames to it (every write is counted, the byte stream is
+ * decoded back into frames) and reads the frames pushed by the test or
+ * benchmark playing the server.
+ */
+class MockTransport {
+ public:
+   MockTransport(void);
+   virtual ~MockTransport(void);
+
+   // Client side
+   virtual void begin(const char *host, uint16_t port, const char *url) {}
+   virtual void poll(void) {
+      if (!_connected) {
+         _attempts++;
+      }
+   }
+   virtual int available(void) const { return (int)_inboundBytes; }
+   virtual size_t write(const uint8_t *data, size_t length);
+   virtual bool connected(void) const { return _connected; }
+   virtual bool nextInbound(MockFrame &frame);
+
+   // Server side: the next WebSocketsClient::loop() sees the change
+   void open(void) { _connected = true; }
+   virtual void close(void);
+   void receiveText(const char *text, size_t length = 0);
+   void receiveBinary(const uint8_t *data, size_t length);
+   void receiveFragments(const char *text, size_t fragmentSize, size_t length = 0);
+
+   // Connection attempts: poll() calls while not connected
+   size_t attempts(void) const { return _attempts; }
+
+   // What the client wrote
+   void capture(bool enable) { _capture = enable; }
+   void failWrites(bool fail) { _failWrites = fail; }
+   void failWritesAfter(size_t writes) { _writesLeft = writes + 1; }
+   size_t writes(void) const { return _writes; }
+   size_t bytes(void) const { return _bytes; }
+   const std::vector<MockFrame> &frames(void) const { return _frames; }
+   void clearWrites(void);
+
+   // WebSocket framing (RFC 6455) shared with the loopback server
+   static size_t decodeFrame(const uint8_t *data, size_t length, MockFrame &frame);
+   static void encodeFrame(std::vector<uint8_t> &out, uint8_t opcode, const char *data, size_t length);
+
+ protected:
+   bool _connected = false;
+   bool _capture = true;
+   bool _failWrites = false;
+   size_t _writesLeft = 0; ///< Writes before failWrites(true), plus one
+   size_t _attempts = 0;
+   size_t _writes = 0;
+   size_t _bytes = 0;
+   std::vector<uint8_t> _stream; ///< Written bytes not decoded yet
+   std::vector<MockFrame> _frames;
+   std::deque<MockFrame> _inbound;
+   size_t _inboundBytes = 0;
+
+   void decode(void);
+};
+
+#endif /* MOCKTRANSPORT_H_ */
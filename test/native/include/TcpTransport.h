@@ -0,0 +1,45 @@
+/**
+ * TcpTransport.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef TCPTRANSPORT_H_
+#define TCPTRANSPORT_H_
+
+#include "MockTransport.h"
+
+/**
+ * Transport of the host build over a real TCP socket: begin() gives the
+ * server, poll() connects and does the WebSocket upgrade, writes go to the
+ * socket and received server frames are read without blocking. Used to run the
+ * client against the LoopbackServer.
+ */
+class TcpTransport : public MockTransport {
+ public:
+   TcpTransport(void);
+   virtual ~TcpTransport(void);
+
+   void begin(const char *host, uint16_t port, const char *url) override;
+   void poll(void) override;
+   int available(void) const override;
+   size_t write(const uint8_t *data, size_t length) override;
+   bool connected(void) const override { return _fd >= 0 && _upgraded; }
+   bool nextInbound(MockFrame &frame) override;
+   void close(void) override;
+
+ protected:
+   std::string _host;
+   uint16_t _port = 0;
+   std::string _url;
+   int _fd = -1;
+   bool _upgraded = false;
+   std::vector<uint8_t> _received; ///< Received bytes
+   size_t _readAt = 0;             ///< Start of the bytes not decoded yet
+
+   bool upgrade(void);
+   bool receive(void);
+};
+
+#endif /* TCPTRANSPORT_H_ */
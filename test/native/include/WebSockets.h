@@ -0,0 +1,75 @@
+/**
+ * WebSockets.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef NATIVE_WEBSOCKETS_H_
+#define NATIVE_WEBSOCKETS_H_
+
+// Stand-in for links2004/WebSockets on a host build: same declarations as the
+// parts of the library ArduinoSocketIOClient uses, frames go to a MockTransport
+
+#include "MockTransport.h"
+#include <Arduino.h>
+
+#define WEBSOCKETS_MAX_HEADER_SIZE (14)
+#define WEBSOCKETS_NETWORK_CLASS MockTransport
+
+typedef enum {
+   WSC_NOT_CONNECTED,
+   WSC_HEADER,
+   WSC_BODY,
+   WSC_CONNECTED,
+} WSclientsStatus_t;
+
+typedef enum {
+   WStype_ERROR,
+   WStype_DISCONNECTED,
+   WStype_CONNECTED,
+   WStype_TEXT,
+   WStype_BIN,
+   WStype_FRAGMENT_TEXT_START,
+   WStype_FRAGMENT_BIN_START,
+   WStype_FRAGMENT,
+   WStype_FRAGMENT_FIN,
+   WStype_PING,
+   WStype_PONG,
+} WStype_t;
+
+typedef enum {
+   WSop_continuation = 0x00,
+   WSop_text = 0x01,
+   WSop_binary = 0x02,
+   WSop_close = 0x08,
+   WSop_ping = 0x09,
+   WSop_pong = 0x0A,
+} WSopcode_t;
+
+typedef struct {
+   WSclientsStatus_t status = WSC_NOT_CONNECTED;
+   WEBSOCKETS_NETWORK_CLASS *tcp = NULL;
+   bool cIsClient = true;
+   String cUrl;
+   bool isSocketIO = false; ///< Connected by beginSocketIO: polling first
+   bool cPolled = false;    ///< The polling request took the OPEN packet
+} WSclient_t;
+
+class WebSockets {
+ public:
+   virtual ~WebSockets(void) {}
+
+ protected:
+   virtual void clientDisconnect(WSclient_t *client) = 0;
+   virtual bool clientIsConnected(WSclient_t *client) = 0;
+
+   uint8_t createHeader(uint8_t *buf, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin);
+   bool sendFrame(WSclient_t *client, WSopcode_t opcode, uint8_t *payload = NULL, size_t length = 0, bool fin = true, bool headerToPayload = false);
+   size_t write(WSclient_t *client, uint8_t *out, size_t n);
+   size_t write(WSclient_t *client, const char *out);
+
+   std::vector<uint8_t> _frame; ///< Frame assembled when the caller has no header room
+};
+
+#endif /* NATIVE_WEBSOCKETS_H_ */
@@ -0,0 +1,68 @@
+/**
+ * WebSocketsClient.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285@gmail.com
+ */
+
+#ifndef NATIVE_WEBSOCKETSCLIENT_H_
+#define NATIVE_WEBSOCKETSCLIENT_H_
+
+#include "WebSockets.h"
+
+/**
+ * Host stand-in of links2004's WebSocketsClient. Instead of a socket it owns
+ * a MockTransport (or uses the one given to useTransport): loop() reports the
+ * connection changes made on it and delivers one received frame per call, like
+ * the real client. As with the real client, a connection made by
+ * beginSocketIO polls first: the OPEN packet goes to the polling request and
+ * the WebSocket only gets what follows it.
+ */
+class WebSocketsClient : protected WebSockets {
+ public:
+   typedef std::function<void(WStype_t type, uint8_t *payload, size_t length)> WebSocketClientEvent;
+
+   WebSocketsClient(void);
+   virtual ~WebSocketsClient(void);
+
+   void begin(const char *host, uint16_t port, const char *url = "/", const char *protocol = "arduino");
+   void beginSocketIO(const char *host, uint16_t port, const char *url = "/socket.io/?EIO=3", const char *protocol = "arduino");
+   void beginSocketIO(String host, uint16_t port, String url = "/socket.io/?EIO=3", String protocol = "arduino");
+
+   void loop(void);
+   void onEvent(WebSocketClientEvent cbEvent) { _cbEvent = cbEvent; }
+
+   bool sendTXT(uint8_t *payload, size_t length = 0, bool headerToPayload = false);
+   bool sendTXT(const uint8_t *payload, size_t length = 0);
+   bool sendTXT(char *payload, size_t length = 0, bool headerToPayload = false);
+   bool sendTXT(const char *payload, size_t length = 0);
+   bool sendTXT(String &payload);
+   bool sendTXT(char payload);
+   bool sendBIN(uint8_t *payload, size_t length, bool headerToPayload = false);
+   bool sendBIN(const uint8_t *payload, size_t length);
+
+   void disconnect(void);
+   void setReconnectInterval(unsigned long time) { _reconnectInterval = time; }
+   void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount) {}
+   void disableHeartbeat(void) {}
+   bool isConnected(void);
+
+ protected:
+   WSclient_t _client;
+   MockTransport _transport;
+   WebSocketClientEvent _cbEvent;
+   unsigned long _reconnectInterval = 500;
+   std::vector<uint8_t> _rx; ///< Received frame handed to runCbEvent
+
+   virtual void runCbEvent(WStype_t type, uint8_t *payload, size_t length) {
+      if (_cbEvent) {
+         _cbEvent(type, payload, length);
+      }
+   }
+
+   void useTransport(MockTransport *transport) { _client.tcp = transport; }
+   void clientDisconnect(WSclient_t *client);
+   bool clientIsConnected(WSclient_t *client);
+};
+
+#endif /* NATIVE_WEBSOCKETSCLIENT_H_ */
@@ -0,0 +1,67 @@
+/*
+ * AllocTracker.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "AllocTracker.h"
+
+#include <atomic>
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<size_t> allocationCount(0);
+static std::atomic<size_t> bytesInUse(0);
+static std::atomic<size_t> bytesPeak(0);
+
+static void *track(void *ptr) {
+   if (ptr) {
+      allocationCount++;
+      size_t used = bytesInUse += malloc_usable_size(ptr);
+      size_t peak = bytesPeak;
+      while (used > peak && !bytesPeak.compare_exchange_weak(peak, used)) {
+      }
+   }
+   return ptr;
+}
+
+static void untrack(void *ptr) {
+   if (ptr) {
+      bytesInUse -= malloc_usable_size(ptr);
+   }
+}
+
+extern "C" {
+void *malloc(size_t size) { return track(__libc_malloc(size)); }
+
+void *calloc(size_t count, size_t size) { return track(__libc_calloc(count, size)); }
+
+void *realloc(void *ptr, size_t size) {
+   untrack(ptr);
+   void *moved = __libc_realloc(ptr, size);
+   if (!moved && size) {
+      // Failed: the block is still there
+      bytesInUse += malloc_usable_size(ptr);
+      return NULL;
+   }
+   return track(moved);
+}
+
+void free(void *ptr) {
+   untrack(ptr);
+   __libc_free(ptr);
+}
+}
+
+namespace AllocTracker {
+size_t allocations(void) { return allocationCount; }
+size_t inUse(void) { return bytesInUse; }
+size_t peak(void) { return bytesPeak; }
+void resetPeak(void) { bytesPeak = (size_t)bytesInUse; }
+} // namespace AllocTracker
@@ -0,0 +1,42 @@
+/*
+ * Arduino.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "Arduino.h"
+
+#include <chrono>
+#include <thread>
+
+static unsigned long clockOffset = 0;
+
+static uint64_t elapsedMicros(void) {
+   static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long millis(void) { return (unsigned long)(elapsedMicros() / 1000) + clockOffset; }
+
+unsigned long micros(void) { return (unsigned long)elapsedMicros() + clockOffset * 1000; }
+
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void advanceClock(unsigned long ms) { clockOffset += ms; }
+
+long random(long howbig) { return howbig > 0 ? rand() % howbig : 0; }
+
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+
+void randomSeed(unsigned long seed) { srand(seed); }
+
+void hexdump(const void *mem, uint32_t len, uint8_t cols) {
+   const uint8_t *src = (const uint8_t *)mem;
+   for (uint32_t i = 0; i < len; i++) {
+      if (i % cols == 0) {
+         printf("\n0x%08lX: ", (unsigned long)i);
+      }
+      printf("%02X ", src[i]);
+   }
+   printf("\n");
+}
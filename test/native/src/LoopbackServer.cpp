@@ -0,0 +1,431 @@
+/*
+ * LoopbackServer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "LoopbackServer.h"
+
+#include "MockTransport.h"
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#define LOOPBACK_OPEN_PACKET "0{\"sid\":\"loopback\",\"upgrades\":[],\"pingInterval\":25000,\"pingTimeout\":20000,\"maxPayload\":1000000}"
+
+/**
+ * @brief SHA-1 (RFC 3174) of the Sec-WebSocket-Accept answer
+ *
+ * @param data const std::string &
+ * @param digest uint8_t[20]
+ */
+static void sha1(const std::string &data, uint8_t digest[20]) {
+   uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+   std::string message = data;
+   uint64_t bits = (uint64_t)data.size() * 8;
+   message += (char)0x80;
+   while (message.size() % 64 != 56) {
+      message += (char)0;
+   }
+   for (int i = 7; i >= 0; i--) {
+      message += (char)(bits >> (8 * i));
+   }
+
+   for (size_t block = 0; block < message.size(); block += 64) {
+      uint32_t w[80];
+      for (int i = 0; i < 16; i++) {
+         const uint8_t *p = (const uint8_t *)message.data() + block + 4 * i;
+         w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+      }
+      for (int i = 16; i < 80; i++) {
+         uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+         w[i] = (x << 1) | (x >> 31);
+      }
+      uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+      for (int i = 0; i < 80; i++) {
+         uint32_t f, k;
+         if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+         } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+         } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+         } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+         }
+         uint32_t t = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+         e = d;
+         d = c;
+         c = (b << 30) | (b >> 2);
+         b = a;
+         a = t;
+      }
+      h[0] += a;
+      h[1] += b;
+      h[2] += c;
+      h[3] += d;
+      h[4] += e;
+   }
+   for (int i = 0; i < 20; i++) {
+      digest[i] = h[i / 4] >> (24 - 8 * (i % 4));
+   }
+}
+
+static std::string base64(const uint8_t *data, size_t length) {
+   static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+   std::string out;
+   for (size_t i = 0; i < length; i += 3) {
+      uint32_t n = (uint32_t)data[i] << 16;
+      if (i + 1 < length) {
+         n |= (uint32_t)data[i + 1] << 8;
+      }
+      if (i + 2 < length) {
+         n |= data[i + 2];
+      }
+      out += alphabet[(n >> 18) & 63];
+      out += alphabet[(n >> 12) & 63];
+      out += i + 1 < length ? alphabet[(n >> 6) & 63] : '=';
+      out += i + 2 < length ? alphabet[n & 63] : '=';
+   }
+   return out;
+}
+
+LoopbackServer::LoopbackServer() {}
+
+LoopbackServer::~LoopbackServer() { stop(); }
+
+/**
+ * @brief Listen on 127.0.0.1 and serve on a thread
+ *
+ * @return uint16_t port chosen by the system, 0 on failure
+ */
+uint16_t LoopbackServer::start(void) {
+   _listener = socket(AF_INET, SOCK_STREAM, 0);
+   if (_listener < 0) {
+      return 0;
+   }
+   int reuse = 1;
+   setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+   sockaddr_in address = {};
+   address.sin_family = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   address.sin_port = 0;
+   socklen_t size = sizeof(address);
+   if (bind(_listener, (sockaddr *)&address, sizeof(address)) != 0 || listen(_listener, 8) != 0 || getsockname(_listener, (sockaddr *)&address, &size) != 0) {
+      ::close(_listener);
+      _listener = -1;
+      return 0;
+   }
+
+   _running = true;
+   _thread = std::thread(&LoopbackServer::run, this);
+   return ntohs(address.sin_port);
+}
+
+/**
+ * @brief Close the connections and join the thread
+ *
+ */
+void LoopbackServer::stop(void) {
+   if (!_running) {
+      return;
+   }
+   _running = false;
+   _thread.join();
+   ::close(_listener);
+   _listener = -1;
+}
+
+/**
+ * @brief Accept the clients one after the other
+ *
+ */
+void LoopbackServer::run(void) {
+   while (_running) {
+      pollfd pfd = {_listener, POLLIN, 0};
+      if (::poll(&pfd, 1, 20) <= 0) {
+         continue;
+      }
+      int fd = accept(_listener, NULL, NULL);
+      if (fd < 0) {
+         continue;
+      }
+      int noDelay = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+      std::string received;
+      if (!upgrade(fd, received)) {
+         ::close(fd);
+         continue;
+      }
+      {
+         std::lock_guard<std::mutex> lock(_sendLock);
+         _client = fd;
+      }
+      {
+         std::lock_guard<std::mutex> lock(_logLock);
+         _joined = false;
+      }
+      _connections++;
+      sendText(LOOPBACK_OPEN_PACKET);
+      serve(fd, received);
+      closeClient();
+   }
+}
+
+/**
+ * @brief Read the HTTP upgrade request and accept it
+ *
+ * @param fd int
+ * @param rest std::string & bytes received after the request
+ * @return bool
+ */
+bool LoopbackServer::upgrade(int fd, std::string &rest) {
+   std::string request;
+   size_t end;
+   while ((end = request.find("\r\n\r\n")) == std::string::npos) {
+      pollfd pfd = {fd, POLLIN, 0};
+      char buf[512];
+      ssize_t n;
+      if (::poll(&pfd, 1, 1000) <= 0 || (n = recv(fd, buf, sizeof(buf), 0)) <= 0) {
+         return false;
+      }
+      request.append(buf, n);
+   }
+
+   const char *field = "Sec-WebSocket-Key: ";
+   size_t key = request.find(field);
+   // Like Engine.IO, refuse a WebSocket without transport=websocket
+   if (request.compare(0, 4, "GET ") != 0 || key == std::string::npos || request.find("transport=websocket") > request.find("\r\n")) {
+      return false;
+   }
+   key += strlen(field);
+   uint8_t digest[20];
+   sha1(request.substr(key, request.find("\r\n", key) - key) + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", digest);
+
+   std::string answer = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\nSec-WebSocket-Protocol: arduino\r\n\r\n";
+   if (send(fd, answer.data(), answer.size(), MSG_NOSIGNAL) != (ssize_t)answer.size()) {
+      return false;
+   }
+   rest = request.substr(end + 4);
+   return true;
+}
+
+/**
+ * @brief Handle the frames of a client until it leaves or stop()
+ *
+ * @param fd int
+ * @param received std::string & bytes already received
+ */
+void LoopbackServer::serve(int fd, std::string &received) {
+   size_t readAt = 0;
+   MockFrame frame;
+   while (_running) {
+      size_t used;
+      while ((used = MockTransport::decodeFrame((const uint8_t *)received.data() + readAt, received.size() - readAt, frame)) > 0) {
+         readAt += used;
+         if (frame.opcode == 0x08) {
+            return;
+         }
+         if (frame.opcode == 0x01) {
+            handleEngineIO(frame.data);
+         }
+      }
+      received.erase(0, readAt);
+      readAt = 0;
+
+      pollfd pfd = {fd, POLLIN, 0};
+      if (::poll(&pfd, 1, 20) <= 0) {
+         continue;
+      }
+      char buf[4096];
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) {
+         return;
+      }
+      received.append(buf, n);
+   }
+}
+
+/**
+ * @brief Answer an Engine.IO packet
+ *
+ * @param text const std::string &
+ */
+void LoopbackServer::handleEngineIO(const std::string &text) {
+   if (text.empty()) {
+      return;
+   }
+   switch (text[0]) {
+   case '2': // ping, "2probe" before the upgrade
+      sendText(text == "2probe" ? "3probe" : "3");
+      break;
+   case '3':
+      _pongs++;
+      break;
+   case '4':
+      handleSocketIO(text.data() + 1, text.size() - 1);
+      break;
+   default: // close, upgrade, noop
+      break;
+   }
+}
+
+/**
+ * @brief Answer a Socket.IO packet: CONNECT, EVENT (echo and ack)
+ *
+ * @param packet const char *
+ * @param length size_t
+ */
+void LoopbackServer::handleSocketIO(const char *packet, size_t length) {
+   if (length == 0) {
+      return;
+   }
+   std::string text(packet + 1, length - 1);
+
+   // "/nsp," prefix, none for the main namespace
+   std::string prefix;
+   if (!text.empty() && text[0] == '/') {
+      size_t comma = text.find(',');
+      std::string nsp = text.substr(0, comma);
+      text = comma == std::string::npos ? "" : text.substr(comma + 1);
+      if (nsp != "/") {
+         prefix = nsp + ",";
+      }
+   }
+
+   switch (packet[0]) {
+   case '0':
+      if (_recovery && prefix.empty()) {
+         // Answered under the log lock: no broadcast between the answer and the replay
+         std::lock_guard<std::mutex> lock(_logLock);
+         connectMain(text);
+      } else {
+         sendText("40" + prefix + "{\"sid\":\"loopback\"}");
+      }
+      if (!_welcome.empty()) {
+         sendText("42" + prefix + "[\"" + _welcome + "\"]");
+      }
+      break;
+   case '2': {
+      _events++;
+      if (_handler) {
+         _handler(packet, length);
+      }
+      size_t data = 0;
+      while (data < text.size() && isdigit((unsigned char)text[data])) {
+         data++;
+      }
+      std::string ackId = text.substr(0, data);
+      text.erase(0, data);
+
+      // ["name",args...]
+      size_t nameEnd = text.find('"', 2);
+      if (text.compare(0, 2, "[\"") != 0 || nameEnd == std::string::npos) {
+         break;
+      }
+      if (text.compare(2, nameEnd - 2, "echo") == 0) {
+         sendText("42" + prefix + text);
+      }
+      if (!ackId.empty()) {
+         std::string args = text.compare(nameEnd + 1, 1, ",") == 0 ? "[" + text.substr(nameEnd + 2) : "[]";
+         sendText("43" + prefix + ackId + args);
+      }
+   } break;
+   default:
+      break;
+   }
+}
+
+/**
+ * @brief Answer the CONNECT of the main namespace: restore the session whose
+ * pid the client presents and send the events it missed, or start a new one
+ *
+ * @param auth const std::string & {"pid":"...","offset":"..."} or empty
+ */
+void LoopbackServer::connectMain(const std::string &auth) {
+   size_t offset = 0;
+   size_t at = auth.find("\"offset\":\"");
+   if (at != std::string::npos) {
+      offset = strtoul(auth.c_str() + at + 10, NULL, 10);
+   }
+   bool restored = !_pid.empty() && auth.find("\"pid\":\"" + _pid + "\"") != std::string::npos && offset <= _log.size();
+   if (restored) {
+      _recovered++;
+   } else {
+      _pid = "pid" + std::to_string(++_sessions);
+      offset = _log.size();
+   }
+   sendText("40{\"sid\":\"loopback\",\"pid\":\"" + _pid + "\"}");
+   for (size_t i = offset; i < _log.size(); i++) {
+      sendText(_log[i]);
+   }
+   _joined = true;
+}
+
+/**
+ * @brief Emit an event of the main namespace with an offset: kept for the
+ * clients that recover, sent now if the client joined
+ *
+ * @param event const std::string & "[\"event\",args...]"
+ * @return bool false if it was not sent now
+ */
+bool LoopbackServer::broadcast(const std::string &event) {
+   std::lock_guard<std::mutex> lock(_logLock);
+   std::string packet = "42" + event.substr(0, event.size() - 1) + ",\"" + std::to_string(_log.size() + 1) + "\"]";
+   _log.push_back(packet);
+   return _joined && sendText(packet);
+}
+
+/**
+ * @brief Cut the connection of the client, as a network loss would
+ *
+ */
+void LoopbackServer::dropClient(void) {
+   std::lock_guard<std::mutex> lock(_sendLock);
+   if (_client >= 0) {
+      shutdown(_client, SHUT_RDWR);
+   }
+}
+
+/**
+ * @brief Emit a Socket.IO packet to the client, from any thread
+ *
+ * @param packet const std::string & "2[\"event\",...]"
+ * @return bool
+ */
+bool LoopbackServer::emit(const std::string &packet) { return sendText("4" + packet); }
+
+/**
+ * @brief Send an Engine.IO ping, from any thread: pongs() counts the answers
+ *
+ * @return bool
+ */
+bool LoopbackServer::ping(void) { return sendText("2"); }
+
+bool LoopbackServer::sendText(const std::string &text) {
+   std::vector<uint8_t> frame;
+   MockTransport::encodeFrame(frame, 0x01, text.data(), text.size());
+   std::lock_guard<std::mutex> lock(_sendLock);
+   return _client >= 0 && send(_client, frame.data(), frame.size(), MSG_NOSIGNAL) == (ssize_t)frame.size();
+}
+
+void LoopbackServer::closeClient(void) {
+   std::lock_guard<std::mutex> lock(_sendLock);
+   if (_client >= 0) {
+      ::close(_client);
+   }
+   _client = -1;
+}
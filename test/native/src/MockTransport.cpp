@@ -0,0 +1,221 @@
+/*
+ * MockTransport.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "MockTransport.h"
+
+#include <string.h>
+
+MockTransport::MockTransport() {}
+
+MockTransport::~MockTransport() {}
+
+/**
+ * @brief Take bytes written by the client. Fails like a dropped socket while
+ * closed or failWrites(true), or once the writes of failWritesAfter() are done.
+ *
+ * @param data const uint8_t *
+ * @param length size_t
+ * @return size_t bytes written
+ */
+size_t MockTransport::write(const uint8_t *data, size_t length) {
+   if (_writesLeft && --_writesLeft == 0) {
+      _failWrites = true;
+   }
+   if (!_connected || _failWrites) {
+      return 0;
+   }
+   _writes++;
+   _bytes += length;
+   if (_capture) {
+      _stream.insert(_stream.end(), data, data + length);
+      decode();
+   }
+   return length;
+}
+
+/**
+ * @brief Drop the connection: frames not read yet are lost
+ *
+ */
+void MockTransport::close(void) {
+   _connected = false;
+   _inbound.clear();
+   _inboundBytes = 0;
+   _stream.clear();
+}
+
+/**
+ * @brief Queue a text frame for the client
+ *
+ * @param text const char *
+ * @param length size_t 0 if text is null terminated
+ */
+void MockTransport::receiveText(const char *text, size_t length) {
+   MockFrame frame;
+   frame.opcode = 0x01;
+   frame.fin = true;
+   frame.data.assign(text, length ? length : strlen(text));
+   _inboundBytes += frame.data.size();
+   _inbound.push_back(frame);
+}
+
+/**
+ * @brief Queue a binary frame for the client
+ *
+ * @param data const uint8_t *
+ * @param length size_t
+ */
+void MockTransport::receiveBinary(const uint8_t *data, size_t length) {
+   MockFrame frame;
+   frame.opcode = 0x02;
+   frame.fin = true;
+   frame.data.assign((const char *)data, length);
+   _inboundBytes += frame.data.size();
+   _inbound.push_back(frame);
+}
+
+/**
+ * @brief Queue a text message split in fragments of fragmentSize bytes: a
+ * text frame, then continuation frames, the last one with FIN
+ *
+ * @param text const char *
+ * @param fragmentSize size_t
+ * @param length size_t 0 for strlen(text)
+ */
+void MockTransport::receiveFragments(const char *text, size_t fragmentSize, size_t length) {
+   if (!length) {
+      length = strlen(text);
+   }
+   for (size_t offset = 0; offset < length; offset += fragmentSize) {
+      MockFrame frame;
+      frame.opcode = offset ? 0x00 : 0x01;
+      frame.fin = offset + fragmentSize >= length;
+      frame.data.assign(text + offset, frame.fin ? length - offset : fragmentSize);
+      _inboundBytes += frame.data.size();
+      _inbound.push_back(frame);
+   }
+}
+
+/**
+ * @brief Take the oldest frame queued for the client
+ *
+ * @param frame MockFrame &
+ * @return bool false if none
+ */
+bool MockTransport::nextInbound(MockFrame &frame) {
+   if (_inbound.empty()) {
+      return false;
+   }
+   frame.opcode = _inbound.front().opcode;
+   frame.fin = _inbound.front().fin;
+   frame.data.swap(_inbound.front().data);
+   _inbound.pop_front();
+   _inboundBytes -= frame.data.size();
+   return true;
+}
+
+/**
+ * @brief Forget what was written
+ *
+ */
+void MockTransport::clearWrites(void) {
+   _writes = 0;
+   _bytes = 0;
+   _stream.clear();
+   _frames.clear();
+}
+
+/**
+ * @brief Cut the complete frames out of the written bytes
+ *
+ */
+void MockTransport::decode(void) {
+   size_t at = 0;
+   MockFrame frame;
+   size_t used;
+   while ((used = decodeFrame(_stream.data() + at, _stream.size() - at, frame)) > 0) {
+      _frames.push_back(frame);
+      at += used;
+   }
+   _stream.erase(_stream.begin(), _stream.begin() + at);
+}
+
+/**
+ * @brief Read the frame at the beginning of data, unmasking it
+ *
+ * @param data const uint8_t *
+ * @param length size_t
+ * @param frame MockFrame &
+ * @return size_t bytes of the frame, 0 if it is not complete
+ */
+size_t MockTransport::decodeFrame(const uint8_t *data, size_t length, MockFrame &frame) {
+   if (length < 2) {
+      return 0;
+   }
+   bool masked = data[1] & 0x80;
+   uint64_t payloadLength = data[1] & 0x7F;
+   size_t header = 2;
+   if (payloadLength == 126) {
+      if (length < 4) {
+         return 0;
+      }
+      payloadLength = ((uint64_t)data[2] << 8) | data[3];
+      header = 4;
+   } else if (payloadLength == 127) {
+      if (length < 10) {
+         return 0;
+      }
+      payloadLength = 0;
+      for (int i = 0; i < 8; i++) {
+         payloadLength = (payloadLength << 8) | data[2 + i];
+      }
+      header = 10;
+   }
+   const uint8_t *maskKey = data + header;
+   if (masked) {
+      header += 4;
+   }
+   if (length < header + payloadLength) {
+      return 0;
+   }
+
+   frame.opcode = data[0] & 0x0F;
+   frame.fin = data[0] & 0x80;
+   frame.data.assign((const char *)data + header, payloadLength);
+   memset(frame.maskKey, 0, sizeof(frame.maskKey));
+   if (masked) {
+      memcpy(frame.maskKey, maskKey, sizeof(frame.maskKey));
+      for (size_t i = 0; i < payloadLength; i++) {
+         frame.data[i] ^= maskKey[i % 4];
+      }
+   }
+   return header + payloadLength;
+}
+
+/**
+ * @brief Append an unmasked frame, as a server sends it
+ *
+ * @param out std::vector<uint8_t> &
+ * @param opcode uint8_t
+ * @param data const char *
+ * @param length size_t
+ */
+void MockTransport::encodeFrame(std::vector<uint8_t> &out, uint8_t opcode, const char *data, size_t length) {
+   out.push_back(0x80 | opcode);
+   if (length < 126) {
+      out.push_back(length);
+   } else if (length < 0x10000) {
+      out.push_back(126);
+      out.push_back(length >> 8);
+      out.push_back(length);
+   } else {
+      out.push_back(127);
+      for (int i = 7; i >= 0; i--) {
+         out.push_back((uint64_t)length >> (8 * i));
+      }
+   }
+   out.insert(out.end(), data, data + length);
+}
@@ -0,0 +1,215 @@
+/*
+ * TcpTransport.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "TcpTransport.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef TCP_UPGRADE_TIMEOUT
+#define TCP_UPGRADE_TIMEOUT 2000 // ms
+#endif
+
+TcpTransport::TcpTransport() {}
+
+TcpTransport::~TcpTransport() { close(); }
+
+/**
+ * @brief Set the server the next poll() connects to
+ *
+ * @param host const char *
+ * @param port uint16_t
+ * @param url const char *
+ */
+void TcpTransport::begin(const char *host, uint16_t port, const char *url) {
+   close();
+   _host = host;
+   _port = port;
+   _url = url;
+}
+
+/**
+ * @brief Connect and upgrade to WebSocket while not connected. Blocking: the
+ * server is on the loopback.
+ *
+ */
+void TcpTransport::poll(void) {
+   if (_fd >= 0 || _host.empty()) {
+      return;
+   }
+   _attempts++;
+
+   addrinfo hints = {};
+   hints.ai_family = AF_INET;
+   hints.ai_socktype = SOCK_STREAM;
+   addrinfo *address = NULL;
+   if (getaddrinfo(_host.c_str(), std::to_string(_port).c_str(), &hints, &address) != 0) {
+      return;
+   }
+   _fd = socket(AF_INET, SOCK_STREAM, 0);
+   bool ok = _fd >= 0 && connect(_fd, address->ai_addr, address->ai_addrlen) == 0;
+   freeaddrinfo(address);
+   if (!ok) {
+      close();
+      return;
+   }
+   // Frames go out as they are written, like on the ESP
+   int noDelay = 1;
+   setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+   if (!upgrade()) {
+      close();
+   }
+}
+
+/**
+ * @brief Send the HTTP upgrade request and wait for the 101 answer. Bytes
+ * received after the answer are kept for nextInbound().
+ *
+ * @return bool
+ */
+bool TcpTransport::upgrade(void) {
+   std::string request = "GET " + _url + " HTTP/1.1\r\nHost: " + _host + ":" + std::to_string(_port) +
+                         "\r\nConnection: Upgrade\r\nUpgrade: websocket\r\nSec-WebSocket-Version: 13\r\n"
+                         "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Protocol: arduino\r\n\r\n";
+   if (send(_fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) {
+      return false;
+   }
+
+   std::string answer;
+   size_t end;
+   while ((end = answer.find("\r\n\r\n")) == std::string::npos) {
+      pollfd pfd = {_fd, POLLIN, 0};
+      char buf[512];
+      ssize_t n;
+      if (::poll(&pfd, 1, TCP_UPGRADE_TIMEOUT) <= 0 || (n = recv(_fd, buf, sizeof(buf), 0)) <= 0) {
+         return false;
+      }
+      answer.append(buf, n);
+   }
+   if (answer.compare(0, 12, "HTTP/1.1 101") != 0) {
+      return false;
+   }
+   _received.assign(answer.begin() + end + 4, answer.end());
+   _upgraded = true;
+   return true;
+}
+
+/**
+ * @brief Bytes received and not read yet
+ *
+ * @return int
+ */
+int TcpTransport::available(void) const {
+   if (_fd < 0) {
+      return 0;
+   }
+   int pending = 0;
+   ioctl(_fd, FIONREAD, &pending);
+   return pending + (int)(_received.size() - _readAt);
+}
+
+/**
+ * @brief Send all bytes of a write, counted like the mock
+ *
+ * @param data const uint8_t *
+ * @param length size_t
+ * @return size_t bytes written, 0 if the connection dropped
+ */
+size_t TcpTransport::write(const uint8_t *data, size_t length) {
+   if (!connected() || _failWrites) {
+      return 0;
+   }
+   size_t sent = 0;
+   while (sent < length) {
+      ssize_t n = send(_fd, data + sent, length - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+         close();
+         return 0;
+      }
+      sent += n;
+   }
+   _writes++;
+   _bytes += length;
+   return length;
+}
+
+/**
+ * @brief Read what the socket holds without blocking
+ *
+ * @return bool false if the server closed the connection
+ */
+bool TcpTransport::receive(void) {
+   // Drop the decoded bytes once they are half of the buffer
+   if (_readAt > 0 && _readAt >= _received.size() / 2) {
+      _received.erase(_received.begin(), _received.begin() + _readAt);
+      _readAt = 0;
+   }
+   uint8_t buf[4096];
+   for (;;) {
+      ssize_t n = recv(_fd, buf, sizeof(buf), MSG_DONTWAIT);
+      if (n > 0) {
+         _received.insert(_received.end(), buf, buf + n);
+         continue;
+      }
+      return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+   }
+}
+
+/**
+ * @brief Take the next complete text or binary frame. A close frame or a
+ * closed socket drops the connection.
+ *
+ * @param frame MockFrame &
+ * @return bool false if none
+ */
+bool TcpTransport::nextInbound(MockFrame &frame) {
+   if (!connected()) {
+      return false;
+   }
+   bool open = receive();
+   size_t used;
+   while ((used = decodeFrame(_received.data() + _readAt, _received.size() - _readAt, frame)) > 0) {
+      _readAt += used;
+      if (_readAt == _received.size()) {
+         _received.clear();
+         _readAt = 0;
+      }
+      if (frame.opcode == 0x08) {
+         close();
+         return false;
+      }
+      if (frame.opcode == 0x01 || frame.opcode == 0x02) {
+         return true;
+      }
+   }
+   if (!open) {
+      close();
+   }
+   return false;
+}
+
+/**
+ * @brief Close the socket: the next poll() connects again
+ *
+ */
+void TcpTransport::close(void) {
+   if (_fd >= 0) {
+      ::close(_fd);
+   }
+   _fd = -1;
+   _upgraded = false;
+   _received.clear();
+   _readAt = 0;
+}
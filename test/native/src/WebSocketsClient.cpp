@@ -0,0 +1,186 @@
+/*
+ * WebSocketsClient.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "WebSocketsClient.h"
+
+/**
+ * @brief Write a WebSocket frame header (RFC 6455)
+ *
+ * @param buf uint8_t * WEBSOCKETS_MAX_HEADER_SIZE bytes
+ * @param opcode WSopcode_t
+ * @param length size_t
+ * @param mask bool
+ * @param maskKey uint8_t[4]
+ * @param fin bool
+ * @return uint8_t header size
+ */
+uint8_t WebSockets::createHeader(uint8_t *buf, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin) {
+   uint8_t size = 0;
+   buf[size++] = (fin ? 0x80 : 0x00) | opcode;
+   if (length < 126) {
+      buf[size++] = (mask ? 0x80 : 0x00) | length;
+   } else if (length < 0x10000) {
+      buf[size++] = (mask ? 0x80 : 0x00) | 126;
+      buf[size++] = length >> 8;
+      buf[size++] = length;
+   } else {
+      buf[size++] = (mask ? 0x80 : 0x00) | 127;
+      for (int i = 7; i >= 0; i--) {
+         buf[size++] = (uint64_t)length >> (8 * i);
+      }
+   }
+   if (mask) {
+      memcpy(buf + size, maskKey, 4);
+      size += 4;
+   }
+   return size;
+}
+
+/**
+ * @brief Send a frame in one write, like links2004's sendFrame: with
+ * headerToPayload the header goes into the WEBSOCKETS_MAX_HEADER_SIZE bytes in
+ * front of the data and the data is masked in place, otherwise the frame is
+ * assembled in a buffer
+ *
+ * @return bool
+ */
+bool WebSockets::sendFrame(WSclient_t *client, WSopcode_t opcode, uint8_t *payload, size_t length, bool fin, bool headerToPayload) {
+   if (!clientIsConnected(client)) {
+      return false;
+   }
+
+   uint8_t maskKey[4] = {0x5A, 0xC3, 0x96, 0x0F};
+   uint8_t header[WEBSOCKETS_MAX_HEADER_SIZE];
+   uint8_t headerSize = createHeader(header, opcode, length, client->cIsClient, maskKey, fin);
+
+   uint8_t *frame;
+   if (headerToPayload) {
+      frame = payload + WEBSOCKETS_MAX_HEADER_SIZE - headerSize;
+   } else {
+      if (_frame.size() < headerSize + length) {
+         _frame.resize(headerSize + length);
+      }
+      frame = _frame.data();
+      if (length) {
+         memcpy(frame + headerSize, payload, length);
+      }
+   }
+   memcpy(frame, header, headerSize);
+   if (client->cIsClient) {
+      for (size_t i = 0; i < length; i++) {
+         frame[headerSize + i] ^= maskKey[i % 4];
+      }
+   }
+   return write(client, frame, headerSize + length) == headerSize + length;
+}
+
+size_t WebSockets::write(WSclient_t *client, uint8_t *out, size_t n) { return client->tcp ? client->tcp->write(out, n) : 0; }
+
+size_t WebSockets::write(WSclient_t *client, const char *out) { return write(client, (uint8_t *)out, strlen(out)); }
+
+WebSocketsClient::WebSocketsClient() { _client.tcp = &_transport; }
+
+WebSocketsClient::~WebSocketsClient() {}
+
+void WebSocketsClient::begin(const char *host, uint16_t port, const char *url, const char *protocol) {
+   _client.cUrl = url;
+   _client.isSocketIO = false;
+   _client.status = WSC_NOT_CONNECTED;
+   _client.tcp->begin(host, port, url);
+}
+
+void WebSocketsClient::beginSocketIO(const char *host, uint16_t port, const char *url, const char *protocol) {
+   begin(host, port, url, protocol);
+   _client.isSocketIO = true;
+}
+
+void WebSocketsClient::beginSocketIO(String host, uint16_t port, String url, String protocol) { beginSocketIO(host.c_str(), port, url.c_str(), protocol.c_str()); }
+
+/**
+ * @brief Report a connection opened or closed on the transport, else deliver
+ * one received frame
+ *
+ */
+void WebSocketsClient::loop(void) {
+   MockTransport &transport = *_client.tcp;
+   // A lost connection is reported before the next attempt
+   if (!transport.connected() && _client.status == WSC_CONNECTED) {
+      clientDisconnect(&_client);
+      return;
+   }
+   transport.poll();
+   if (transport.connected() && _client.status != WSC_CONNECTED) {
+      _client.status = WSC_CONNECTED;
+      _client.cPolled = false;
+      runCbEvent(WStype_CONNECTED, (uint8_t *)_client.cUrl.c_str(), _client.cUrl.length());
+      return;
+   }
+
+   MockFrame frame;
+   if (_client.status != WSC_CONNECTED || !transport.nextInbound(frame)) {
+      return;
+   }
+   // Engine.IO over polling first: the OPEN packet is read by the polling
+   // request, never handed over
+   if (_client.isSocketIO && !_client.cPolled && frame.opcode == WSop_text && !frame.data.empty() && frame.data[0] == '0') {
+      _client.cPolled = true;
+      return;
+   }
+   // The real client hands over its receive buffer, NUL terminated
+   if (_rx.size() < frame.data.size() + 1) {
+      _rx.resize(frame.data.size() + 1);
+   }
+   memcpy(_rx.data(), frame.data.data(), frame.data.size());
+   _rx[frame.data.size()] = '\0';
+   WStype_t type = frame.opcode == WSop_binary ? WStype_BIN : WStype_TEXT;
+   if (frame.opcode == WSop_continuation) {
+      type = frame.fin ? WStype_FRAGMENT_FIN : WStype_FRAGMENT;
+   } else if (!frame.fin) {
+      type = frame.opcode == WSop_binary ? WStype_FRAGMENT_BIN_START : WStype_FRAGMENT_TEXT_START;
+   }
+   runCbEvent(type, _rx.data(), frame.data.size());
+}
+
+bool WebSocketsClient::sendTXT(uint8_t *payload, size_t length, bool headerToPayload) {
+   if (length == 0) {
+      length = strlen((const char *)payload + (headerToPayload ? WEBSOCKETS_MAX_HEADER_SIZE : 0));
+   }
+   return _client.status == WSC_CONNECTED && sendFrame(&_client, WSop_text, payload, length, true, headerToPayload);
+}
+
+bool WebSocketsClient::sendTXT(const uint8_t *payload, size_t length) { return sendTXT((uint8_t *)payload, length); }
+
+bool WebSocketsClient::sendTXT(char *payload, size_t length, bool headerToPayload) { return sendTXT((uint8_t *)payload, length, headerToPayload); }
+
+bool WebSocketsClient::sendTXT(const char *payload, size_t length) { return sendTXT((uint8_t *)payload, length); }
+
+bool WebSocketsClient::sendTXT(String &payload) { return sendTXT((uint8_t *)payload.c_str(), payload.length()); }
+
+bool WebSocketsClient::sendTXT(char payload) {
+   uint8_t buf[WEBSOCKETS_MAX_HEADER_SIZE + 2] = {0};
+   buf[WEBSOCKETS_MAX_HEADER_SIZE] = payload;
+   return sendTXT(buf, 1, true);
+}
+
+bool WebSocketsClient::sendBIN(uint8_t *payload, size_t length, bool headerToPayload) { return _client.status == WSC_CONNECTED && sendFrame(&_client, WSop_binary, payload, length, true, headerToPayload); }
+
+bool WebSocketsClient::sendBIN(const uint8_t *payload, size_t length) { return sendBIN((uint8_t *)payload, length); }
+
+void WebSocketsClient::disconnect(void) {
+   _client.tcp->close();
+   if (_client.status == WSC_CONNECTED) {
+      clientDisconnect(&_client);
+   }
+}
+
+bool WebSocketsClient::isConnected(void) { return _client.status == WSC_CONNECTED; }
+
+void WebSocketsClient::clientDisconnect(WSclient_t *client) {
+   client->status = WSC_NOT_CONNECTED;
+   runCbEvent(WStype_DISCONNECTED, NULL, 0);
+}
+
+bool WebSocketsClient::clientIsConnected(WSclient_t *client) { return client->tcp && client->tcp->connected(); }
@@ -0,0 +1,1208 @@
+/*
+ * test_client.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nqnghia285
+ */
+#include "ArduinoSocketIOClient.h"
+#include "SocketIOTask.h"
+
+#include <atomic>
+#include <chrono>
+#include <string.h>
+#include <string>
+#include <thread>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                     \
+   do {                                                                 \
+      if (!(cond)) {                                                    \
+         printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+         failures++;                                                    \
+      }                                                                 \
+   } while (0)
+
+/**
+ * Client whose transport the tests play the server on
+ */
+class TestClient : public ArduinoSocketIOClient {
+ public:
+   MockTransport &transport(void) { return _transport; }
+
+   // Connect and forget the handshake frames
+   void connect(void) {
+      if (!_client.cUrl.length()) {
+         begin("localhost", 3000);
+      }
+      _transport.open();
+      WebSocketsClient::loop();
+      _transport.clearWrites();
+   }
+
+   void drop(void) {
+      _transport.close();
+      loop();
+   }
+
+   std::string url(void) { return _client.cUrl.c_str(); }
+   std::string frame(size_t i) { return i < _transport.frames().size() ? _transport.frames()[i].data : ""; }
+};
+
+static void testHandshake(void) {
+   TestClient client;
+   client.begin("localhost", 3000, "/chat");
+   CHECK(client.url() == "/socket.io/?EIO=4&transport=websocket");
+   client.transport().open();
+   client.loop();
+   CHECK(client.isConnected());
+   // WebSocket from the start: no probe nor upgrade before the CONNECT, and
+   // the OPEN packet comes on it
+   CHECK(client.transport().frames().size() == 1);
+   CHECK(client.frame(0) == "40/chat");
+   client.transport().receiveText("0{\"sid\":\"e\",\"upgrades\":[],\"pingInterval\":300,\"pingTimeout\":200}");
+   client.loop();
+   CHECK(client.getPingInterval() == 300 && client.getPingTimeout() == 200);
+
+   // Without the OPEN packet the heartbeat runs with the defaults
+   TestClient silent;
+   silent.connect();
+   advanceClock(EIO_HEARTBEAT_INTERVAL + EIO_HEARTBEAT_TIMEOUT);
+   silent.loop();
+   CHECK(silent.isConnected());
+   advanceClock(10);
+   silent.loop();
+   CHECK(!silent.isConnected() && silent.getStats().pingTimeouts == 1);
+
+   // A transport given in the URL is kept
+   TestClient custom;
+   custom.begin("localhost", 3000, "/", "/io/?EIO=4&transport=websocket&token=t");
+   CHECK(custom.url() == "/io/?EIO=4&transport=websocket&token=t");
+}
+
+static void testOpen(void) {
+   TestClient client;
+   client.begin("localhost", 3000);
+   client.transport().open();
+   client.loop();
+   client.transport().receiveText("0{\"sid\":\"e\",\"upgrades\":[],\"pingInterval\":300,\"pingTimeout\":200,\"maxPayload\":64}");
+   client.loop();
+   client.transport().receiveText("40{\"sid\":\"s\"}");
+   client.loop();
+   CHECK(client.getPingInterval() == 300 && client.getPingTimeout() == 200 && client.getMaxPayload() == 64);
+   CHECK(client.getStats().connectTime.count() == 1);
+
+   // Frames beyond maxPayload are not sent
+   std::string large(80, 'x');
+   CHECK(client.emit("large", large.c_str()) == sIOemit_TOO_LARGE);
+   CHECK(client.emit("small", 1) == sIOemit_QUEUED);
+   CHECK(!client.sendEVENT(large.c_str()));
+   CHECK(client.getStats().droppedPackets == 2);
+
+   // Alive while the server pings, closed once silent for interval + timeout
+   advanceClock(450);
+   client.loop();
+   client.transport().receiveText("2");
+   client.loop();
+   advanceClock(450);
+   client.loop();
+   CHECK(client.isConnected());
+   advanceClock(60);
+   client.loop();
+   CHECK(!client.isConnected());
+   CHECK(client.getStats().pingTimeouts == 1);
+}
+
+// Every frame of an emitted event leaves in a single write
+static void testOneWritePerFrame(void) {
+   TestClient client;
+   client.connect();
+
+   CHECK(client.emit("message", "hello") == sIOemit_QUEUED);
+   CHECK(client.emit("move", 1, -2, true) == sIOemit_QUEUED);
+   client.loop();
+   CHECK(client.transport().writes() == 2);
+   CHECK(client.frame(0) == "42[\"message\",\"hello\"]");
+   CHECK(client.frame(1) == "42[\"move\",1,-2,true]");
+
+   client.transport().clearWrites();
+   CHECK(client.send(sIOtype_EVENT, "[\"small\"]"));
+   CHECK(client.transport().writes() == 1);
+   CHECK(client.frame(0) == "42[\"small\"]");
+
+   // Too large for the frame buffer: masked with a random key through a chunk
+   // on the stack, the caller's data left as it is
+   client.transport().clearWrites();
+   std::string large = "[\"large\",\"" + std::string(SIO_FRAME_BUFFER_SIZE + SIO_MASK_CHUNK_SIZE, 'x') + "\"]";
+   std::string copy = large;
+   CHECK(client.send(sIOtype_EVENT, large.c_str()));
+   CHECK(client.frame(0) == "42" + copy);
+   CHECK(large == copy);
+   const uint8_t *key = client.transport().frames()[0].maskKey;
+   CHECK(key[0] | key[1] | key[2] | key[3]);
+
+   // One frame for the packet, one per attachment
+   client.transport().clearWrites();
+   uint8_t data[3] = {1, 2, 3};
+   CHECK(client.emit("blob", SocketIOBinary(data, sizeof(data))) == sIOemit_QUEUED);
+   client.loop();
+   CHECK(client.transport().writes() == 2);
+   CHECK(client.frame(0) == "451-[\"blob\",{\"_placeholder\":true,\"num\":0}]");
+   CHECK(client.frame(1) == std::string("\x01\x02\x03", 3));
+}
+
+static void testEvents(void) {
+   TestClient client;
+   client.connect();
+
+   std::string received;
+   client.on("news", [&](const char *payload, size_t length) { received.assign(payload, length); });
+   client.transport().receiveText("42[\"news\",{\"id\":7}]");
+   client.loop();
+   CHECK(received == "{\"id\":7}");
+
+   // The server asks for an ack
+   client.on("ping", [&](const char *payload, size_t length) { client.ack("pong"); });
+   client.transport().receiveText("4212[\"ping\"]");
+   client.loop();
+   client.loop();
+   CHECK(client.frame(0) == "4312[\"pong\"]");
+}
+
+static void testRawJson(void) {
+   TestClient client;
+   client.connect();
+
+   const char *valid[] = {"{\"on\":true}", " [1, -0.5e+3, \"a\\u00e9\", null, {}] ", "\"x\"", "0", "false", "{\"a\":{\"b\":[[]]}}"};
+   for (const char *json : valid) {
+      CHECK(client.emitRaw("state", json) == sIOemit_QUEUED);
+   }
+   client.loop();
+   CHECK(client.frame(0) == "42[\"state\",{\"on\":true}]");
+   CHECK(client.frame(1) == "42[\"state\", [1, -0.5e+3, \"a\\u00e9\", null, {}] ]");
+
+   const char *invalid[] = {"{]", "[1,2}", "abc", "tru", "nulls", "01", "1.", "-", "1e", "[1,]", "{\"a\"}", "{\"a\":1,}", "{1:2}", "[1 2]", "\"\\x\"", "\"a\tb\"", "[1] [2]", "", " "};
+   for (const char *json : invalid) {
+      CHECK(client.emitRaw("state", json) == sIOemit_INVALID_JSON);
+   }
+   std::string deep = std::string(SIO_JSON_MAX_DEPTH + 1, '[') + std::string(SIO_JSON_MAX_DEPTH + 1, ']');
+   CHECK(client.emitRaw("state", deep.c_str()) == sIOemit_INVALID_JSON);
+   CHECK(client.emitRaw("state", deep.c_str() + 1, deep.size() - 2) == sIOemit_QUEUED);
+}
+
+static void testListenerChangesTable(void) {
+   TestClient client;
+   client.connect();
+
+   // Grows the table, replaces then removes itself while it runs: applied
+   // once it returned
+   std::string big(64, 'x');
+   int calls = 0;
+   int replaced = 0;
+   client.on("setup", [&, big](const char *payload, size_t length) {
+      calls++;
+      for (int i = 0; i < 4 * SIO_EVENT_TABLE_SIZE; i++) {
+         client.on(("event" + std::to_string(i)).c_str(), [big](const char *payload, size_t length) {});
+      }
+      client.on("setup", [&](const char *payload, size_t length) {
+         replaced++;
+         client.remove("setup");
+      });
+      CHECK(big[63] == 'x' && length == 1);
+   });
+   client.transport().receiveText("42[\"setup\",1]");
+   client.loop();
+   CHECK(calls == 1);
+   client.transport().receiveText("42[\"setup\",2]");
+   client.loop();
+   client.transport().receiveText("42[\"setup\",3]");
+   client.loop();
+   CHECK(calls == 1 && replaced == 1);
+   CHECK(client.getStats().unmatchedEvents == 1);
+
+   client.on("reset", [&](const char *payload, size_t length) { client.removeAll(); });
+   client.transport().receiveText("42[\"reset\"]");
+   client.loop();
+   client.transport().receiveText("42[\"event1\"]");
+   client.loop();
+   CHECK(client.getStats().unmatchedEvents == 2);
+}
+
+static void testAcks(void) {
+   TestClient client;
+   client.connect();
+
+   std::string answer = "none";
+   CHECK(client.emitWithAck("ask", 1000, [&](const char *payload, size_t length) { answer = payload ? std::string(payload, length) : "timeout"; }, 42) == sIOemit_QUEUED);
+   client.loop();
+   std::string sent = client.frame(0);
+   CHECK(sent.compare(0, 2, "42") == 0 && sent.find("[\"ask\",42]") != std::string::npos);
+
+   // 42<id>["ask",42]: answer with the same id
+   std::string id = sent.substr(2, sent.find('[') - 2);
+   client.transport().receiveText(("43" + id + "[\"yes\"]").c_str());
+   client.loop();
+   CHECK(answer == "yes");
+
+   CHECK(client.emitWithAck("ask", 1000, [&](const char *payload, size_t length) { answer = payload ? std::string(payload, length) : "timeout"; }) == sIOemit_QUEUED);
+   advanceClock(2000);
+   client.loop();
+   CHECK(answer == "timeout");
+   CHECK(client.getPendingAcks() == 0);
+}
+
+static void testCoalesce(void) {
+   TestClient client;
+   client.connect();
+   client.coalesce("telemetry");
+
+   for (int i = 0; i < 5; i++) {
+      client.emit("telemetry", i);
+   }
+   client.emit("other", 1);
+   CHECK(client.getQueueDepth() == 2);
+   CHECK(client.getCoalescedReplaced() == 4);
+
+   client.loop();
+   CHECK(client.transport().frames().size() == 2);
+   CHECK(client.frame(0) == "42[\"telemetry\",4]");
+   CHECK(client.frame(1) == "42[\"other\",1]");
+   CHECK(client.getCoalescedSent() == 1);
+
+   // A value that outgrows its packet: the old one gives its bytes back when
+   // it is the last one, and stops counting otherwise
+   TestClient grow;
+   grow.configureQueue(0, 2, sIOoverflow_REJECT);
+   grow.connect();
+   grow.coalesce("telemetry");
+   grow.emit("telemetry", 1);
+   std::string big(64, 'x');
+   CHECK(grow.emit("telemetry", big.c_str()) == sIOemit_QUEUED);
+   TestClient fresh;
+   fresh.connect();
+   fresh.coalesce("telemetry");
+   fresh.emit("telemetry", big.c_str());
+   CHECK(grow.getQueueDepth() == 1 && grow.getQueueBytes() == fresh.getQueueBytes());
+   CHECK(grow.emit("other", 1) == sIOemit_QUEUED);
+   std::string bigger(128, 'y');
+   CHECK(grow.emit("telemetry", bigger.c_str()) == sIOemit_QUEUED);
+   CHECK(grow.getQueueDepth() == 2 && grow.getQueueHighWaterMark() == 2);
+   grow.loop();
+   CHECK(grow.transport().frames().size() == 2);
+   CHECK(grow.frame(0) == "42[\"other\",1]");
+   CHECK(grow.frame(1) == "42[\"telemetry\",\"" + bigger + "\"]");
+   CHECK(grow.getStats().droppedPackets == 0);
+}
+
+static void testPriority(void) {
+   TestClient client;
+   client.configurePriority(SIO_PRIORITY_QUEUE_SIZE, 2);
+   client.connect();
+   client.setPriority("alarm");
+
+   for (int i = 0; i < 3; i++) {
+      client.emit("telemetry", i);
+   }
+   for (int i = 0; i < 3; i++) {
+      client.emit("alarm", i);
+   }
+   CHECK(client.emitWithPriority(sIOpriority_HIGH, "relay", 1) == sIOemit_QUEUED);
+   CHECK(client.getQueueDepth(sIOpriority_HIGH) == 4);
+   CHECK(client.getQueueDepth(sIOpriority_NORMAL) == 3);
+   CHECK(client.getQueueDepth() == 7);
+   CHECK(client.getStats().priorityDepth == 4);
+
+   // The pong is written as soon as the ping is read, then two high priority
+   // packets for one normal one
+   client.transport().receiveText("2");
+   client.loop();
+   CHECK(client.transport().frames().size() == 8);
+   CHECK(client.frame(0) == "3");
+   CHECK(client.frame(1) == "42[\"alarm\",0]");
+   CHECK(client.frame(2) == "42[\"alarm\",1]");
+   CHECK(client.frame(3) == "42[\"telemetry\",0]");
+   CHECK(client.frame(4) == "42[\"alarm\",2]");
+   CHECK(client.frame(5) == "42[\"relay\",1]");
+   CHECK(client.frame(6) == "42[\"telemetry\",1]");
+   CHECK(client.frame(7) == "42[\"telemetry\",2]");
+   const SocketIOStats &stats = client.getStats();
+   CHECK(stats.priorityDelay.count() == 4);
+   CHECK(stats.queueDelay.count() == 3);
+   CHECK(stats.priorityHighWater == 4);
+
+   // Too large for the high priority lane: queued with the normal packets
+   std::string large(SIO_PRIORITY_QUEUE_SIZE, 'x');
+   CHECK(client.emitWithPriority(sIOpriority_HIGH, "large", large.c_str()) == sIOemit_QUEUED);
+   CHECK(client.getQueueDepth(sIOpriority_NORMAL) == 1);
+
+   // Back to the normal lane
+   client.setPriority("alarm", sIOpriority_NORMAL);
+   client.emit("alarm", 3);
+   CHECK(client.getQueueDepth(sIOpriority_NORMAL) == 2);
+}
+
+static void testVolatile(void) {
+   TestClient client;
+   client.connect();
+
+   // Written at once, ahead of the queue and without touching it
+   CHECK(client.emit("queued", 1) == sIOemit_QUEUED);
+   CHECK(client.emitVolatile("pos", 1, 2) == sIOemit_SENT);
+   CHECK(client.transport().frames().size() == 1);
+   CHECK(client.frame(0) == "42[\"pos\",1,2]");
+   CHECK(client.getQueueDepth() == 1);
+
+   uint8_t data[3] = {1, 2, 3};
+   CHECK(client.emitVolatile("blob", SocketIOBinary(data, sizeof(data))) == sIOemit_SENT);
+   CHECK(client.frame(1) == "451-[\"blob\",{\"_placeholder\":true,\"num\":0}]");
+   CHECK(client.frame(2) == std::string("\x01\x02\x03", 3));
+
+   // Bounded by the frame buffer
+   std::string large(SIO_FRAME_BUFFER_SIZE, 'x');
+   CHECK(client.emitVolatile("large", large.c_str()) == sIOemit_TOO_LARGE);
+
+   // Dropped when the write fails or the connection is down
+   client.transport().failWrites(true);
+   CHECK(client.emitVolatile("pos", 3, 4) == sIOemit_VOLATILE_DROPPED);
+   client.transport().failWrites(false);
+   client.drop();
+   size_t depth = client.getQueueDepth();
+   CHECK(client.emitVolatile("pos", 5, 6) == sIOemit_VOLATILE_DROPPED);
+   CHECK(client.getQueueDepth() == depth);
+   CHECK(client.getStats().volatileDrops == 2);
+   CHECK(client.getStats().droppedPackets == 1);
+}
+
+static void testBudget(void) {
+   TestClient client;
+   client.connect();
+
+   for (int i = 0; i < 4; i++) {
+      client.emit("n", i);
+   }
+   // One packet per call with a 1 byte budget
+   CHECK(client.loop(0, 1));
+   CHECK(client.transport().frames().size() == 1);
+   CHECK(client.loop(0, 1));
+   CHECK(client.loop(0, 1));
+   CHECK(!client.loop(0, 1));
+   CHECK(client.transport().frames().size() == 4);
+   CHECK(client.frame(3) == "42[\"n\",3]");
+}
+
+static void testStats(void) {
+   TestClient client;
+   client.connect();
+   const SocketIOStats &stats = client.getStats();
+   // Handshake: the CONNECT packet alone
+   CHECK(stats.eioOut[eIOtype_PING - '0'].frames == 0);
+   CHECK(stats.eioOut[eIOtype_UPGRADE - '0'].frames == 0);
+   CHECK(stats.sioOut[sIOtype_CONNECT - '0'].frames == 1);
+
+   client.on("news", [](const char *payload, size_t length) {});
+   client.transport().receiveText("42[\"news\",1]");
+   client.loop();
+   client.transport().receiveText("42[\"nobody\",1]");
+   client.loop();
+   client.transport().receiveText("42[\"news\"");
+   client.loop();
+   client.transport().receiveText("2");
+   client.loop();
+   CHECK(stats.sioIn[sIOtype_EVENT - '0'].frames == 3);
+   CHECK(stats.sioIn[sIOtype_EVENT - '0'].bytes == 10 + 12 + 7);
+   CHECK(stats.eioIn[eIOtype_MESSAGE - '0'].frames == 3);
+   CHECK(stats.eioOut[eIOtype_PONG - '0'].frames == 1);
+   CHECK(stats.unmatchedEvents == 1);
+   CHECK(stats.parseFailures == 1);
+   CHECK(stats.handlerTime.count() == 2);
+   CHECK(stats.parseTime.count() == 3);
+
+   // Queued 100 ms before being written
+   client.emit("late", 1);
+   client.emit("late", 2);
+   CHECK(client.getStats().queueDepth == 2);
+   advanceClock(100);
+   client.loop();
+   CHECK(stats.sioOut[sIOtype_EVENT - '0'].frames == 2);
+   CHECK(stats.queueDelay.count() == 2);
+   CHECK(stats.queueDelay.percentile(50) >= 100000);
+   CHECK(client.getStats().queueHighWater == 2);
+
+   client.drop();
+   client.connect();
+   CHECK(stats.disconnects == 1);
+   CHECK(stats.reconnects == 1);
+
+   char json[1024];
+   size_t length = stats.toJson(json, sizeof(json));
+   CHECK(length < sizeof(json) && length == strlen(json));
+   CHECK(stats.toJson(NULL, 0) == length);
+   CHECK(strstr(json, "\"unmatched\":1,") != NULL);
+
+   // Emitted as an argument, serialized in the queue
+   CHECK(client.emit("stats", client.getStats()) == sIOemit_QUEUED);
+   client.loop();
+   CHECK(client.frame(client.transport().frames().size() - 1).compare(0, 12, "42[\"stats\",{") == 0);
+
+   client.resetStats();
+   CHECK(stats.sioOut[sIOtype_EVENT - '0'].frames == 0);
+   CHECK(stats.queueDelay.count() == 0);
+   CHECK(client.getStats().queueHighWater == 0);
+}
+
+static void testNamespaces(void) {
+   TestClient client;
+   SocketIONamespace *admin = client.of("/admin");
+   CHECK(admin && client.of("/admin") == admin);
+   CHECK(client.of("/") == client.of("/"));
+   client.begin("localhost", 3000);
+   client.transport().open();
+   client.loop();
+   // Joined on connection, after the main namespace
+   CHECK(client.frame(0) == "40/");
+   CHECK(client.frame(1) == "40/admin");
+   client.transport().clearWrites();
+
+   std::string joined, left;
+   admin->onConnect([&](const char *data, size_t length) { joined.assign(data, length); });
+   admin->onDisconnect([&](const char *reason, size_t length) { left = reason ? std::string(reason, length) : "lost"; });
+   client.transport().receiveText("40/admin,{\"sid\":\"a\"}");
+   client.loop();
+   CHECK(admin->isConnected());
+   CHECK(joined == "{\"sid\":\"a\"}");
+
+   // Same event name, one listener per namespace
+   std::string main, other;
+   client.on("news", [&](const char *payload, size_t length) { main.assign(payload, length); });
+   admin->on("news", [&](const char *payload, size_t length) {
+      other.assign(payload, length);
+      client.ack("seen");
+   });
+   client.transport().receiveText("42/admin,5[\"news\",2]");
+   client.loop();
+   client.transport().receiveText("42[\"news\",1]");
+   client.loop();
+   client.transport().receiveText("42/nobody,[\"news\",3]");
+   client.loop();
+   CHECK(main == "1" && other == "2");
+   CHECK(client.getStats().unmatchedEvents == 1);
+   CHECK(client.frame(0) == "43/admin,5[\"seen\"]");
+
+   // Acks are resolved in the namespace they were asked in
+   std::string answer;
+   CHECK(admin->emitWithAck("ask", 1000, [&](const char *payload, size_t length) { answer.assign(payload, length); }, 1) == sIOemit_QUEUED);
+   CHECK(admin->emit("tell", "x") == sIOemit_QUEUED);
+   client.loop();
+   std::string sent = client.frame(1);
+   CHECK(sent.compare(0, 9, "42/admin,") == 0);
+   CHECK(client.frame(2) == "42/admin,[\"tell\",\"x\"]");
+   std::string id = sent.substr(9, sent.find('[') - 9);
+   client.transport().receiveText(("43" + id + "[\"main\"]").c_str());
+   client.loop();
+   CHECK(answer.empty() && client.getPendingAcks() == 1);
+   client.transport().receiveText(("43/admin," + id + "[\"admin\"]").c_str());
+   client.loop();
+   CHECK(answer == "admin" && client.getPendingAcks() == 0);
+
+   // Left by the server: not joined again
+   client.transport().receiveText("41/admin,");
+   client.loop();
+   CHECK(!admin->isConnected() && left == "io server disconnect");
+   client.drop();
+   client.connect();
+   CHECK(client.transport().frames().empty());
+
+   // Left by the client
+   CHECK(admin->connect());
+   CHECK(client.frame(0) == "40/admin");
+   client.transport().receiveText("40/admin,{}");
+   client.loop();
+   CHECK(admin->disconnect());
+   CHECK(client.frame(1) == "41/admin");
+   CHECK(!admin->isConnected() && left == "io client disconnect");
+}
+
+static void testStream(void) {
+   TestClient client;
+   client.connect();
+
+   std::string received;
+   size_t chunks = 0, largest = 0, ends = 0, aborts = 0;
+   CHECK(client.onStream("config", [&](const char *chunk, size_t length, socketIOstreamState_t state) {
+      if (state == sIOstream_ABORT) {
+         aborts++;
+         return;
+      }
+      received.append(chunk, length);
+      chunks++;
+      largest = length > largest ? length : largest;
+      if (state == sIOstream_END) {
+         ends++;
+         client.ack("ok");
+      }
+   }));
+
+   // 20 KB in 512 byte fragments, never held whole by the client
+   std::string config = "{\"blob\":\"" + std::string(20000, 'x') + "\"}";
+   std::string message = "4217[\"config\"," + config + " ]";
+   client.transport().receiveFragments(message.c_str(), 512);
+   while (client.loop()) {
+   }
+   CHECK(received == config);
+   CHECK(ends == 1 && chunks == (message.size() + 511) / 512);
+   CHECK(largest <= 512);
+   CHECK(client.frame(0) == "4317[\"ok\"]");
+   CHECK(client.getStats().sioIn[sIOtype_EVENT - '0'].bytes == message.size() - 2);
+
+   // In one frame: one last chunk
+   received.clear();
+   client.transport().receiveText("42[\"config\",1,2]");
+   client.loop();
+   CHECK(received == "1,2" && ends == 2);
+
+   // Without stream listener: dropped, the next messages still arrive
+   std::string news;
+   client.on("news", [&](const char *payload, size_t length) { news.assign(payload, length); });
+   message = "42[\"news\",\"" + std::string(2000, 'y') + "\"]";
+   client.transport().receiveFragments(message.c_str(), 256);
+   client.transport().receiveText("42[\"news\",\"short\"]");
+   while (client.loop()) {
+   }
+   CHECK(news == "short");
+   CHECK(client.getStats().unmatchedEvents == 1);
+
+   // Connection lost in the middle
+   message = "42[\"config\",\"" + std::string(2000, 'z') + "\"]";
+   client.transport().receiveFragments(message.c_str(), 256);
+   client.loop();
+   client.loop();
+   client.drop();
+   CHECK(aborts == 1 && ends == 2);
+
+   // Removed: back to the on() listener
+   CHECK(client.onStream("config", NULL));
+   client.connect();
+   std::string config1;
+   client.on("config", [&](const char *payload, size_t length) { config1.assign(payload, length); });
+   client.transport().receiveText("42[\"config\",7]");
+   client.loop();
+   CHECK(config1 == "7");
+}
+
+struct Reading {
+   int id = 0;
+   float temperature = 0;
+};
+
+// Read by typed listeners through ArduinoJson
+bool convertFromJson(JsonVariantConst src, Reading &dst) {
+   dst.id = src["id"].as<int>();
+   dst.temperature = src["t"].as<float>();
+   return true;
+}
+
+static void testTypedListeners(void) {
+   TestClient client;
+   client.connect();
+
+   StaticJsonDocument<64> filter;
+   filter["id"] = true;
+   size_t variants = 0, readings = 0;
+   client.on<JsonVariantConst>("state", filter, [&](const JsonVariantConst &state) { variants++; });
+   client.on<Reading, 128>("reading", [&](const Reading &reading) { readings++; });
+   client.transport().receiveText("42[\"state\",{\"id\":1,\"large\":[1,2,3]}]");
+   client.loop();
+   client.transport().receiveText("42[\"reading\",{\"id\":2,\"t\":21.5}]");
+   client.loop();
+   CHECK(variants == 1 && readings == 1);
+   CHECK(client.getStats().parseFailures == 0);
+
+   SocketIONamespace *admin = client.of("/admin");
+   admin->on<JsonVariantConst>("state", [&](const JsonVariantConst &state) { variants++; });
+   client.transport().receiveText("42/admin,[\"state\",{}]");
+   client.loop();
+   CHECK(variants == 2);
+}
+
+static void testRoutes(void) {
+   TestClient client;
+   client.connect();
+
+   std::string got;
+   client.on("device/relay/1/set", [&](const char *payload, size_t length) { got = "exact"; });
+   CHECK(client.onRoute("device/relay/*", [&](const char *event, const char *payload, size_t length) { got = std::string("relay ") + event; }));
+   CHECK(client.onRoute("device/*/set", [&](const char *event, const char *payload, size_t length) { got = "set " + std::string(payload, length); }));
+   CHECK(client.onAny([&](const char *event, const char *payload, size_t length) { got = std::string("any ") + event; }));
+
+   const char *cases[][2] = {
+       {"42[\"device/relay/1/set\",1]", "exact"},
+       {"42[\"device/relay/2/set\",1]", "relay device/relay/2/set"},
+       {"42[\"device/relay/2\",1]", "relay device/relay/2"},
+       {"42[\"device/fan/set\",3]", "set 3"},
+       {"42[\"device/fan/get\",3]", "any device/fan/get"},
+       {"42[\"device/relay/\",1]", "any device/relay/"},
+       {"42[\"hello\"]", "any hello"},
+   };
+   for (auto &c : cases) {
+      got.clear();
+      client.transport().receiveText(c[0]);
+      client.loop();
+      CHECK(got == c[1]);
+   }
+   CHECK(client.getStats().unmatchedEvents == 0);
+   CHECK(client.getRouteMemory() > 0);
+
+   CHECK(client.removeRoute("*"));
+   CHECK(!client.removeRoute("device/*"));
+   got.clear();
+   client.transport().receiveText("42[\"hello\"]");
+   client.loop();
+   CHECK(got.empty() && client.getStats().unmatchedEvents == 1);
+
+   // Hundreds of routes sharing prefixes, each found
+   SocketIOEventRouter router;
+   int found = -1;
+   for (int i = 0; i < 300; i++) {
+      std::string pattern = "device/" + std::to_string(i) + "/*";
+      CHECK(router.add(pattern.c_str(), [&found, i](const char *event, const char *payload, size_t length) { found = i; }));
+   }
+   CHECK(router.size() == 300);
+   for (int i = 0; i < 300; i += 37) {
+      std::string name = "device/" + std::to_string(i) + "/relay/set";
+      SocketIORouteHandler *handler = router.find(name.c_str(), name.size());
+      CHECK(handler != NULL);
+      if (handler) {
+         (*handler)(name.c_str(), "", 0);
+      }
+      CHECK(found == i);
+   }
+   CHECK(router.find("device/300/x", 12) == NULL);
+   CHECK(router.find("device/30", 9) == NULL);
+
+   // A route listener that grows the router, then replaces and removes itself
+   TestClient changes;
+   changes.connect();
+   std::string big(64, 'x');
+   char last = 0;
+   int replaced = 0;
+   CHECK(changes.onRoute("cfg/*", [&changes, &last, &replaced, big](const char *event, const char *payload, size_t length) {
+      for (int i = 0; i < 16; i++) {
+         changes.onRoute(("more/" + std::to_string(i)).c_str(), [](const char *event, const char *payload, size_t length) {});
+      }
+      changes.onRoute("cfg/*", [&changes, &replaced](const char *event, const char *payload, size_t length) {
+         replaced++;
+         changes.removeRoute("cfg/*");
+      });
+      last = big[63];
+   }));
+   for (int i = 0; i < 3; i++) {
+      changes.transport().receiveText("42[\"cfg/a\"]");
+      changes.loop();
+   }
+   CHECK(last == 'x' && replaced == 1);
+   CHECK(changes.getStats().unmatchedEvents == 1);
+
+   // A route added by a listener dispatched from another listener does not
+   // take the slot of the outer one
+   SocketIOEventRouter nested;
+   std::string calls;
+   CHECK(nested.add("outer", [&](const char *event, const char *payload, size_t length) {
+      calls += "outer ";
+      nested.dispatch("inner", "", 0);
+   }));
+   CHECK(nested.add("inner", [&](const char *event, const char *payload, size_t length) {
+      calls += "inner ";
+      nested.add("fresh", [&](const char *event, const char *payload, size_t length) { calls += "fresh "; });
+   }));
+   CHECK(nested.dispatch("outer", "", 0));
+   CHECK(nested.dispatch("fresh", "", 0));
+   CHECK(nested.dispatch("outer", "", 0));
+   CHECK(calls == "outer inner fresh outer inner ");
+}
+
+static void testReconnect(void) {
+   TestClient client;
+   client.configureReconnect(1000, 4000, 0);
+   client.connect();
+   client.drop();
+   CHECK(client.getReconnectAttempts() == 1 && client.getReconnectDelay() == 1000);
+
+   // No attempt before the wait is over, then twice longer after each failure
+   size_t attempts = client.transport().attempts();
+   advanceClock(990);
+   client.loop();
+   CHECK(client.transport().attempts() == attempts);
+   const uint32_t waits[] = {2000, 4000, 4000};
+   for (uint32_t wait : waits) {
+      advanceClock(1000);
+      client.loop();
+      client.loop();
+      CHECK(client.transport().attempts() == ++attempts);
+      CHECK(client.getReconnectDelay() == wait);
+      advanceClock(wait - 1000);
+   }
+   client.transport().open();
+   advanceClock(1000);
+   client.loop();
+   CHECK(client.isConnected() && client.getReconnectAttempts() == 0);
+   CHECK(client.getStats().reconnects == 1);
+
+   // Jitter: spread over [500, 1500] ms
+   client.configureReconnect(1000, 30000, 50);
+   uint32_t low = 0xFFFFFFFF, high = 0;
+   for (int i = 0; i < 50; i++) {
+      client.connect();
+      client.drop();
+      uint32_t wait = client.getReconnectDelay();
+      low = wait < low ? wait : low;
+      high = wait > high ? wait : high;
+   }
+   CHECK(low >= 500 && high <= 1500 && high - low > 200);
+}
+
+static void testRecovery(void) {
+   TestClient client;
+   client.configureReconnect(1000, 1000, 0);
+   SocketIONamespace *admin = client.of("/admin");
+   client.connect();
+   client.transport().receiveText("40{\"sid\":\"s1\",\"pid\":\"p1\"}");
+   client.loop();
+   client.transport().receiveText("40/admin,{\"sid\":\"s2\",\"pid\":\"p2\"}");
+   client.loop();
+   CHECK(!client.isRecovered() && strcmp(admin->getSessionId(), "p2") == 0);
+
+   // The offset is the last argument of the events
+   std::string news;
+   client.on("news", [&](const char *payload, size_t length) { news.assign(payload, length); });
+   client.transport().receiveText("42[\"news\",1,\"100-0\"]");
+   client.loop();
+   CHECK(news == "1");
+   client.transport().receiveText("42[\"tick\",\"100-1\"]");
+   client.transport().receiveText("42/admin,[\"tick\",{},\"200-7\"]");
+   client.loop();
+   client.loop();
+   CHECK(strcmp(client.of("/")->getOffset(), "100-1") == 0);
+   CHECK(strcmp(admin->getOffset(), "200-7") == 0);
+
+   // Presented again after a lost connection
+   client.drop();
+   client.transport().open();
+   advanceClock(1000);
+   client.loop();
+   CHECK(client.frame(0) == "40{\"pid\":\"p1\",\"offset\":\"100-1\"}");
+   CHECK(client.frame(1) == "40/admin,{\"pid\":\"p2\",\"offset\":\"200-7\"}");
+   client.transport().receiveText("40{\"sid\":\"s1\",\"pid\":\"p1\"}");
+   client.loop();
+   client.transport().receiveText("40/admin,{\"sid\":\"s3\",\"pid\":\"p3\"}");
+   client.loop();
+   CHECK(client.isRecovered() && !admin->isRecovered());
+   CHECK(strcmp(client.of("/")->getOffset(), "100-1") == 0 && admin->getOffset()[0] == '\0');
+
+   // Nothing to recover once the namespace is left
+   CHECK(admin->disconnect());
+   CHECK(admin->getSessionId()[0] == '\0');
+   client.transport().clearWrites();
+   CHECK(admin->connect());
+   CHECK(client.frame(0) == "40/admin");
+}
+
+static void testOfflineLog(void) {
+   const char *path = "sio_offline_test.log";
+   remove(path);
+
+   {
+      SocketIOOfflineLog log;
+      CHECK(log.begin(path));
+      TestClient client;
+      client.setOfflineLog(&log);
+      client.configureOfflineReplay(2, 10);
+      client.connect();
+      client.drop();
+
+      for (int i = 0; i < 5; i++) {
+         CHECK(client.emit("offline", i) == sIOemit_QUEUED);
+      }
+      client.loop();
+      CHECK(client.getQueueDepth() == 0);
+      CHECK(log.count() == 5);
+
+      // Replayed in order, 2 packets per burst
+      client.connect();
+      advanceClock(100);
+      client.loop();
+      CHECK(client.transport().frames().size() == 2);
+      CHECK(client.frame(0) == "42[\"offline\",0]");
+      CHECK(client.frame(1) == "42[\"offline\",1]");
+      CHECK(log.count() == 3);
+   }
+
+   // After a reboot the rest is replayed, then the packets emitted since
+   {
+      SocketIOOfflineLog log;
+      CHECK(log.begin(path));
+      CHECK(log.count() == 3);
+      TestClient client;
+      client.setOfflineLog(&log);
+      client.connect();
+      client.emit("online", 1);
+      for (int i = 0; i < 3; i++) {
+         advanceClock(100);
+         client.loop();
+      }
+      CHECK(client.transport().frames().size() == 4);
+      CHECK(client.frame(0) == "42[\"offline\",2]");
+      CHECK(client.frame(2) == "42[\"offline\",4]");
+      CHECK(client.frame(3) == "42[\"online\",1]");
+      CHECK(log.isEmpty());
+   }
+
+   // Packets emitted while the log is replayed stay queued: acks are not
+   // dropped, the high priority lane does not wait for the log
+   {
+      SocketIOOfflineLog log;
+      CHECK(log.begin(path));
+      TestClient client;
+      client.setOfflineLog(&log);
+      client.configureOfflineReplay(1, 10);
+      client.connect();
+
+      // Not stored with an ack id its callback failed with the connection
+      bool failed = false;
+      CHECK(client.emitWithAck("ask", 0, [&](const char *payload, size_t length) { failed = payload == NULL; }) == sIOemit_QUEUED);
+      client.drop();
+      CHECK(failed);
+      for (int i = 0; i < 3; i++) {
+         client.emit("offline", i);
+      }
+      client.loop();
+      CHECK(log.count() == 3);
+
+      client.connect();
+      client.on("ping", [&](const char *payload, size_t length) { client.ack("pong"); });
+      client.transport().receiveText("427[\"ping\"]");
+      client.loop();
+      std::string answer;
+      CHECK(client.emitWithAck("ask", 0, [&](const char *payload, size_t length) { answer.assign(payload, length); }) == sIOemit_QUEUED);
+      CHECK(client.emitWithPriority(sIOpriority_HIGH, "alarm", 1) == sIOemit_QUEUED);
+      advanceClock(100);
+      client.loop();
+      CHECK(client.frame(1) == "42[\"offline\",1]");
+      CHECK(client.frame(2) == "42[\"alarm\",1]");
+      CHECK(log.count() == 1 && client.getQueueDepth() == 2);
+
+      for (int i = 0; i < 2; i++) {
+         advanceClock(100);
+         client.loop();
+      }
+      CHECK(log.isEmpty());
+      CHECK(client.transport().frames().size() == 6);
+      CHECK(client.frame(3) == "42[\"offline\",2]");
+      CHECK(client.frame(4) == "437[\"pong\"]");
+      std::string sent = client.frame(5);
+      CHECK(sent.compare(0, 2, "42") == 0 && sent.find("[\"ask\"]") != std::string::npos);
+      std::string id = sent.substr(2, sent.find('[') - 2);
+      client.transport().receiveText(("43" + id + "[\"yes\"]").c_str());
+      client.loop();
+      CHECK(answer == "yes");
+      CHECK(client.getStats().droppedPackets == 1);
+   }
+
+   // A queue filled while the log is replayed does not cost records: they
+   // are loaded past the packet limit of the lane
+   {
+      SocketIOOfflineLog log;
+      CHECK(log.begin(path));
+      TestClient client;
+      client.setOfflineLog(&log);
+      client.configureQueue(0, 4);
+      client.configureOfflineReplay(1, 10);
+      client.connect();
+      client.drop();
+      for (int i = 0; i < 10; i++) {
+         client.emit("offline", i);
+         client.loop();
+      }
+      CHECK(log.count() == 10);
+
+      client.connect();
+      for (int i = 0; i < 6; i++) {
+         client.emit("online", i);
+      }
+      for (int i = 0; i < 12; i++) {
+         advanceClock(100);
+         client.loop();
+      }
+      CHECK(log.isEmpty());
+      CHECK(client.getStats().lostPackets == 0);
+      CHECK(client.transport().frames().size() == 14);
+      CHECK(client.frame(9) == "42[\"offline\",9]");
+      CHECK(client.frame(10) == "42[\"online\",2]");
+   }
+
+   // Out of bytes the lane sends a packet ahead of the log to make room
+   {
+      SocketIOOfflineLog log;
+      CHECK(log.begin(path));
+      TestClient client;
+      client.setOfflineLog(&log);
+      client.configureQueue(512, 0);
+      client.configureOfflineReplay(1, 10);
+      client.connect();
+      client.drop();
+      for (int i = 0; i < 3; i++) {
+         client.emit("offline", i);
+         client.loop();
+      }
+      CHECK(log.count() == 3);
+
+      client.connect();
+      // Full when the oldest packet is evicted
+      int online = 0;
+      while (client.emit("online", online++) == sIOemit_QUEUED) {
+      }
+      for (int i = 0; i < 12; i++) {
+         advanceClock(100);
+         client.loop();
+      }
+      CHECK(client.transport().frames().size() == (size_t)online + 2);
+      CHECK(client.frame(0) == "42[\"online\",1]");
+      CHECK(client.frame(3) == "42[\"offline\",0]");
+      CHECK(client.frame(5) == "42[\"offline\",2]");
+      CHECK(log.isEmpty());
+      CHECK(client.getStats().lostPackets == 0);
+   }
+   remove(path);
+}
+
+// Bytes of a string literal, NUL included
+#define BYTES(literal) std::string(literal, sizeof(literal) - 1)
+
+static void receiveBytes(TestClient &client, const std::string &packet) { client.transport().receiveBinary((const uint8_t *)packet.data(), packet.size()); }
+
+// socket.io-msgpack-parser: one binary frame per packet, both ways
+static void testMsgPack(void) {
+   TestClient client;
+   client.begin("localhost", 3000, "/", DEFAULT_URL, DEFAULT_PROTOCOL, sIOencoding_MSGPACK);
+   client.transport().open();
+   client.loop();
+   CHECK(client.transport().frames().size() == 1);
+   CHECK(client.transport().frames()[0].opcode == WSop_binary);
+   CHECK(client.frame(0) == BYTES("\x82\xA4" "type" "\x00\xA3" "nsp" "\xA1/"));
+   receiveBytes(client, BYTES("\x83\xA4" "type" "\x00\xA3" "nsp" "\xA1/" "\xA4" "data" "\x81\xA3" "sid" "\xA3" "abc"));
+   client.loop();
+   CHECK(client.getStats().connectTime.count() == 1);
+
+   // Integers take their smallest encoding, binary data is inlined
+   client.transport().clearWrites();
+   uint8_t data[3] = {1, 2, 3};
+   CHECK(client.emit("move", 1, -2, true, "hi") == sIOemit_QUEUED);
+   CHECK(client.emit("n", 300, -200, 70000) == sIOemit_QUEUED);
+   CHECK(client.emit("blob", SocketIOBinary(data, sizeof(data))) == sIOemit_QUEUED);
+   CHECK(client.emitRaw("cfg", "{\"a\":[1,\"x\\n\"], \"b\":null}") == sIOemit_QUEUED);
+   client.loop();
+   CHECK(client.transport().writes() == 4);
+   const std::string head = BYTES("\x83\xA4" "type" "\x02\xA3" "nsp" "\xA1/" "\xA4" "data");
+   CHECK(client.frame(0) == head + BYTES("\x95\xA4" "move" "\x01\xFE\xC3\xA2" "hi"));
+   CHECK(client.frame(1) == head + BYTES("\x94\xA1n\xCD\x01\x2C\xD1\xFF\x38\xCE\x00\x01\x11\x70"));
+   CHECK(client.frame(2) == head + BYTES("\x92\xA4" "blob" "\xC4\x03\x01\x02\x03"));
+   CHECK(client.frame(3) == head + BYTES("\x92\xA3" "cfg" "\x82\xA1" "a" "\x92\x01\xA2x\n\xA1" "b" "\xC0"));
+   CHECK(client.emitVolatile("pos", 1) == sIOemit_SENT);
+   CHECK(client.frame(4) == head + BYTES("\x92\xA3" "pos" "\x01"));
+
+   // Arguments reach listeners as the JSON encoding would hand them
+   std::string received;
+   size_t attachment = 0;
+   client.on("news", [&](const char *payload, size_t length) { received.assign(payload, length); });
+   client.on("frame", [&](const char *payload, size_t length) {
+      received.assign(payload, length);
+      client.getAttachment(0, &attachment);
+   });
+   const std::string event = BYTES("\x83\xA4" "type" "\x02\xA3" "nsp" "\xA1/" "\xA4" "data");
+   receiveBytes(client, event + BYTES("\x93\xA4" "news" "\x81\xA2" "id" "\x07\xA2" "of"));
+   client.loop();
+   CHECK(received == "{\"id\":7}");
+   receiveBytes(client, event + BYTES("\x92\xA4" "news" "\xA5" "hello"));
+   client.loop();
+   CHECK(received == "hello");
+   receiveBytes(client, event + BYTES("\x92\xA5" "frame" "\xC4\x02\x0A\x0B"));
+   client.loop();
+   CHECK(received == "{\"_placeholder\":true,\"num\":0}" && attachment == 2);
+
+   // Acks both ways
+   client.transport().clearWrites();
+   client.on("ping", [&](const char *payload, size_t length) { client.ack("pong"); });
+   receiveBytes(client, BYTES("\x84\xA4" "type" "\x02\xA3" "nsp" "\xA1/" "\xA4" "data" "\x91\xA4" "ping" "\xA2" "id" "\x05"));
+   client.loop();
+   client.loop();
+   CHECK(client.frame(0) == BYTES("\x84\xA4" "type" "\x03\xA3" "nsp" "\xA1/" "\xA4" "data" "\x91\xA4" "pong" "\xA2" "id" "\x05"));
+
+   std::string answer;
+   client.transport().clearWrites();
+   CHECK(client.emitWithAck("ask", 1000, [&](const char *payload, size_t length) { answer.assign(payload, length); }) == sIOemit_QUEUED);
+   client.loop();
+   std::string sent = client.frame(0);
+   CHECK(sent.size() > 4 && sent.compare(sent.size() - 4, 3, BYTES("\xA2" "id")) == 0);
+   receiveBytes(client, BYTES("\x84\xA4" "type" "\x03\xA3" "nsp" "\xA1/" "\xA4" "data" "\x91\xA3" "yes" "\xA2" "id") + sent.back());
+   client.loop();
+   CHECK(answer == "yes");
+
+   // Not a packet
+   size_t failures = client.getStats().parseFailures;
+   receiveBytes(client, BYTES("\x92\x01\x02"));
+   client.loop();
+   CHECK(client.getStats().parseFailures == failures + 1);
+}
+
+static void testSendFailure(void) {
+   TestClient client;
+   client.connect();
+
+   // The message frame fails: the packet stays queued as it was
+   uint8_t data[3] = {1, 2, 3};
+   CHECK(client.emit("blob", "hi", SocketIOBinary(data, sizeof(data))) == sIOemit_QUEUED);
+   client.transport().failWrites(true);
+   client.loop();
+   CHECK(client.getQueueDepth() == 1);
+   client.transport().failWrites(false);
+   client.loop();
+   CHECK(client.getQueueDepth() == 0);
+   CHECK(client.frame(0) == "451-[\"blob\",\"hi\",{\"_placeholder\":true,\"num\":0}]");
+   CHECK(client.frame(1) == std::string("\x01\x02\x03", 3));
+
+   // The attachment fails after the message was written: both go again
+   client.transport().clearWrites();
+   CHECK(client.emit("blob", SocketIOBinary(data, sizeof(data))) == sIOemit_QUEUED);
+   client.transport().failWritesAfter(1);
+   client.loop();
+   CHECK(client.transport().frames().size() == 1);
+   CHECK(client.getQueueDepth() == 1);
+   client.transport().failWrites(false);
+   client.loop();
+   CHECK(client.transport().frames().size() == 3);
+   CHECK(client.frame(1) == "451-[\"blob\",{\"_placeholder\":true,\"num\":0}]");
+   CHECK(client.frame(2) == std::string("\x01\x02\x03", 3));
+   CHECK(client.getStats().lostPackets == 0);
+
+   // Same with MessagePack
+   TestClient msgpack;
+   msgpack.begin("localhost", 3000, "/", DEFAULT_URL, DEFAULT_PROTOCOL, sIOencoding_MSGPACK);
+   msgpack.connect();
+   CHECK(msgpack.emit("n", 300) == sIOemit_QUEUED);
+   msgpack.transport().failWrites(true);
+   msgpack.loop();
+   msgpack.transport().failWrites(false);
+   msgpack.loop();
+   CHECK(msgpack.frame(0) == BYTES("\x83\xA4" "type" "\x02\xA3" "nsp" "\xA1/" "\xA4" "data" "\x92\xA1n\xCD\x01\x2C"));
+}
+
+static void testSpscRing(void) {
+   alignas(8) uint8_t buffer[100];
+   SocketIOSpscRing ring;
+   ring.begin(buffer, sizeof(buffer));
+   CHECK(ring.capacity() == 64);
+   CHECK(!ring.reserve(57));
+
+   // 24 + 24 bytes, then a record that has to wrap once the first is gone
+   for (int i = 0; i < 2; i++) {
+      uint8_t *record = ring.reserve(16);
+      memset(record, 'a' + i, 16);
+      ring.commit(16);
+   }
+   CHECK(!ring.reserve(16));
+   size_t length;
+   CHECK(ring.front(&length)[0] == 'a' && length == 16);
+   ring.pop();
+   uint8_t *record = ring.reserve(12);
+   CHECK(record == buffer + 8);
+   memcpy(record, "wrapped", 8);
+   ring.commit(8);
+   CHECK(ring.front(&length)[0] == 'b');
+   ring.pop();
+   CHECK(strcmp((const char *)ring.front(&length), "wrapped") == 0 && length == 8);
+   ring.pop();
+   CHECK(ring.isEmpty() && !ring.front(&length));
+}
+
+static void testTask(void) {
+   const int inbound = 200;
+   const int outbound = 1000;
+   TestClient client;
+   client.connect();
+   for (int i = 0; i < inbound; i++) {
+      std::string frame = "42[\"tick\"," + std::to_string(i) + "]";
+      client.transport().receiveText(frame.c_str());
+   }
+
+   // Small outbound ring: the application has to wait for the network task
+   SocketIOTask task(client);
+   CHECK(task.emit("early") == sIOemit_DISCONNECTED);
+   task.configure(1024, 16384);
+   int received = 0;
+   bool ordered = true;
+   task.on("tick", [&](const char *payload, size_t length) {
+      ordered = ordered && std::to_string(received) == std::string(payload, length);
+      received++;
+   });
+   CHECK(task.start());
+   CHECK(task.isConnected());
+
+   size_t rejected = 0;
+   for (int i = 0; i < outbound; i++) {
+      while (task.emit("n", i) == sIOemit_REJECTED) {
+         rejected++;
+         task.dispatch();
+         std::this_thread::yield();
+      }
+   }
+   auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+   while ((received < inbound || task.getOutboundBytes()) && std::chrono::steady_clock::now() < deadline) {
+      task.dispatch();
+      std::this_thread::yield();
+   }
+   task.stop();
+   CHECK(!task.isRunning());
+
+   CHECK(received == inbound && ordered);
+   CHECK(task.getInboundDrops() == 0);
+   CHECK(task.getOutboundDrops() == rejected);
+   CHECK(client.transport().frames().size() == (size_t)outbound);
+   bool sent = true;
+   for (int i = 0; i < outbound; i++) {
+      sent = sent && client.frame(i) == "42[\"n\"," + std::to_string(i) + "]";
+   }
+   CHECK(sent);
+   CHECK(client.getStats().queueDelay.count() == (uint32_t)outbound);
+}
+
+int main(void) {
+   testHandshake();
+   testOpen();
+   testOneWritePerFrame();
+   testEvents();
+   testRawJson();
+   testListenerChangesTable();
+   testAcks();
+   testCoalesce();
+   testPriority();
+   testVolatile();
+   testBudget();
+   testStats();
+   testNamespaces();
+   testStream();
+   testTypedListeners();
+   testRoutes();
+   testReconnect();
+   testRecovery();
+   testOfflineLog();
+   testMsgPack();
+   testSendFailure();
+   testSpscRing();
+   testTask();
+
+   if (failures) {
+      printf("%d check(s) failed\n", failures);
+      return 1;
+   }
+   printf("all checks passed\n");
+   return 0;
+}